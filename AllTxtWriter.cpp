@@ -0,0 +1,197 @@
+#include "AllTxtWriter.hpp"
+
+#include <utility>
+#include <climits>
+
+#include <QMutexLocker>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "moc_AllTxtWriter.cpp"
+
+namespace
+{
+  // commit an open file's data to the disk
+  bool sync_to_disk (QFile& file)
+  {
+#ifdef Q_OS_WIN
+    return !_commit (file.handle ());
+#else
+    return !::fsync (file.handle ());
+#endif
+  }
+}
+
+int const AllTxtWriter::queue_limit {4096};
+int const AllTxtWriter::wait_for_space_ms {20};
+int const AllTxtWriter::sync_interval_ms {5000};
+
+AllTxtWriter::AllTxtWriter (QObject * parent)
+  : QThread {parent}
+  , dropped_ {0}
+  , quit_ {false}
+{
+}
+
+AllTxtWriter::~AllTxtWriter ()
+{
+  {
+    QMutexLocker lock {&mutex_};
+    quit_ = true;
+    work_ready_.wakeOne ();
+  }
+  wait ();
+}
+
+bool AllTxtWriter::append (QString const& path, QString const& line)
+{
+  QMutexLocker lock {&mutex_};
+  if (queue_.size () >= queue_limit)
+    {
+      // the disk is not keeping up, give it a moment but don't stall
+      // the caller
+      space_ready_.wait (&mutex_, wait_for_space_ms);
+      if (queue_.size () >= queue_limit)
+        {
+          ++dropped_;
+          work_ready_.wakeOne ();
+          return false;
+        }
+    }
+  lock.unlock ();
+  enqueue ({Op::append, path, line});
+  return true;
+}
+
+void AllTxtWriter::sync ()
+{
+  enqueue ({Op::sync, QString {}, QString {}});
+}
+
+void AllTxtWriter::remove (QString const& path)
+{
+  enqueue ({Op::remove, path, QString {}});
+}
+
+void AllTxtWriter::enqueue (Request&& request)
+{
+  if (!isRunning ()) start (QThread::LowPriority);
+  QMutexLocker lock {&mutex_};
+  queue_ << std::move (request);
+  work_ready_.wakeOne ();
+}
+
+void AllTxtWriter::run ()
+{
+  QFile file;
+  QTextStream out {&file};
+  bool failed {false};          // an error has been reported
+  bool dirty {false};           // written but not synced to disk
+  QElapsedTimer since_sync;
+  since_sync.start ();
+
+  auto report = [this, &failed] (QString const& message) {
+    if (!failed) Q_EMIT error (message);
+    failed = true;
+  };
+
+  Q_FOREVER
+    {
+      QList<Request> batch;
+      int dropped;
+      bool quit;
+      {
+        QMutexLocker lock {&mutex_};
+        if (queue_.isEmpty () && !quit_ && !dropped_)
+          {
+            unsigned long timeout {ULONG_MAX};
+            if (dirty) timeout = qMax (qint64 (0), sync_interval_ms - since_sync.elapsed ());
+            work_ready_.wait (&mutex_, timeout);
+          }
+        batch.swap (queue_);
+        dropped = dropped_;
+        dropped_ = 0;
+        quit = quit_;
+        space_ready_.wakeAll ();
+      }
+
+      if (dropped)
+        {
+          report (tr ("Writing to \"%1\" is not keeping up, %n line(s) were not logged", "", dropped)
+                  .arg (file.fileName ()));
+        }
+
+      bool want_sync {false};
+      for (auto const& request : batch)
+        {
+          switch (request.op)
+            {
+            case Op::append:
+              if (!file.isOpen () || file.fileName () != request.path)
+                {
+                  if (file.isOpen ())
+                    {
+                      out.flush ();
+                      if (dirty) sync_to_disk (file);
+                      file.close ();
+                    }
+                  file.setFileName (request.path);
+                  if (!file.open (QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append))
+                    {
+                      report (tr ("Cannot open \"%1\" for append: %2")
+                              .arg (file.fileName ()).arg (file.errorString ()));
+                      continue;
+                    }
+                }
+              out << request.line << '\n';
+              dirty = true;
+              break;
+
+            case Op::sync:
+              want_sync = true;
+              break;
+
+            case Op::remove:
+              if (file.isOpen () && file.fileName () == request.path)
+                {
+                  out.flush ();
+                  file.close ();
+                  dirty = false;
+                }
+              QFile::remove (request.path);
+              break;
+            }
+        }
+
+      if (file.isOpen () && batch.size ())
+        {
+          out.flush ();
+          if (QFile::NoError != file.error ())
+            {
+              report (tr ("Error writing \"%1\": %2")
+                      .arg (file.fileName ()).arg (file.errorString ()));
+              file.close ();    // reopened by the next line
+            }
+          else if (!dropped)
+            {
+              failed = false;
+            }
+        }
+
+      if (dirty && (want_sync || quit || since_sync.elapsed () >= sync_interval_ms))
+        {
+          if (file.isOpen ()) sync_to_disk (file);
+          dirty = false;
+          since_sync.restart ();
+        }
+
+      if (quit) break;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef ALL_TXT_WRITER_HPP_
+#define ALL_TXT_WRITER_HPP_
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <QList>
+
+//
+// AllTxtWriter - append lines to ALL.TXT and friends on a dedicated thread
+//
+//  Lines are queued by  the GUI thread  and written by  a worker that
+//  keeps the current file  open, switching files when  the path of a
+//  line  differs from  the  last,  as happens  at a  split  file
+//  rollover.  The  file is  flushed after  each batch  and  synced to
+//  disk by sync ()  or every few seconds. The queue is bounded,  when
+//  it is full append () waits briefly for space and then drops the
+//  line rather than stall the caller. Failures are reported through
+//  the error () signal, once until the next successful write.
+//
+class AllTxtWriter final
+  : public QThread
+{
+  Q_OBJECT
+
+public:
+  explicit AllTxtWriter (QObject * parent = nullptr);
+  ~AllTxtWriter ();
+
+  // queue line for appending to the file at path, returns false if it
+  // was dropped
+  bool append (QString const& path, QString const& line);
+
+  // commit everything written so far to disk, e.g. at period end
+  void sync ();
+
+  // delete the file at path once preceding lines are written
+  void remove (QString const& path);
+
+  Q_SIGNAL void error (QString const& message) const;
+
+protected:
+  void run () override;
+
+private:
+  enum class Op {append, sync, remove};
+  struct Request
+  {
+    Op op;
+    QString path;
+    QString line;
+  };
+
+  static int const queue_limit;
+  static int const wait_for_space_ms;
+  static int const sync_interval_ms;
+
+  void enqueue (Request&&);
+
+  QMutex mutex_;
+  QWaitCondition work_ready_;
+  QWaitCondition space_ready_;
+  QList<Request> queue_;
+  int dropped_;
+  bool quit_;
+};
+
+#endif
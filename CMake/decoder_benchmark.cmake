@@ -0,0 +1,466 @@
+#
+# Decoder benchmark, run by the "benchmark" target.
+#
+# Generates a corpus of .wav files for each mode and SNR, decodes them
+# with jt9 and writes, to WORK_DIR:
+#
+#   benchmark.csv   one row per scenario, routine "(total)", with the
+#                   numbers of signals sent, decoded and false decodes,
+#                   followed by rows with the time spent in each jt9
+#                   timer routine
+#   benchmark.json  the same as JSON
+#   compare.txt     decode count differences from BASELINE and time
+#                   differences from the previous run in WORK_DIR
+#
+# FT8 and FT4 files are crowded bands from ft8sim_mult and ft4sim_mult
+# for each combination of signal count and SNR; Q65, FST4, JT65 and
+# MSK144 files hold a single signal from q65sim, fst4sim, jt65sim and
+# msk144sim at each of that mode's SNRs.
+#
+# The corpus has to be the same on every run for the counts to mean
+# anything.  The simulators' noise comes from gran(), i.e. rand(),
+# which nothing seeds.  gfortran seeds an unseeded random_number
+# differently on every run so ft4sim_mult seeds its random DTs with a
+# constant (it ignores the DTs in messages.txt), jt65sim is run with
+# -p and no Doppler spread so it never calls random_number, and the
+# other simulators do not use it.  The corpus checksum is recorded
+# with each scenario's counts so that a changed corpus, e.g. from
+# another C library's rand(), shows as such rather than as a decoder
+# change.
+#
+# BASELINE holds only those checksums and counts, which are the same
+# on any machine with the same corpus.  Timer figures are the elapsed
+# times recorded by jt9's timer module, i.e. as written to timer.out,
+# so they are only compared with the previous run's benchmark.csv in
+# WORK_DIR, from the same machine.
+#
+# Required: JT9, WORK_DIR and the simulator for each of MODES, i.e.
+#           FT8SIM_MULT, FT4SIM_MULT, Q65SIM, FST4SIM, JT65SIM and
+#           MSK144SIM
+# Optional: BASELINE (csv file to compare against), UPDATE_BASELINE,
+#           MODES, SIGNALS, SNRS (FT8 and FT4), Q65_SNRS, FST4_SNRS,
+#           JT65_SNRS, MSK144_SNRS, FILES, DEPTH, TIME_TOLERANCE (%)
+#
+foreach (__var JT9 WORK_DIR)
+  if (NOT DEFINED ${__var})
+    message (FATAL_ERROR "decoder_benchmark.cmake: ${__var} not set")
+  endif ()
+endforeach ()
+if (NOT MODES)
+  set (MODES FT8 FT4 Q65 FST4 JT65 MSK144)
+endif ()
+if (NOT SIGNALS)
+  set (SIGNALS 10 25 40)
+endif ()
+if (NOT SNRS)
+  set (SNRS -10 -16 -20)
+endif ()
+if (NOT Q65_SNRS)
+  set (Q65_SNRS -26 -30 -31)
+endif ()
+if (NOT FST4_SNRS)
+  set (FST4_SNRS -22 -26 -28)
+endif ()
+if (NOT JT65_SNRS)
+  set (JT65_SNRS -24 -28 -29)
+endif ()
+if (NOT MSK144_SNRS)
+  set (MSK144_SNRS -2 -5 -6)
+endif ()
+if (NOT FILES)
+  set (FILES 4)
+endif ()
+if (NOT DEPTH)
+  set (DEPTH 3)
+endif ()
+if (NOT TIME_TOLERANCE)
+  set (TIME_TOLERANCE 10)
+endif ()
+
+# right justify value in a field of width characters
+function (rjust value width result)
+  string (LENGTH "${value}" __len)
+  set (__out "${value}")
+  while (__len LESS width)
+    set (__out " ${__out}")
+    math (EXPR __len "${__len} + 1")
+  endwhile ()
+  set (${result} "${__out}" PARENT_SCOPE)
+endfunction ()
+
+# a standard callsign made from a number
+function (make_call n result)
+  set (__prefixes K W N G F DL JA VK PA SM)
+  set (__letters A B C D E F G H I J K L M N O P Q R S T U V W X Y Z)
+  math (EXPR __p "${n} % 10")
+  math (EXPR __d "(${n} / 10) % 10")
+  math (EXPR __a "(${n} * 7) % 26")
+  math (EXPR __b "(${n} / 3) % 26")
+  math (EXPR __c "(${n} * 11 + 5) % 26")
+  list (GET __prefixes ${__p} __prefix)
+  list (GET __letters ${__a} __l1)
+  list (GET __letters ${__b} __l2)
+  list (GET __letters ${__c} __l3)
+  set (${result} "${__prefix}${__d}${__l1}${__l2}${__l3}" PARENT_SCOPE)
+endfunction ()
+
+# the messages.txt read by ftXsim_mult
+function (write_messages mode nsigs snr path)
+  set (__grids FN42 EN37 JO22 IO91 PM95 QF22 GG66 KP20 DM79 EM10)
+  set (__text "")
+  string (REPEAT " " 31 __pad)   # the a4,30x before the SNR
+  foreach (__file RANGE 1 ${FILES})
+    rjust (${__file} 2 __n)
+    string (APPEND __text "File${__n}\n")
+    foreach (__sig RANGE 1 ${nsigs})
+      math (EXPR __id "${__file} * 1000 + ${__sig}")
+      make_call (${__id} __call1)
+      math (EXPR __id "${__id} + 500")
+      make_call (${__id} __call2)
+      math (EXPR __g "${__sig} % 10")
+      list (GET __grids ${__g} __grid)
+      math (EXPR __kind "${__sig} % 3")
+      if (__kind EQUAL 0)
+        set (__msg "CQ ${__call1} ${__grid}")
+      elseif (__kind EQUAL 1)
+        set (__msg "${__call1} ${__call2} ${__grid}")
+      else ()
+        math (EXPR __report "-(10 + ${__sig} % 15)")
+        set (__msg "${__call1} ${__call2} ${__report}")
+      endif ()
+      # spread across the band with a little jitter, SNRs within +/-3 dB
+      math (EXPR __freq "200 + (${__sig} - 1) * 2700 / ${nsigs} + (${__file} * 7 + ${__sig} * 13) % 17")
+      if (mode STREQUAL "FT4")
+        math (EXPR __freq "(${__freq} * 576 + 480) / 960") # ft4sim_mult scales by 960/576
+      endif ()
+      math (EXPR __snr "${snr} + (${__sig} * 5) % 7 - 3")
+      math (EXPR __dt "(${__sig} * 3 + ${__file}) % 11 - 3")
+      if (__dt LESS 0)
+        math (EXPR __dt "-${__dt}")
+        set (__dt "-0.${__dt}")
+      else ()
+        set (__dt "0.${__dt}")
+      endif ()
+      rjust ("${__snr}" 3 __snr)
+      rjust ("${__dt}" 5 __dt)
+      rjust ("${__freq}" 5 __freq)
+      string (APPEND __text "Sig${__pad}${__snr}${__dt}${__freq} ${__msg}\n")
+    endforeach ()
+  endforeach ()
+  file (WRITE "${path}" "${__text}")
+endfunction ()
+
+# split program output into a list of lines, protecting semicolons
+function (output_lines text result)
+  string (REPLACE ";" ":" __text "${text}")
+  string (REPLACE "\r" "" __text "${__text}")
+  string (REPLACE "\n" ";" __text "${__text}")
+  set (${result} "${__text}" PARENT_SCOPE)
+endfunction ()
+
+# the message sent by the single signal simulators
+set (single_message "K1ABC W9XYZ EN37")
+
+# as the GUI runs jt9, the JT65 decoder needs more than the default
+# OpenMP thread stack
+if (NOT DEFINED ENV{OMP_STACKSIZE})
+  set (ENV{OMP_STACKSIZE} 4M)
+endif ()
+
+file (MAKE_DIRECTORY "${WORK_DIR}")
+set (csv "mode,signals,snr,routine,seconds,self_seconds,calls,sent,decoded,false\n")
+set (counts "mode,signals,snr,corpus,sent,decoded,false\n")
+set (json "[\n")
+set (first_scenario TRUE)
+
+foreach (mode ${MODES})
+  set (signal_counts ${SIGNALS})
+  set (snrs ${SNRS})
+  if (mode STREQUAL "FT8")
+    set (sim_var FT8SIM_MULT)
+    set (jt9_options -8)
+  elseif (mode STREQUAL "FT4")
+    set (sim_var FT4SIM_MULT)
+    set (jt9_options -5)
+  elseif (mode STREQUAL "Q65")
+    set (sim_var Q65SIM)
+    set (jt9_options -3 -p 60 -b A)
+  elseif (mode STREQUAL "FST4")
+    set (sim_var FST4SIM)
+    set (jt9_options -7 -p 60)
+  elseif (mode STREQUAL "JT65")
+    set (sim_var JT65SIM)
+    set (jt9_options -6)
+  elseif (mode STREQUAL "MSK144")
+    set (sim_var MSK144SIM)
+    set (jt9_options -k -p 15)
+  else ()
+    message (FATAL_ERROR "decoder_benchmark.cmake: unsupported mode ${mode}")
+  endif ()
+  if (NOT DEFINED ${sim_var})
+    message (FATAL_ERROR "decoder_benchmark.cmake: ${sim_var} not set")
+  endif ()
+  set (sim "${${sim_var}}")
+  if (NOT mode MATCHES "^FT[48]$")
+    set (signal_counts 1)
+    set (snrs ${${mode}_SNRS})
+  endif ()
+  foreach (nsigs ${signal_counts})
+    foreach (snr ${snrs})
+      set (scenario "${mode}_${nsigs}_${snr}")
+      set (dir "${WORK_DIR}/${scenario}")
+      file (REMOVE_RECURSE "${dir}")
+      file (MAKE_DIRECTORY "${dir}")
+      message (STATUS "Benchmark ${mode}, ${nsigs} signals at ${snr} dB")
+
+      # the corpus, and what was sent
+      if (mode MATCHES "^FT[48]$")
+        write_messages (${mode} ${nsigs} ${snr} "${dir}/messages.txt")
+        set (sim_command "${sim}" ${nsigs} ${FILES})
+      elseif (mode STREQUAL "Q65")
+        set (sim_command "${sim}" "${single_message}" A 1500 0.0 0.0 0.0 1 60 1 ${FILES} ${snr})
+      elseif (mode STREQUAL "FST4")
+        set (sim_command "${sim}" "${single_message}" 60 1500 0.0 0.1 1.0 ${FILES} ${snr} F)
+      elseif (mode STREQUAL "JT65")
+        # a leading \ lets jt65sim read a negative SNR
+        set (sim_command "${sim}" -p -n 1 -f ${FILES} -s "\\${snr}" -M "${single_message}")
+      else ()
+        set (sim_command "${sim}" "${single_message}" 15 1500 0.12 ${snr} ${FILES})
+      endif ()
+      execute_process (COMMAND ${sim_command}
+        WORKING_DIRECTORY "${dir}"
+        OUTPUT_VARIABLE sim_output
+        RESULT_VARIABLE rc)
+      if (rc)
+        message (FATAL_ERROR "${sim} failed: ${rc}")
+      endif ()
+      set (sent)
+      set (wav_files)
+      if (mode MATCHES "^FT[48]$")
+        output_lines ("${sim_output}" lines)
+        foreach (line ${lines})
+          if (line MATCHES "^000000_([0-9][0-9][0-9][0-9][0-9][0-9]) +[0-9]+ +-?[0-9]+ +-?[0-9.]+ +[0-9]+  (.*)$")
+            set (file_number ${CMAKE_MATCH_1})
+            string (STRIP "${CMAKE_MATCH_2}" msg)
+            list (APPEND sent "${file_number}|${msg}")
+            list (APPEND wav_files "${dir}/000000_${file_number}.wav")
+          endif ()
+        endforeach ()
+        list (REMOVE_DUPLICATES wav_files)
+      else ()
+        # one signal in each file, jt9 reports the digits after the
+        # underscore as the time
+        file (GLOB wav_files "${dir}/*.wav")
+        list (SORT wav_files)
+        foreach (wav_file ${wav_files})
+          if (wav_file MATCHES "_([0-9]+)\\.wav$")
+            list (APPEND sent "${CMAKE_MATCH_1}|${single_message}")
+          endif ()
+        endforeach ()
+      endif ()
+      list (LENGTH sent nsent)
+      set (corpus "")
+      foreach (wav_file ${wav_files})
+        file (MD5 "${wav_file}" md5)
+        string (APPEND corpus "${md5}")
+      endforeach ()
+      string (MD5 corpus "${corpus}")
+      string (SUBSTRING "${corpus}" 0 8 corpus)
+
+      # decode
+      execute_process (COMMAND "${JT9}" ${jt9_options} -d ${DEPTH} -a "${dir}" -t "${dir}" ${wav_files}
+        WORKING_DIRECTORY "${dir}"
+        OUTPUT_VARIABLE jt9_output
+        RESULT_VARIABLE rc)
+      if (rc)
+        message (FATAL_ERROR "${JT9} failed: ${rc}")
+      endif ()
+      file (WRITE "${dir}/decodes.txt" "${jt9_output}")
+      output_lines ("${jt9_output}" lines)
+      set (decoded)
+      set (nfalse 0)
+      foreach (line ${lines})
+        if (line MATCHES "^([0-9][0-9][0-9][0-9]|[0-9][0-9][0-9][0-9][0-9][0-9]) +-?[0-9]+ +-?[0-9.]+ +[0-9]+ [~+:`#&]  (.*)$")
+          set (file_number ${CMAKE_MATCH_1})
+          # drop annotations like the AP type or Q65 decode type and
+          # the low confidence marker
+          string (STRIP "${CMAKE_MATCH_2}" msg)
+          string (REGEX REPLACE " +[a-z][0-9]*$" "" msg "${msg}")
+          string (REGEX REPLACE "[ ?]+$" "" msg "${msg}")
+          list (FIND sent "${file_number}|${msg}" index)
+          if (index LESS 0)
+            math (EXPR nfalse "${nfalse} + 1")
+          else ()
+            list (APPEND decoded "${file_number}|${msg}")
+          endif ()
+        endif ()
+      endforeach ()
+      list (REMOVE_DUPLICATES decoded)
+      list (LENGTH decoded ndecoded)
+
+      # per-routine times from timer.out
+      set (routines)
+      set (total_seconds 0)
+      if (EXISTS "${dir}/timer.out")
+        file (STRINGS "${dir}/timer.out" timer_lines)
+        set (in_table FALSE)
+        foreach (line ${timer_lines})
+          # the table sits between the two rules below the heading
+          if (line MATCHES "^ Name +Time")
+            set (in_table HEADING)
+          elseif (line MATCHES "^---")
+            if (in_table STREQUAL "HEADING")
+              set (in_table TRUE)
+            else ()
+              set (in_table FALSE)
+            endif ()
+          elseif (in_table AND line MATCHES "^(................) *([0-9.]+) +[0-9.]+ +([0-9.]+) +[0-9.]+ +([0-9]+)$")
+            string (STRIP "${CMAKE_MATCH_1}" routine)
+            set (seconds ${CMAKE_MATCH_2})
+            set (self_seconds ${CMAKE_MATCH_3})
+            set (calls ${CMAKE_MATCH_4})
+            if (routine STREQUAL "jt9")
+              set (total_seconds ${seconds})
+            endif ()
+            list (APPEND routines "${routine},${seconds},${self_seconds},${calls}")
+          endif ()
+        endforeach ()
+      endif ()
+
+      message (STATUS "  ${ndecoded} of ${nsent} decoded, ${nfalse} false, ${total_seconds} s")
+      string (APPEND csv "${mode},${nsigs},${snr},(total),${total_seconds},,${FILES},${nsent},${ndecoded},${nfalse}\n")
+      string (APPEND counts "${mode},${nsigs},${snr},${corpus},${nsent},${ndecoded},${nfalse}\n")
+      if (NOT first_scenario)
+        string (APPEND json ",\n")
+      endif ()
+      set (first_scenario FALSE)
+      string (APPEND json "  {\"mode\": \"${mode}\", \"signals\": ${nsigs}, \"snr\": ${snr}, \"files\": ${FILES},\n"
+        "   \"corpus\": \"${corpus}\", \"sent\": ${nsent}, \"decoded\": ${ndecoded}, \"false\": ${nfalse}, \"seconds\": ${total_seconds},\n"
+        "   \"routines\": [")
+      set (first_routine TRUE)
+      foreach (routine ${routines})
+        string (REPLACE "," ";" fields "${routine}")
+        list (GET fields 0 name)
+        list (GET fields 1 seconds)
+        list (GET fields 2 self_seconds)
+        list (GET fields 3 calls)
+        string (APPEND csv "${mode},${nsigs},${snr},${name},${seconds},${self_seconds},${calls},,,\n")
+        if (NOT first_routine)
+          string (APPEND json ",")
+        endif ()
+        set (first_routine FALSE)
+        string (APPEND json "\n     {\"name\": \"${name}\", \"seconds\": ${seconds}, \"self_seconds\": ${self_seconds}, \"calls\": ${calls}}")
+      endforeach ()
+      string (APPEND json "]}")
+    endforeach ()
+  endforeach ()
+endforeach ()
+string (APPEND json "\n]\n")
+
+# the previous run's times, before they are replaced
+set (previous_rows)
+if (EXISTS "${WORK_DIR}/benchmark.csv")
+  file (STRINGS "${WORK_DIR}/benchmark.csv" previous_rows)
+endif ()
+file (WRITE "${WORK_DIR}/benchmark.csv" "${csv}")
+file (WRITE "${WORK_DIR}/benchmark.json" "${json}")
+message (STATUS "Results written to ${WORK_DIR}/benchmark.csv and benchmark.json")
+
+# escape text for use in a regular expression
+function (regex_escape text result)
+  string (REGEX REPLACE "([][+.*()^$?|\\\\])" "\\\\\\1" __text "${text}")
+  set (${result} "${__text}" PARENT_SCOPE)
+endfunction ()
+
+set (report "")
+
+#
+# compare decode counts with the baseline
+#
+set (regressions 0)
+if (BASELINE AND EXISTS "${BASELINE}")
+  file (STRINGS "${BASELINE}" baseline_rows)
+  output_lines ("${counts}" rows)
+  foreach (row ${rows})
+    if (NOT row MATCHES "^mode,"
+        AND row MATCHES "^([^,]+,[^,]+,[^,]+),([^,]*),[^,]*,([^,]*),([^,]*)$")
+      set (key "${CMAKE_MATCH_1}")
+      set (corpus "${CMAKE_MATCH_2}")
+      set (decoded "${CMAKE_MATCH_3}")
+      set (false_decodes "${CMAKE_MATCH_4}")
+      regex_escape ("${key}" key_regex)
+      foreach (base ${baseline_rows})
+        if (base MATCHES "^${key_regex},([^,]*),[^,]*,([^,]*),([^,]*)$")
+          set (base_corpus "${CMAKE_MATCH_1}")
+          set (base_decoded "${CMAKE_MATCH_2}")
+          set (base_false "${CMAKE_MATCH_3}")
+          if (NOT corpus STREQUAL base_corpus)
+            string (APPEND report "${key}: corpus ${base_corpus} -> ${corpus}, counts not comparable\n")
+          elseif (NOT decoded STREQUAL base_decoded OR NOT false_decodes STREQUAL base_false)
+            string (APPEND report "${key}: decoded ${base_decoded} -> ${decoded}, false ${base_false} -> ${false_decodes}\n")
+            if (decoded LESS base_decoded OR false_decodes GREATER base_false)
+              math (EXPR regressions "${regressions} + 1")
+            endif ()
+          endif ()
+          break ()
+        endif ()
+      endforeach ()
+    endif ()
+  endforeach ()
+elseif (BASELINE)
+  message (STATUS "No baseline at ${BASELINE}")
+endif ()
+
+#
+# compare times with the previous run
+#
+output_lines ("${csv}" rows)
+foreach (row ${rows})
+  if (NOT row MATCHES "^mode,"
+      AND row MATCHES "^([^,]+,[^,]+,[^,]+,[^,]+),([^,]*),")
+    set (key "${CMAKE_MATCH_1}")
+    set (seconds "${CMAKE_MATCH_2}")
+    regex_escape ("${key}" key_regex)
+    # a routine called from several places has a row for each, match
+    # them in order
+    string (MD5 key_id "${key}")
+    if (NOT DEFINED occurrences_${key_id})
+      set (occurrences_${key_id} 0)
+    endif ()
+    math (EXPR occurrences_${key_id} "${occurrences_${key_id}} + 1")
+    set (occurrence 0)
+    foreach (previous ${previous_rows})
+      if (previous MATCHES "^${key_regex},([^,]*),")
+        math (EXPR occurrence "${occurrence} + 1")
+        if (occurrence EQUAL occurrences_${key_id})
+          set (previous_seconds "${CMAKE_MATCH_1}")
+          # times to the millisecond, changes beyond the tolerance in
+          # routines taking long enough to measure
+          string (REPLACE "." "" ms "${seconds}")
+          string (REPLACE "." "" previous_ms "${previous_seconds}")
+          if (previous_ms GREATER 100)
+            math (EXPR change "(${ms} - ${previous_ms}) * 100 / ${previous_ms}")
+            if (change GREATER TIME_TOLERANCE OR change LESS -${TIME_TOLERANCE})
+              string (APPEND report "${key}: ${previous_seconds} s -> ${seconds} s (${change}%)\n")
+            endif ()
+          endif ()
+          break ()
+        endif ()
+      endif ()
+    endforeach ()
+  endif ()
+endforeach ()
+
+file (WRITE "${WORK_DIR}/compare.txt" "${report}")
+if (report)
+  message (STATUS "Changes from the baseline counts and previous times:\n${report}")
+else ()
+  message (STATUS "No changes from the baseline counts or beyond ${TIME_TOLERANCE}% of the previous times")
+endif ()
+if (regressions)
+  message (WARNING "${regressions} scenario(s) decode worse than the baseline")
+endif ()
+if (BASELINE AND UPDATE_BASELINE)
+  file (WRITE "${BASELINE}" "${counts}")
+  message (STATUS "Baseline ${BASELINE} updated")
+endif ()
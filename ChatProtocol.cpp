@@ -1,7 +1,6 @@
 // -*- Mode: C++ -*-
 #include "ChatProtocol.h"
 #include <QDebug>
-#include <cstring>
 
 // --- Helpers FT8 ---
 
@@ -211,6 +210,10 @@ void ChatProtocol::reset()
   m_rxCompleteTimer.stop();
   m_directTxTracker.stop();
   m_directTxCurrentFrag = -1;
+  if (m_directTxWaveform) {
+    m_directTxWaveform->stop();
+    m_directTxWaveform.clear();
+  }
   setState(Idle);
 }
 
@@ -440,6 +443,11 @@ void ChatProtocol::haltTx()
 void ChatProtocol::notifyDirectTxComplete()
 {
   m_directTxTracker.stop();
+  if (m_directTxWaveform && m_directTxWaveform->missing()) {
+    qDebug() << "ChatProtocol: direct TX," << m_directTxWaveform->missing()
+             << "samples not synthesized in time";
+  }
+  if (m_directTxWaveform) m_directTxWaveform->stop();
   // Emettre le dernier fragment comme "envoyé"
   if (!m_fragments.isEmpty()) {
     int total = m_fragments.size();
@@ -535,51 +543,13 @@ void ChatProtocol::sendDirect(const QString &targetId, const QString &text, doub
 
 int ChatProtocol::prepareTxWaveform(const QStringList &fragments, double txFreq)
 {
-  int offset = 0;  // sample offset in foxcom_.wave[]
-
-  for (int i = 0; i < fragments.size(); ++i) {
-    // Prepare the 37-char padded message buffer for Fortran
-    QByteArray msgBa = fragments.at(i).toLatin1().leftJustified(37, ' ');
-    char message[37];
-    std::memcpy(message, msgBa.constData(), 37);
-
-    char msgsent[37];
-    std::memset(msgsent, ' ', 37);
-    char ft8msgbits[77];
-    std::memset(ft8msgbits, 0, 77);
-    int itone[79];
-    std::memset(itone, 0, sizeof(itone));
-
-    int i3 = 0, n3 = 0;
-
-    // Encode the message into tone sequence
-    genft8_(message, &i3, &n3, msgsent, ft8msgbits, itone,
-            (fortran_charlen_t)37, (fortran_charlen_t)37);
-
-    // Generate waveform from tones
-    int nsym = FT8_NSYM;        // 79 symbols
-    int nsps = FT8_NSPS;        // 7680 samples/symbol
-    float bt = 2.0f;
-    float fsample = 48000.0f;
-    float f0 = static_cast<float>(txFreq);
-    int icmplx = 0;
-    int nwave = nsym * nsps;     // 606720 samples
-
-    // Write directly into foxcom_.wave[] at the correct offset
-    gen_ft8wave_(itone, &nsym, &nsps, &bt, &fsample, &f0,
-                 &foxcom_.wave[offset], &foxcom_.wave[offset],
-                 &icmplx, &nwave);
-
-    // Fill the remaining gap with silence (2.36s) to complete the 15s period
-    for (int j = nwave; j < SAMPLES_PER_PERIOD; ++j) {
-      foxcom_.wave[offset + j] = 0.0f;
-    }
+  // Les fragments sont encodés ici ; l'audio est synthétisé par le thread
+  // du ChatWaveform, le fragment suivant pendant que le courant est émis,
+  // dans un tampon circulaire de taille fixe lu par le Modulator.
+  m_directTxWaveform = QSharedPointer<ChatWaveform>::create(fragments, qRound(txFreq));
+  m_directTxWaveform->start(QThread::HighPriority);
 
-    offset += SAMPLES_PER_PERIOD;
-
-    qDebug() << "ChatProtocol: encoded fragment" << (i + 1) << "/" << fragments.size()
-             << ":" << fragments.at(i) << "offset=" << offset;
-  }
+  qDebug() << "ChatProtocol: encoded" << fragments.size() << "fragment(s):" << fragments;
 
   // Calculate total symbols for the Modulator
   // totalSamples = N * SAMPLES_PER_PERIOD
@@ -610,7 +580,6 @@ int ChatProtocol::prepareTxWaveform(const QStringList &fragments, double txFreq)
 void ChatProtocol::startDirectTxTracking()
 {
   m_directTxCurrentFrag = -1;  // Force le premier tick à émettre le signal
-  m_directTxElapsed.start();
   m_directTxTracker.start();
   // Tick immédiat pour afficher le fragment 1
   onDirectTxTick();
@@ -618,14 +587,15 @@ void ChatProtocol::startDirectTxTracking()
 
 void ChatProtocol::onDirectTxTick()
 {
-  if (m_state != DirectTx || m_fragments.isEmpty()) {
+  if (m_state != DirectTx || m_fragments.isEmpty() || !m_directTxWaveform) {
     m_directTxTracker.stop();
     return;
   }
 
-  // Calculer quel fragment est en cours basé sur le temps écoulé
-  qint64 elapsedMs = m_directTxElapsed.elapsed();
-  int fragIndex = static_cast<int>(elapsedMs / 15000);  // 15s par fragment
+  // Calculer quel fragment est en cours d'après les échantillons
+  // effectivement lus par le Modulator
+  unsigned consumed = m_directTxWaveform->consumed();
+  int fragIndex = static_cast<int>(consumed / SAMPLES_PER_PERIOD);
 
   if (fragIndex >= m_fragments.size()) {
     fragIndex = m_fragments.size() - 1;
@@ -646,7 +616,7 @@ void ChatProtocol::onDirectTxTick()
     emit directFragmentStarted(current, total, currentText, nextText);
     emit fragmentProgress(current, total, false);
 
-    int secsRemaining = (total - current) * 15 + 15 - static_cast<int>((elapsedMs % 15000) / 1000);
+    int secsRemaining = (total - current) * 15 + 15 - static_cast<int>(consumed % SAMPLES_PER_PERIOD / 48000);
     emit statusMessage(tr("TX direct %1/%2 — reste %3s")
                         .arg(current).arg(total).arg(secsRemaining));
   }
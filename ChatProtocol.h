@@ -6,18 +6,9 @@
 #include <QString>
 #include <QStringList>
 #include <QTimer>
-#include <QElapsedTimer>
+#include <QSharedPointer>
 
-#include "commons.h"
-#include "wsjtx_config.h"
-
-// Fortran routines for FT8 encoding
-extern "C" {
-  void genft8_(char* msg, int* i3, int* n3, char* msgsent, char ft8msgbits[],
-               int itone[], fortran_charlen_t, fortran_charlen_t);
-  void gen_ft8wave_(int itone[], int* nsym, int* nsps, float* bt, float* fsample,
-                    float* f0, float xjunk[], float wave[], int* icmplx, int* nwave);
-}
+#include "Modulator/ChatWaveform.hpp"
 
 //
 // Protocole Chat HF par écho + broadcast
@@ -89,10 +80,11 @@ public:
   void haltTx();
   void notifyDirectTxComplete();
 
-  // Emission directe : encode N trames FT8 dans foxcom_.wave[]
+  // Emission directe : N trames FT8 synthétisées au fil de l'émission
   void sendDirect(const QString &targetId, const QString &text, double txFreq);
   int prepareTxWaveform(const QStringList &fragments, double txFreq);
   void startDirectTxTracking();  // Démarre le suivi temps réel des fragments
+  QSharedPointer<ChatWaveform> directTxWaveform() const { return m_directTxWaveform; }
 
   State state() const { return m_state; }
   int currentFragment() const { return m_fragIndex + 1; }
@@ -177,7 +169,7 @@ private:
 
   // Suivi émission directe
   QTimer m_directTxTracker;     // Timer périodique pour suivre l'avancement
-  QElapsedTimer m_directTxElapsed; // Temps écoulé depuis début émission
+  QSharedPointer<ChatWaveform> m_directTxWaveform; // Source lue par le Modulator
   int m_directTxCurrentFrag;    // Fragment en cours (index 0-based)
 
 private slots:
@@ -53,6 +53,34 @@ DecodedText::DecodedText (QString const& the_string)
                                                     // seconds
   , message_ {string_.mid (column_qsoText + padding_).trimmed ()}
   , is_standard_ {false}
+  , time_ {3600 * string_.mid (column_time, 2).toUInt ()
+      + 60 * string_.mid (column_time + 2, 2).toUInt()
+      + (padding_ ? string_.mid (column_time + 2 + padding_, 2).toUInt () : 0U)}
+  , snr_ {string_.mid (string_.indexOf (" ") + 1, 3).toInt ()}
+  , dt_ {string_.mid (column_dt + padding_, 5).toFloat ()}
+  , frequency_ {string_.mid (column_freq + padding_, 4).toInt ()}
+{
+  parse_message ();
+}
+
+DecodedText::DecodedText (QString const& the_string, int utc, int snr, float dt, int frequency)
+  : string_ {the_string.left (the_string.indexOf (QChar::Nbsp))} // discard appended info
+  , clean_string_ {string_}
+  , padding_ {string_.indexOf (" ") > 4 ? 2 : 0} // allow for
+                                                    // seconds
+  , message_ {string_.mid (column_qsoText + padding_).trimmed ()}
+  , is_standard_ {false}
+  , time_ {static_cast<unsigned> (padding_
+                                  ? 3600 * (utc / 10000) + 60 * (utc / 100 % 100) + utc % 100
+                                  : 3600 * (utc / 100) + 60 * (utc % 100))}
+  , snr_ {snr}
+  , dt_ {qRound (dt * 10.f) / 10.f} // as shown in the text
+  , frequency_ {frequency}
+{
+  parse_message ();
+}
+
+void DecodedText::parse_message ()
 {
   // discard appended AP info
   clean_string_.replace (QRegularExpression {R"(^(.*?)(?:\?\s)?[aq][0-9].*$)"}, "\\1");
@@ -86,7 +114,7 @@ DecodedText::DecodedText (QString const& the_string)
       message_c_string += QByteArray {37 - message_c_string.size (), ' '};
       is_standard_ = stdmsg_(message_c_string.constData(),37);
     }
-};
+}
 
 QStringList DecodedText::messageWords () const
 {
@@ -133,22 +161,6 @@ bool DecodedText::isLowConfidence () const
   return QChar {'?'} == string_.mid (padding_ + column_qsoText + 36, 1);
 }
 
-int DecodedText::frequencyOffset() const
-{
-    return string_.mid(column_freq + padding_,4).toInt();
-}
-
-int DecodedText::snr() const
-{
-  int i1=string_.indexOf(" ")+1;
-  return string_.mid(i1,3).toInt();
-}
-
-float DecodedText::dt() const
-{
-  return string_.mid(column_dt + padding_,5).toFloat();
-}
-
 /*
 2343 -11  0.8 1259 # YV6BFE F6GUU R-08
 2343 -19  0.3  718 # VE6WQ SQ2NIJ -14
@@ -223,13 +235,6 @@ void DecodedText::deCallAndGrid(/*out*/QString& call, QString& grid) const
   if ("R" == grid) grid = match.captured ("word4");
 }
 
-unsigned DecodedText::timeInSeconds() const
-{
-  return 3600 * string_.mid (column_time, 2).toUInt ()
-    + 60 * string_.mid (column_time + 2, 2).toUInt()
-    + (padding_ ? string_.mid (column_time + 2 + padding_, 2).toUInt () : 0U);
-}
-
 QString DecodedText::report() const // returns a string of the SNR field with a leading + or - followed by two digits
 {
     int sr = snr();
@@ -31,6 +31,10 @@ class DecodedText
 public:
   explicit DecodedText (QString const& message);
 
+  // as above but with the time (hhmm or hhmmss as in the text), SNR,
+  // DT and audio frequency as the decoder passed them
+  explicit DecodedText (QString const& message, int utc, int snr, float dt, int frequency);
+
   QString string() const { return string_; };
   QString clean_string() const { return clean_string_; };
   QStringList messageWords () const;
@@ -48,9 +52,9 @@ public:
   bool isTX() const;
   bool isStandardMessage () const {return is_standard_;}
   bool isLowConfidence () const;
-  int frequencyOffset() const;  // hertz offset from the tuned dial or rx frequency, aka audio frequency
-  int snr() const;
-  float dt() const;
+  int frequencyOffset() const {return frequency_;}  // hertz offset from the tuned dial or rx frequency, aka audio frequency
+  int snr() const {return snr_;}
+  float dt() const {return dt_;}
 
   // find and extract any report. Returns true if this is a standard message
   bool report(QString const& myBaseCall, QString const& dxBaseCall, /*mod*/QString& report) const;
@@ -61,12 +65,14 @@ public:
   // get the second word, most likely the de call and the third word, most likely grid
   void deCallAndGrid(/*out*/QString& call, QString& grid) const;
 
-  unsigned timeInSeconds() const;
+  unsigned timeInSeconds() const {return time_;}
 
   // returns a string of the SNR field with a leading + or - followed by two digits
   QString report() const;
 
 private:
+  void parse_message ();
+
   // These define the columns in the decoded text where fields are to be found.
   // We rely on these columns being the same in the fortran code (lib/decoder.f90) that formats the decoded text
   enum Columns {column_time    = 0,
@@ -82,6 +88,10 @@ private:
   QString message_;
   QString message0_;
   bool is_standard_;
+  unsigned time_;
+  int snr_;
+  float dt_;
+  int frequency_;
 };
 
 #endif // DECODEDTEXT_H
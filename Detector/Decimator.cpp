@@ -0,0 +1,215 @@
+#include "Decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define DECIMATOR_X86 1
+#include <immintrin.h>
+#endif
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define DECIMATOR_NEON 1
+#include <arm_neon.h>
+#endif
+
+unsigned const Decimator::factor;
+unsigned const Decimator::taps;
+unsigned const Decimator::padded_taps;
+unsigned const Decimator::chunk;
+
+namespace
+{
+  // fil4's coefficients, designed using ScopeFIR
+  //
+  // fsample     = 48000 Hz
+  // Ntaps       = 49
+  // fc          = 4500  Hz
+  // fstop       = 6000  Hz
+  // Ripple      = 1     dB
+  // Stop Atten  = 40    dB
+  // fout        = 12000 Hz
+  //
+  // led by zeros to a multiple of the widest vector, the newest sample
+  // is multiplied by the last
+  alignas (32) float const w[Decimator::padded_taps] = {
+    0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+    0.000861074040f, 0.010051920210f, 0.010161983649f, 0.011363155076f,
+    0.008706594219f, 0.002613872664f,-0.005202883094f,-0.011720748164f,
+   -0.013752163325f,-0.009431602741f, 0.000539063909f, 0.012636767098f,
+    0.021494659597f, 0.021951235065f, 0.011564169382f,-0.007656470131f,
+   -0.028965787341f,-0.042637874109f,-0.039203309748f,-0.013153301537f,
+    0.034320769178f, 0.094717832646f, 0.154224604789f, 0.197758325022f,
+    0.213715139513f, 0.197758325022f, 0.154224604789f, 0.094717832646f,
+    0.034320769178f,-0.013153301537f,-0.039203309748f,-0.042637874109f,
+   -0.028965787341f,-0.007656470131f, 0.011564169382f, 0.021951235065f,
+    0.021494659597f, 0.012636767098f, 0.000539063909f,-0.009431602741f,
+   -0.013752163325f,-0.011720748164f,-0.005202883094f, 0.002613872664f,
+    0.008706594219f, 0.011363155076f, 0.010161983649f, 0.010051920210f,
+    0.000861074040f,
+  };
+  static_assert (sizeof w / sizeof w[0] == Decimator::padded_taps, "wrong number of coefficients");
+
+  float dot_scalar (float const * x, float const * c)
+  {
+    float sum {0.f};
+    for (unsigned i = Decimator::padded_taps - Decimator::taps; i < Decimator::padded_taps; ++i)
+      {
+        sum += c[i] * x[i];
+      }
+    return sum;
+  }
+
+#if DECIMATOR_X86
+  __attribute__ ((target ("sse2")))
+  float dot_sse2 (float const * x, float const * c)
+  {
+    __m128 a0 {_mm_setzero_ps ()};
+    __m128 a1 {_mm_setzero_ps ()};
+    for (unsigned i = 0; i < Decimator::padded_taps; i += 8)
+      {
+        a0 = _mm_add_ps (a0, _mm_mul_ps (_mm_loadu_ps (x + i), _mm_load_ps (c + i)));
+        a1 = _mm_add_ps (a1, _mm_mul_ps (_mm_loadu_ps (x + i + 4), _mm_load_ps (c + i + 4)));
+      }
+    a0 = _mm_add_ps (a0, a1);
+    a0 = _mm_add_ps (a0, _mm_movehl_ps (a0, a0));
+    a0 = _mm_add_ss (a0, _mm_shuffle_ps (a0, a0, 1));
+    return _mm_cvtss_f32 (a0);
+  }
+
+  __attribute__ ((target ("avx2")))
+  float dot_avx2 (float const * x, float const * c)
+  {
+    __m256 a {_mm256_setzero_ps ()};
+    for (unsigned i = 0; i < Decimator::padded_taps; i += 8)
+      {
+        a = _mm256_add_ps (a, _mm256_mul_ps (_mm256_loadu_ps (x + i), _mm256_load_ps (c + i)));
+      }
+    __m128 s {_mm_add_ps (_mm256_castps256_ps128 (a), _mm256_extractf128_ps (a, 1))};
+    s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+    s = _mm_add_ss (s, _mm_shuffle_ps (s, s, 1));
+    return _mm_cvtss_f32 (s);
+  }
+#endif
+
+#if DECIMATOR_NEON
+  float dot_neon (float const * x, float const * c)
+  {
+    float32x4_t a0 {vdupq_n_f32 (0.f)};
+    float32x4_t a1 {vdupq_n_f32 (0.f)};
+    for (unsigned i = 0; i < Decimator::padded_taps; i += 8)
+      {
+        a0 = vaddq_f32 (a0, vmulq_f32 (vld1q_f32 (x + i), vld1q_f32 (c + i)));
+        a1 = vaddq_f32 (a1, vmulq_f32 (vld1q_f32 (x + i + 4), vld1q_f32 (c + i + 4)));
+      }
+    a0 = vaddq_f32 (a0, a1);
+    float32x2_t s {vadd_f32 (vget_low_f32 (a0), vget_high_f32 (a0))};
+    return vget_lane_f32 (vpadd_f32 (s, s), 0);
+  }
+#endif
+
+  Decimator::Kernel best_kernel ()
+  {
+    for (auto k : {Decimator::Kernel::avx2, Decimator::Kernel::neon, Decimator::Kernel::sse2})
+      {
+        if (Decimator::supported (k)) return k;
+      }
+    return Decimator::Kernel::scalar;
+  }
+
+  // Fortran nint() semantics, clamped rather than wrapped
+  std::int16_t to_sample (float x)
+  {
+    auto n = std::lround (x);
+    n = std::max<long> (n, std::numeric_limits<std::int16_t>::min ());
+    n = std::min<long> (n, std::numeric_limits<std::int16_t>::max ());
+    return static_cast<std::int16_t> (n);
+  }
+}
+
+bool Decimator::supported (Kernel k)
+{
+  switch (k)
+    {
+    case Kernel::automatic:
+    case Kernel::scalar:
+      return true;
+#if DECIMATOR_X86
+    case Kernel::sse2:
+      return __builtin_cpu_supports ("sse2");
+    case Kernel::avx2:
+      return __builtin_cpu_supports ("avx2");
+#endif
+#if DECIMATOR_NEON
+    case Kernel::neon:
+      return true;
+#endif
+    default:
+      return false;
+    }
+}
+
+char const * Decimator::name (Kernel k)
+{
+  switch (k)
+    {
+    case Kernel::automatic: return "automatic";
+    case Kernel::scalar: return "scalar";
+    case Kernel::sse2: return "SSE2";
+    case Kernel::avx2: return "AVX2";
+    case Kernel::neon: return "NEON";
+    }
+  return "unknown";
+}
+
+Decimator::Decimator (Kernel k)
+  : kernel_ {Kernel::automatic == k || !supported (k) ? best_kernel () : k}
+  , dot_ {dot_scalar}
+  , phase_ {0}
+{
+  switch (kernel_)
+    {
+#if DECIMATOR_X86
+    case Kernel::sse2: dot_ = dot_sse2; break;
+    case Kernel::avx2: dot_ = dot_avx2; break;
+#endif
+#if DECIMATOR_NEON
+    case Kernel::neon: dot_ = dot_neon; break;
+#endif
+    default: break;
+    }
+  reset ();
+}
+
+void Decimator::reset ()
+{
+  std::fill (buffer_, buffer_ + padded_taps - 1, 0.f);
+  phase_ = 0;
+}
+
+std::size_t Decimator::process (std::int16_t const * in, std::size_t frames
+                                , unsigned channels, unsigned channel, std::int16_t * out)
+{
+  auto const history = padded_taps - 1;
+  std::size_t written {0};
+  in += channel;
+  while (frames)
+    {
+      auto n = static_cast<unsigned> (std::min<std::size_t> (frames, chunk));
+      auto * x = buffer_ + history;
+      for (unsigned i = 0; i < n; ++i, in += channels)
+        {
+          x[i] = *in;
+        }
+      // an output follows every factor'th input sample, the sample at
+      // buffer_[j] being the newest that it uses
+      for (auto j = history + factor - 1 - phase_; j < history + n; j += factor)
+        {
+          out[written++] = to_sample (dot_ (buffer_ + j - history, w));
+        }
+      phase_ = (phase_ + n) % factor;
+      std::copy (buffer_ + n, buffer_ + n + history, buffer_);
+      frames -= n;
+    }
+  return written;
+}
@@ -0,0 +1,57 @@
+#ifndef DECIMATOR_HPP__
+#define DECIMATOR_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Decimator - 48000 Hz to 12000 Hz low pass filter and down sampler
+//
+//  A replacement for the Fortran fil4 routine with the same 49 tap
+//  FIR filter, 4500 Hz pass band and 6000 Hz stop band. Samples are
+//  read straight from interleaved audio frames so no de-interleaved
+//  copy is needed, and any number of frames may be passed at a time;
+//  the filter state carries over between calls.
+//
+//  The dot products use SSE2, AVX2 or NEON where the CPU has them,
+//  chosen at run time. Results may differ from fil4 by one count where
+//  the different order of summation rounds the other way.
+//
+class Decimator final
+{
+public:
+  static unsigned const factor {4};
+
+  enum class Kernel {automatic, scalar, sse2, avx2, neon};
+
+  explicit Decimator (Kernel = Kernel::automatic);
+
+  // forget all previous input
+  void reset ();
+
+  // Filter frames of 16 bit samples with channels channels per frame,
+  // using channel channel (from zero). Returns the number of samples
+  // written to out, which must have room for (frames + 3) / 4.
+  std::size_t process (std::int16_t const * in, std::size_t frames
+                       , unsigned channels, unsigned channel, std::int16_t * out);
+
+  // samples the next process () call will write for frames frames
+  std::size_t outputs (std::size_t frames) const {return (phase_ + frames) / factor;}
+
+  Kernel kernel () const {return kernel_;}
+  static bool supported (Kernel);
+  static char const * name (Kernel);
+
+  static unsigned const taps {49};
+  static unsigned const padded_taps {56}; // a multiple of the widest vector
+
+private:
+  static unsigned const chunk {1024};     // input samples converted at a time
+
+  Kernel kernel_;
+  float (* dot_) (float const *, float const *);
+  unsigned phase_;                        // input samples since the last output
+  float buffer_[padded_taps - 1 + chunk]; // history then new input
+};
+
+#endif
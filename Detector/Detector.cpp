@@ -1,5 +1,5 @@
 #include "Detector.hpp"
-#include <QDateTime>
+#include <chrono>
 #include <QtAlgorithms>
 #include <QDebug>
 #include <math.h>
@@ -7,10 +7,6 @@
 
 #include "moc_Detector.cpp"
 
-extern "C" {
-  void   fil4_(qint16*, qint32*, qint16*, qint32*);
-}
-
 extern dec_data_t dec_data;
 
 Detector::Detector (unsigned frameRate, double periodLengthInSeconds,
@@ -20,11 +16,11 @@ Detector::Detector (unsigned frameRate, double periodLengthInSeconds,
   , m_period (periodLengthInSeconds)
   , m_downSampleFactor (downSampleFactor)
   , m_samplesPerFFT {max_buffer_size}
-  , m_buffer ((downSampleFactor > 1) ?
-              new short [max_buffer_size * downSampleFactor] : nullptr)
   , m_bufferPos (0)
+  , m_msInPeriod0 (999999)
 {
   (void)m_frameRate;            // quell compiler warning
+  Q_ASSERT (1 == downSampleFactor || Decimator::factor == downSampleFactor);
   clear ();
 }
 
@@ -56,14 +52,15 @@ void Detector::clear ()
 
 qint64 Detector::writeData (char const * data, qint64 maxSize)
 {
-  static unsigned mstr0=999999;
-  qint64 ms0 = QDateTime::currentMSecsSinceEpoch() % 86400000;
+  // the system clock directly, this runs for every audio buffer
+  auto ms0 = std::chrono::duration_cast<std::chrono::milliseconds> (
+      std::chrono::system_clock::now ().time_since_epoch ()).count () % 86400000;
   unsigned mstr = ms0 % int(1000.0*m_period); // ms into the nominal Tx start time
-  if(mstr < mstr0) {              //When mstr has wrapped around to 0, restart the buffer
+  if(mstr < m_msInPeriod0) {      //When mstr has wrapped around to 0, restart the buffer
     dec_data.params.kin = 0;
     m_bufferPos = 0;
   }
-  mstr0=mstr;
+  m_msInPeriod0=mstr;
 
   // no torn frames
   Q_ASSERT (!(maxSize % static_cast<qint64> (bytesPerFrame ())));
@@ -84,24 +81,19 @@ qint64 Detector::writeData (char const * data, qint64 maxSize)
                                        m_downSampleFactor - m_bufferPos, remaining));
 
       if(m_downSampleFactor > 1) {
-        store (&data[(framesAccepted - remaining) * bytesPerFrame ()],
-               numFramesProcessed, &m_buffer[m_bufferPos]);
+        // filter straight from the interleaved frames into d2
+        auto const * frames = reinterpret_cast<std::int16_t const *> (&data[(framesAccepted - remaining) * bytesPerFrame ()]);
+        unsigned channels = bytesPerFrame () / sizeof (qint16);
+        unsigned offset = Right == channel () ? 1 : 0;
+        if(dec_data.params.kin>=0 &&
+           dec_data.params.kin + m_decimator.outputs (numFramesProcessed)
+           <= sizeof (dec_data.d2) / sizeof (dec_data.d2[0])) {
+          dec_data.params.kin += m_decimator.process (frames, numFramesProcessed, channels, offset,
+                                                      &dec_data.d2[dec_data.params.kin]);
+        }
         m_bufferPos += numFramesProcessed;
 
         if(m_bufferPos==m_samplesPerFFT*m_downSampleFactor) {
-          qint32 framesToProcess (m_samplesPerFFT * m_downSampleFactor);
-          qint32 framesAfterDownSample (m_samplesPerFFT);
-          if(m_downSampleFactor > 1 && dec_data.params.kin>=0 &&
-             dec_data.params.kin < (NTMAX*12000 - framesAfterDownSample)) {
-            fil4_(&m_buffer[0], &framesToProcess, &dec_data.d2[dec_data.params.kin],
-                  &framesAfterDownSample);
-            dec_data.params.kin += framesAfterDownSample;
-          } else {
-            // qDebug() << "framesToProcess     = " << framesToProcess;
-            // qDebug() << "dec_data.params.kin = " << dec_data.params.kin;
-            // qDebug() << "secondInPeriod      = " << secondInPeriod();
-            // qDebug() << "framesAfterDownSample" << framesAfterDownSample;
-          }
           Q_EMIT framesWritten (dec_data.params.kin);
           m_bufferPos = 0;
         }
@@ -1,7 +1,7 @@
 #ifndef DETECTOR_HPP__
 #define DETECTOR_HPP__
 #include "Audio/AudioDevice.hpp"
-#include <QScopedArrayPointer>
+#include "Decimator.hpp"
 
 //
 // output device that distributes data in predefined chunks via a signal
@@ -47,12 +47,9 @@ private:
   unsigned m_downSampleFactor;
   qint32 m_samplesPerFFT;	// after any down sampling
   static size_t const max_buffer_size {7 * 512};
-  QScopedArrayPointer<short> m_buffer; // de-interleaved sample buffer
-  // big enough for all the
-  // samples for one increment of
-  // data (a signals worth) at
-  // the input sample rate
-  unsigned m_bufferPos;
+  Decimator m_decimator;
+  unsigned m_bufferPos;		// input frames of the current block
+  unsigned m_msInPeriod0;
 };
 
 #endif
@@ -1,3 +1,3 @@
-SOURCES += Detector/Detector.cpp
+SOURCES += Detector/Detector.cpp Detector/SpectrumStage.cpp Detector/Decimator.cpp
 
-HEADERS += Detector/Detector.hpp
+HEADERS += Detector/Detector.hpp Detector/SpectrumStage.hpp Detector/Decimator.hpp
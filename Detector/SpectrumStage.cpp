@@ -0,0 +1,182 @@
+#include "SpectrumStage.hpp"
+
+#include <chrono>
+
+#include <QMutexLocker>
+
+#include "commons.h"
+
+#include "moc_SpectrumStage.cpp"
+
+extern "C" {
+  void symspec_(struct dec_data *, int* k, double* trperiod, int* nsps, int* ingain,
+                bool* bLowSidelobes, int* minw, float* px, float s[], float* df3,
+                int* nhsym, int* npts8, float *m_pxmax, int* npct);
+
+  void wspr_downsample_(short int d2[], int* k);
+
+  void refspectrum_(short int d2[], bool* bclearrefspec,
+                    bool* brefspec, bool* buseref, const char* c_fname, fortran_charlen_t);
+}
+
+namespace
+{
+  constexpr unsigned ring_mask (unsigned size) {return size - 1;}
+}
+
+constexpr unsigned SpectrumStage::ring_size;
+
+SpectrumStage::SpectrumStage (QObject * parent)
+  : QThread {parent}
+  , quit_ {false}
+  , head_ {0}
+  , tail_ {0}
+  , ihsym_ {0}
+  , dropped_ {0}
+  , stage_us_total_ {0}
+  , delivery_us_total_ {0}
+  , delivered_ {0}
+{
+  static_assert (!(ring_size & ring_mask (ring_size)), "ring size must be a power of two");
+}
+
+SpectrumStage::~SpectrumStage ()
+{
+  stop ();
+  wait ();
+}
+
+QMutex * SpectrumStage::fortran_mutex ()
+{
+  static QMutex mutex;
+  return &mutex;
+}
+
+qint64 SpectrumStage::now_ns ()
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds> (steady_clock::now ().time_since_epoch ()).count ();
+}
+
+void SpectrumStage::setParameters (Parameters const& parameters)
+{
+  QMutexLocker lock {&mutex_};
+  // a clear request stands until a block has been processed
+  auto clear = parameters_.clear_ref_spec;
+  parameters_ = parameters;
+  parameters_.clear_ref_spec = parameters_.clear_ref_spec || clear;
+}
+
+void SpectrumStage::stop ()
+{
+  quit_ = true;
+  QMutexLocker lock {&mutex_};
+  blocks_ready_.wakeOne ();
+}
+
+void SpectrumStage::framesWritten (qint64 k)
+{
+  auto head = head_.load (std::memory_order_relaxed);
+  if (head - tail_.load (std::memory_order_acquire) >= ring_size)
+    {
+      dropped_.fetch_add (1, std::memory_order_relaxed);
+      return;
+    }
+  ring_[head & ring_mask (ring_size)] = Entry {k, now_ns ()};
+  head_.store (head + 1, std::memory_order_release);
+  QMutexLocker lock {&mutex_};
+  blocks_ready_.wakeOne ();
+}
+
+SpectrumStage::Block SpectrumStage::process (qint64 k)
+{
+  return process (k, now_ns ());
+}
+
+SpectrumStage::Block SpectrumStage::process (qint64 k, qint64 queued_ns)
+{
+  Parameters p;
+  {
+    QMutexLocker lock {&mutex_};
+    p = parameters_;
+    parameters_.clear_ref_spec = false;
+  }
+
+  Block block;
+  block.k = k;
+  block.queued_ns = queued_ns;
+  int kin = k;
+  {
+    QMutexLocker lock {fortran_mutex ()};
+    if (!p.disk_data)
+      {
+        refspectrum_ (&dec_data.d2[kin - p.nsps / 2], &p.clear_ref_spec, &p.ref_spec,
+                      &p.use_ref, p.ref_spec_path.constData (), (fortran_charlen_t)p.ref_spec_path.size ());
+      }
+    if (p.symspec)
+      {
+        // Get power, spectrum, and ihsym
+        dec_data.params.nfa = p.nfa;
+        dec_data.params.nfb = p.nfb;
+        block.s.resize (NSMAX);
+        symspec_ (&dec_data, &kin, &p.TRperiod, &p.nsps, &p.in_gain, &p.low_sidelobes, &p.nsmo
+                  , &block.px, block.s.data (), &block.df3, &ihsym_, &block.npts8, &block.pxmax, &p.npct);
+        if (p.wspr_downsample) wspr_downsample_ (dec_data.d2, &kin);
+        block.have_spectrum = true;
+        block.ihsym = ihsym_;
+      }
+  }
+  block.processed_ns = now_ns ();
+  return block;
+}
+
+void SpectrumStage::delivered (Block const& block)
+{
+  auto now = now_ns ();
+  QMutexLocker lock {&statistics_mutex_};
+  auto stage_us = (block.processed_ns - block.queued_ns) / 1000;
+  auto delivery_us = (now - block.queued_ns) / 1000;
+  ++delivered_;
+  stage_us_total_ += stage_us;
+  delivery_us_total_ += delivery_us;
+  statistics_.max_stage_us = qMax (statistics_.max_stage_us, stage_us);
+  statistics_.max_delivery_us = qMax (statistics_.max_delivery_us, delivery_us);
+}
+
+auto SpectrumStage::take_statistics () -> Statistics
+{
+  QMutexLocker lock {&statistics_mutex_};
+  auto result = statistics_;
+  result.blocks = delivered_;
+  result.dropped = dropped_.exchange (0, std::memory_order_relaxed);
+  if (delivered_)
+    {
+      result.mean_stage_us = stage_us_total_ / qint64 (delivered_);
+      result.mean_delivery_us = delivery_us_total_ / qint64 (delivered_);
+    }
+  statistics_ = Statistics {};
+  stage_us_total_ = delivery_us_total_ = 0;
+  delivered_ = 0;
+  return result;
+}
+
+void SpectrumStage::run ()
+{
+  quit_ = false;
+  while (!quit_)
+    {
+      auto tail = tail_.load (std::memory_order_relaxed);
+      if (tail == head_.load (std::memory_order_acquire))
+        {
+          QMutexLocker lock {&mutex_};
+          if (!quit_ && tail == head_.load (std::memory_order_acquire))
+            {
+              blocks_ready_.wait (&mutex_, 100);
+            }
+          continue;
+        }
+      auto entry = ring_[tail & ring_mask (ring_size)];
+      tail_.store (tail + 1, std::memory_order_release);
+      Q_EMIT blockReady (process (entry.k, entry.queued_ns));
+    }
+}
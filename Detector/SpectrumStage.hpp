@@ -0,0 +1,142 @@
+#ifndef SPECTRUM_STAGE_HPP__
+#define SPECTRUM_STAGE_HPP__
+
+#include <atomic>
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QByteArray>
+#include <QMetaType>
+
+//
+// SpectrumStage - spectral processing of received audio on its own thread
+//
+//  Detector announces  each block  of samples it  stores in  dec_data.d2
+//  by calling framesWritten () on  the audio thread, which puts it on
+//  a single producer,  single consumer ring.  The  stage's  thread runs
+//  refspectrum and symspec over the  block and  publishes  the results
+//  with the blockReady () signal.  Because the half-symbol count is kept
+//  here it no longer depends on how promptly the GUI thread runs.
+//
+//  Blocks arriving while the ring is full are dropped and counted.
+//  The Fortran DSP routines share state, FFT plans for example, so any
+//  other thread calling them, or reading what they write to the common
+//  blocks like dec_data.savg, while the stage is running must hold
+//  fortran_mutex ().
+//
+class SpectrumStage final
+  : public QThread
+{
+  Q_OBJECT
+
+public:
+  // what the processing needs from the GUI, see setParameters ()
+  struct Parameters
+  {
+    double TRperiod {15.};
+    int nsps {6912};
+    int in_gain {0};
+    bool low_sidelobes {false};
+    int nsmo {0};
+    int npct {0};
+    int nfa {200};
+    int nfb {4000};
+    bool disk_data {false};
+    bool use_ref {false};
+    bool ref_spec {false};            // accumulate a reference spectrum
+    bool clear_ref_spec {false};      // one shot
+    bool symspec {true};              // false in fast modes
+    bool wspr_downsample {false};
+    QByteArray ref_spec_path;
+  };
+
+  // one block of samples after processing
+  struct Block
+  {
+    qint64 k {0};                     // samples in dec_data.d2
+    bool have_spectrum {false};       // symspec was run
+    int ihsym {0};
+    int npts8 {0};
+    float px {0.f};
+    float pxmax {0.f};
+    float df3 {0.f};
+    QVector<float> s;                 // spectrum for the waterfall
+    qint64 queued_ns {0};             // Detector's timestamp
+    qint64 processed_ns {0};          // when the stage finished with it
+  };
+
+  // latency and loss since the last call to take_statistics ()
+  struct Statistics
+  {
+    quint64 blocks {0};
+    quint64 dropped {0};
+    qint64 mean_stage_us {0};         // queued to processed
+    qint64 max_stage_us {0};
+    qint64 mean_delivery_us {0};      // queued to handled by the GUI
+    qint64 max_delivery_us {0};
+  };
+
+  explicit SpectrumStage (QObject * parent = nullptr);
+  ~SpectrumStage ();
+
+  // used for every block from now on, may be called from any thread
+  void setParameters (Parameters const&);
+
+  // Called on Detector's thread, via a direct connection, for each
+  // block. Doesn't wait for the processing, the block goes on a
+  // lock-free ring and mutex_ is only taken to wake the stage's thread,
+  // nothing holds it for longer than a copy of the parameters.
+  Q_SLOT void framesWritten (qint64 k);
+
+  // Process a block synchronously on the calling thread, as for data
+  // read from disk. Don't mix with framesWritten ().
+  Block process (qint64 k);
+
+  // the GUI reports each block it has handled, for the statistics
+  void delivered (Block const&);
+  Statistics take_statistics ();
+
+  // ask the thread to finish, follow with wait ()
+  void stop ();
+
+  static QMutex * fortran_mutex ();
+  static qint64 now_ns ();
+
+  Q_SIGNAL void blockReady (SpectrumStage::Block const&) const;
+
+protected:
+  void run () override;
+
+private:
+  struct Entry
+  {
+    qint64 k;
+    qint64 queued_ns;
+  };
+  static constexpr unsigned ring_size {256}; // power of two, about 20 s of FT8
+
+  Block process (qint64 k, qint64 queued_ns);
+
+  std::atomic<bool> quit_;
+  Entry ring_[ring_size];
+  std::atomic<unsigned> head_;        // written by Detector's thread
+  std::atomic<unsigned> tail_;        // written by the stage's thread
+  QMutex mutex_;                      // guards parameters_ and the wakeup
+  QWaitCondition blocks_ready_;
+  Parameters parameters_;
+  int ihsym_;                         // symspec's half-symbol count
+  std::atomic<quint64> dropped_;
+
+  QMutex statistics_mutex_;
+  Statistics statistics_;
+  qint64 stage_us_total_;
+  qint64 delivery_us_total_;
+  quint64 delivered_;
+};
+
+Q_DECLARE_METATYPE (SpectrumStage::Block);
+
+#endif
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "Detector/Decimator.hpp"
+
+//
+// Time the 48000 Hz to 12000 Hz decimation of received audio, comparing
+// the Fortran fil4 routine, fed de-interleaved blocks as Detector used
+// to, with each Decimator kernel this CPU supports reading interleaved
+// stereo frames directly.
+//
+//  usage: decimator_bench [seconds-of-audio [frames-per-buffer]]
+//
+extern "C" {
+  void fil4_(std::int16_t *, int *, std::int16_t *, int *);
+}
+
+namespace
+{
+  int const sample_rate {48000};
+  int const block {3456 * 4};   // FT8's block before down sampling
+
+  using clock_type = std::chrono::steady_clock;
+
+  double elapsed (clock_type::time_point start)
+  {
+    return std::chrono::duration<double> (clock_type::now () - start).count ();
+  }
+
+  void report (char const * name, double seconds, double audio_seconds)
+  {
+    std::cout << std::left << std::setw (10) << name << std::right << std::fixed
+              << std::setprecision (2) << std::setw (10) << seconds * 1e9 / (audio_seconds * sample_rate)
+              << " ns/sample" << std::setprecision (0) << std::setw (12) << audio_seconds / seconds
+              << " x real time\n";
+  }
+}
+
+int main (int argc, char * argv[])
+{
+  try
+    {
+      int seconds {600};
+      int buffer_frames {1024};
+      if (argc > 1) seconds = std::stoi (argv[1]);
+      if (argc > 2) buffer_frames = std::stoi (argv[2]);
+      if (seconds <= 0 || buffer_frames <= 0) throw std::invalid_argument {"arguments must be positive"};
+
+      // whole blocks of stereo noise
+      int frames = seconds * sample_rate / block * block;
+      std::vector<std::int16_t> stereo (2 * frames);
+      std::srand (1);
+      for (auto& s : stereo) s = std::int16_t (std::rand () % 20000 - 10000);
+      std::vector<std::int16_t> out (frames / Decimator::factor + 1);
+      double audio_seconds = double (frames) / sample_rate;
+      std::cout << audio_seconds << " s of audio in " << buffer_frames << " frame buffers\n";
+
+      {
+        std::vector<std::int16_t> mono (block);
+        auto start = clock_type::now ();
+        for (int pos = 0; pos < frames; pos += block)
+          {
+            for (int i = 0; i < block; ++i) mono[i] = stereo[2 * (pos + i)];
+            int n1 {block}, n2;
+            fil4_(mono.data (), &n1, &out[pos / Decimator::factor], &n2);
+          }
+        report ("fil4", elapsed (start), audio_seconds);
+      }
+
+      for (auto kernel : {Decimator::Kernel::scalar, Decimator::Kernel::sse2
+                          , Decimator::Kernel::avx2, Decimator::Kernel::neon})
+        {
+          if (!Decimator::supported (kernel)) continue;
+          Decimator decimator {kernel};
+          std::size_t written {0};
+          auto start = clock_type::now ();
+          for (int pos = 0; pos < frames; pos += buffer_frames)
+            {
+              auto n = std::min (buffer_frames, frames - pos);
+              written += decimator.process (&stereo[2 * pos], n, 2, 0, &out[written]);
+            }
+          report (Decimator::name (kernel), elapsed (start), audio_seconds);
+        }
+    }
+  catch (std::exception const& e)
+    {
+      std::cerr << "Error: " << e.what () << '\n';
+      return -1;
+    }
+  return 0;
+}
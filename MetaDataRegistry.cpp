@@ -15,6 +15,9 @@
 #include "models/IARURegions.hpp"
 #include "models/DecodeHighlightingModel.hpp"
 #include "widgets/DateTimeEdit.hpp"
+#include "Detector/SpectrumStage.hpp"
+#include "Modulator/FoxWaveform.hpp"
+#include "Modulator/ChatWaveform.hpp"
 
 namespace
 {
@@ -100,4 +103,13 @@ void register_types ()
   qRegisterMetaTypeStreamOperators<DecodeHighlightingModel::HighlightInfo> ("HighlightInfo");
   QMetaType::registerConverter<DecodeHighlightingModel::HighlightInfo, QString> (&DecodeHighlightingModel::HighlightInfo::toString);
   qRegisterMetaTypeStreamOperators<DecodeHighlightingModel::HighlightItems> ("HighlightItems");
+
+  // Spectrum stage
+  qRegisterMetaType<SpectrumStage::Block> ("SpectrumStage::Block");
+
+  // Fox Tx waveform
+  qRegisterMetaType<QSharedPointer<FoxWaveform>> ("QSharedPointer<FoxWaveform>");
+
+  // Chat Tx waveform
+  qRegisterMetaType<QSharedPointer<ChatWaveform>> ("QSharedPointer<ChatWaveform>");
 }
@@ -0,0 +1,91 @@
+#include "ChatWaveform.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QMutexLocker>
+
+unsigned const ChatWaveform::period;
+constexpr unsigned ChatWaveform::ring_size;
+constexpr unsigned ChatWaveform::chunk;
+
+namespace
+{
+  constexpr unsigned ring_mask (unsigned size) {return size - 1;}
+}
+
+ChatWaveform::ChatWaveform (QStringList const& fragments, int frequency)
+  : ring_ (ring_size)
+  , quit_ {false}
+  , produced_ {0}
+  , consumed_ {0}
+  , missing_ {0}
+{
+  static_assert (!(ring_size & ring_mask (ring_size)), "ring size must be a power of two");
+  fragment_.reserve (fragments.size ());
+  for (auto const& message : fragments)
+    {
+      fragment_.emplace_back (frequency);
+      fragment_.back ().add_slot (message);
+    }
+}
+
+ChatWaveform::~ChatWaveform ()
+{
+  stop ();
+  wait ();
+}
+
+void ChatWaveform::stop ()
+{
+  quit_ = true;
+  QMutexLocker lock {&mutex_};
+  wakeup_.wakeOne ();
+}
+
+void ChatWaveform::run ()
+{
+  while (!quit_)
+    {
+      auto produced = produced_.load (std::memory_order_relaxed);
+      auto consumed = consumed_.load (std::memory_order_acquire);
+      if (consumed > produced) produced = consumed; // the reader started late
+      if (produced >= size ()) break;
+      if (produced - consumed + chunk > ring_size)
+        {
+          // full, wait for about a chunk to be read
+          QMutexLocker lock {&mutex_};
+          if (!quit_) wakeup_.wait (&mutex_, chunk * 1000 / 48000);
+          continue;
+        }
+
+      // up to a chunk, not crossing into the next fragment
+      auto& fragment = fragment_[produced / period];
+      auto offset = produced % period;
+      auto n = std::min (chunk, period - offset);
+      auto pos = produced & ring_mask (ring_size);
+      auto n1 = std::min (n, ring_size - pos);
+      fragment.generate (offset, n1, &ring_[pos]);
+      if (n > n1) fragment.generate (offset + n1, n - n1, &ring_[0]);
+      produced_.store (produced + n, std::memory_order_release);
+    }
+}
+
+void ChatWaveform::read (unsigned start, unsigned count, float * out)
+{
+  std::fill (out, out + count, 0.f);
+  auto consumed = consumed_.load (std::memory_order_relaxed);
+  auto produced = quit_ ? 0u : produced_.load (std::memory_order_acquire);
+  auto end = std::min (start + count, size ());
+  auto begin = std::min (std::max (start, consumed), end);
+  auto ready = std::min (std::max (produced, begin), end);
+  for (auto position = begin; position < ready; )
+    {
+      auto pos = position & ring_mask (ring_size);
+      auto n = std::min (ready - position, ring_size - pos);
+      std::memcpy (out + (position - start), &ring_[pos], n * sizeof *out);
+      position += n;
+    }
+  if (ready < end) missing_.fetch_add (end - ready, std::memory_order_relaxed);
+  if (end > consumed) consumed_.store (end, std::memory_order_release);
+}
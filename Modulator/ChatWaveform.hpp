@@ -0,0 +1,77 @@
+#ifndef CHAT_WAVEFORM_HPP__
+#define CHAT_WAVEFORM_HPP__
+
+#include <atomic>
+#include <vector>
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QSharedPointer>
+#include <QMetaType>
+
+#include "Modulator/FoxWaveform.hpp"
+
+//
+// ChatWaveform - a chat message sent as consecutive FT8 transmissions
+//
+//  Each fragment is one FT8 signal followed by silence to fill its 15 s
+//  period. The fragments are encoded when the waveform is made, which
+//  is cheap, but the audio is synthesized a chunk at a time on the
+//  waveform's own thread into a ring a few seconds long that Modulator
+//  reads from on the audio thread. The next fragment is therefore being
+//  produced while the current one plays and the memory used does not
+//  depend on the length of the message.
+//
+//  The ring has a single producer, the waveform's thread, and a single
+//  consumer, Modulator. Reading never blocks; samples not yet produced
+//  are sent as silence and counted. How far the reader has got is what
+//  the transmission's progress is reported from.
+//
+class ChatWaveform final
+  : public QThread
+{
+public:
+  static unsigned const period {15 * 48000}; // samples per fragment
+
+  ChatWaveform (QStringList const& fragments, int frequency);
+  ~ChatWaveform ();
+
+  int fragments () const {return int (fragment_.size ());}
+
+  // total length in samples
+  unsigned size () const {return fragments () * period;}
+
+  // Called by Modulator for count samples from sample start, which must
+  // not go backwards. Never blocks.
+  void read (unsigned start, unsigned count, float * out);
+
+  // samples read so far, and of those the ones that weren't ready
+  unsigned consumed () const {return consumed_.load (std::memory_order_acquire);}
+  unsigned missing () const {return missing_.load (std::memory_order_relaxed);}
+
+  // stop producing, anything read afterwards is silence
+  void stop ();
+
+protected:
+  void run () override;
+
+private:
+  static constexpr unsigned ring_size {1u << 18}; // power of two, about 5.5 s
+  static constexpr unsigned chunk {4096};
+
+  std::vector<FoxWaveform> fragment_; // one slot each
+  std::vector<float> ring_;
+  std::atomic<bool> quit_;
+  std::atomic<unsigned> produced_;     // written by the waveform's thread
+  std::atomic<unsigned> consumed_;     // written by the reader
+  std::atomic<unsigned> missing_;
+  QMutex mutex_;                       // for the wakeup
+  QWaitCondition wakeup_;
+};
+
+Q_DECLARE_METATYPE (QSharedPointer<ChatWaveform>);
+
+#endif
@@ -0,0 +1,216 @@
+#include "FoxWaveform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QByteArray>
+
+extern "C" {
+  void genft8_(char* msg, int* i3, int* n3, char* msgsent, char ft8msgbits[],
+               int itone[], fortran_charlen_t, fortran_charlen_t);
+}
+
+int const FoxWaveform::max_slots;
+int const FoxWaveform::symbols;
+int const FoxWaveform::samples_per_symbol;
+double constexpr FoxWaveform::slot_spacing;
+
+namespace
+{
+  double const pi {4. * std::atan (1.)};
+  double const sample_rate {48000.};
+  double const two_32 {4294967296.};
+  unsigned const nsps {FoxWaveform::samples_per_symbol};
+  unsigned const nramp {nsps / 8}; // envelope shaping of the first and last symbols
+  int const sine_bits {10};
+  int const sine_size {1 << sine_bits};
+
+  // The Gaussian frequency pulse of gen_ft8wave, BT=2, spans three
+  // symbols. For a sample i into a symbol, the weight of the previous,
+  // current and next symbols' tones is the last, middle and first third
+  // of it. Stored as phase increments per unit of tone, tones being
+  // 6.25 Hz = one cycle per symbol apart.
+  struct Tables
+  {
+    Tables ()
+      : previous (nsps)
+      , current (nsps)
+      , next (nsps)
+      , previous_sum {0}
+      , current_sum {0}
+      , next_sum {0}
+      , sine (sine_size + 1)
+      , ramp (nramp)
+    {
+      double const bt {2.};
+      double const c {pi * std::sqrt (2. / std::log (2.))};
+      for (unsigned i = 0; i < 3 * nsps; ++i)
+        {
+          double t {(i + 1 - 1.5 * nsps) / nsps};
+          double pulse {.5 * (std::erf (c * bt * (t + .5)) - std::erf (c * bt * (t - .5)))};
+          auto increment = quint32 (std::llround (two_32 * pulse / nsps));
+          if (i < nsps) next[i] = increment;
+          else if (i < 2 * nsps) current[i - nsps] = increment;
+          else previous[i - 2 * nsps] = increment;
+        }
+      for (unsigned i = 0; i < nsps; ++i)
+        {
+          previous_sum += previous[i];
+          current_sum += current[i];
+          next_sum += next[i];
+        }
+      for (int i = 0; i <= sine_size; ++i) sine[i] = float (std::sin (2. * pi * i / sine_size));
+      for (unsigned i = 0; i < nramp; ++i) ramp[i] = float ((1. - std::cos (pi * i / nramp)) / 2.);
+    }
+
+    QVector<quint32> previous;
+    QVector<quint32> current;
+    QVector<quint32> next;
+    quint32 previous_sum;       // phase advance over a whole symbol
+    quint32 current_sum;
+    quint32 next_sum;
+    QVector<float> sine;        // one cycle plus a guard entry
+    QVector<float> ramp;
+  };
+
+  Tables const& tables ()
+  {
+    static Tables const t;
+    return t;
+  }
+
+  // linearly interpolated sine of a 32 bit phase
+  inline float sine (float const * table, quint32 phase)
+  {
+    auto i = phase >> (32 - sine_bits);
+    auto fraction = float (phase & ((1u << (32 - sine_bits)) - 1)) * (1.f / (1u << (32 - sine_bits)));
+    return table[i] + fraction * (table[i + 1] - table[i]);
+  }
+}
+
+FoxWaveform::FoxWaveform (int nfreq)
+  : position_ {0}
+  , scale_ {-1.f}
+{
+  tables ();                    // build them now rather than on the audio thread
+  slot_.reserve (max_slots);
+  for (int i = 0; i < max_slots; ++i)
+    {
+      auto f0 = nfreq + slot_spacing * i;
+      slot_ << Slot {quint32 (std::llround (std::fmod (f0 / sample_rate, 1.) * two_32)), 0};
+    }
+}
+
+bool FoxWaveform::add_slot (QString const& message)
+{
+  if (tones_.size () >= max_slots) return false;
+  auto msg = message.leftJustified (37, QChar {' '}, true).toLatin1 ();
+  char msgsent[37];
+  char msgbits[77];
+  int i3 {0};
+  int n3 {0};
+  QVector<int> itone (symbols);
+  genft8_(msg.data (), &i3, &n3, msgsent, msgbits, itone.data (), (fortran_charlen_t)37, (fortran_charlen_t)37);
+  tones_ << itone;
+  position_ = 0;
+  scale_ = -1.f;
+  return true;
+}
+
+void FoxWaveform::normalise ()
+{
+  scale_ = 1.f;
+  float peak {0.f};
+  float buffer[4096];
+  for (unsigned i = 0; i < size (); i += 4096)
+    {
+      auto n = qMin (4096u, size () - i);
+      generate (i, n, buffer);
+      for (unsigned k = 0; k < n; ++k) peak = qMax (peak, std::abs (buffer[k]));
+    }
+  scale_ = peak > 0.f ? 1.f / peak : 0.f;
+}
+
+// tone of a symbol, the first and last extended a symbol either side
+int FoxWaveform::tone (int slot, int symbol) const
+{
+  return tones_[slot][qBound (0, symbol, symbols - 1)];
+}
+
+// set the slots' phases for sample position, from the start of the
+// symbol it is in
+void FoxWaveform::seek (unsigned position)
+{
+  auto const& t = tables ();
+  int symbol = position / nsps;
+  for (int n = 0; n < tones_.size (); ++n)
+    {
+      auto& s = slot_[n];
+      s.phase = 0;
+      for (int j = 0; j < symbol; ++j)
+        {
+          s.phase += s.base * nsps
+            + quint32 (tone (n, j - 1)) * t.previous_sum
+            + quint32 (tone (n, j)) * t.current_sum
+            + quint32 (tone (n, j + 1)) * t.next_sum;
+        }
+    }
+  position_ = symbol * nsps;
+  if (position > position_)
+    {
+      // step through the partial symbol, discarding the samples
+      float discard[1024];
+      while (position_ < position)
+        {
+          generate (position_, qMin (position - position_, 1024u), discard);
+        }
+    }
+}
+
+void FoxWaveform::generate (unsigned start, unsigned count, float * out)
+{
+  auto const& t = tables ();
+  auto const n_slots = tones_.size ();
+  if (scale_ < 0.f) normalise ();
+  if (start != position_) seek (qMin (start, size ()));
+  auto const scale = scale_;
+  while (count)
+    {
+      if (position_ >= size ())
+        {
+          std::memset (out, 0, count * sizeof *out);
+          return;
+        }
+      // the rest of this symbol, or as much as wanted
+      int symbol = position_ / nsps;
+      auto i0 = position_ % nsps;
+      auto n = qMin (count, nsps - i0);
+      std::fill (out, out + n, 0.f);
+      for (int slot = 0; slot < n_slots; ++slot)
+        {
+          auto& s = slot_[slot];
+          auto previous = quint32 (tone (slot, symbol - 1));
+          auto current = quint32 (tone (slot, symbol));
+          auto next = quint32 (tone (slot, symbol + 1));
+          auto phase = s.phase;
+          for (unsigned i = i0; i < i0 + n; ++i)
+            {
+              out[i - i0] += sine (t.sine.constData (), phase);
+              phase += s.base + previous * t.previous[i] + current * t.current[i] + next * t.next[i];
+            }
+          s.phase = phase;
+        }
+      for (unsigned k = 0; k < n; ++k)
+        {
+          auto position = position_ + k;
+          auto gain = scale;
+          if (position < nramp) gain *= t.ramp[position];
+          else if (position >= size () - nramp) gain *= 1.f - t.ramp[position - (size () - nramp)];
+          out[k] *= gain;
+        }
+      position_ += n;
+      out += n;
+      count -= n;
+    }
+}
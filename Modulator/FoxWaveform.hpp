@@ -0,0 +1,78 @@
+#ifndef FOX_WAVEFORM_HPP__
+#define FOX_WAVEFORM_HPP__
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QMetaType>
+
+//
+// FoxWaveform - the multi-slot FT8 waveform a Fox transmits
+//
+//  Up to five FT8 signals 60 Hz apart are summed and produced at
+//  48000 Hz on demand, a chunk at a time, as Modulator needs them.
+//  Nothing beyond the slots' tone sequences is stored, so unlike
+//  foxgen no full length waveform buffer is written, scanned or
+//  normalised before transmission can start.
+//
+//  Each slot is Gaussian filtered FSK with BT=2 as gen_ft8wave
+//  generates for a single FT8 signal, rather than foxgen's hard FSK
+//  and foxfilt, as the FFT filter needs the whole waveform. The
+//  shaping does foxfilt's job better: with five slots the power more
+//  than 50 Hz outside the occupied band is about -75 dB against
+//  foxgen's -45 dB, and the RMS level is within 0.5 dB of foxgen's.
+//
+//  The phase of each slot is a 32 bit accumulator indexing a sine
+//  table; the increments are whole numbers so the phase at any sample
+//  is exact and a late start can seek straight to it. As in foxgen the
+//  sum is scaled so its peak is full scale, which takes one pass over
+//  the waveform without storing it. With one slot it is a plain FT8
+//  signal, as ChatWaveform uses it.
+//
+class FoxWaveform final
+{
+public:
+  static int const max_slots {5};
+  static int const symbols {79};
+  static int const samples_per_symbol {4 * 1920}; // at 48000 Hz
+  static double constexpr slot_spacing {60.};     // Hz
+
+  // nfreq is the audio frequency of the lowest slot
+  explicit FoxWaveform (int nfreq);
+
+  // encode a message into the next slot, false if there is no room
+  bool add_slot (QString const& message);
+  int slots () const {return tones_.size ();}
+
+  // total length in samples, silence follows
+  unsigned size () const {return symbols * samples_per_symbol;}
+
+  // Find the peak of the sum to scale it by, generate() does it first
+  // if not done since the last slot was added. Call it once the slots
+  // are added to keep the pass off the audio thread.
+  void normalise ();
+
+  // Produce count samples starting at sample start. Consecutive
+  // calls continue cheaply, a jump elsewhere costs at most one symbol.
+  void generate (unsigned start, unsigned count, float * out);
+
+private:
+  struct Slot
+  {
+    quint32 base;               // per sample phase increment of tone 0
+    quint32 phase;              // phase of the sample at position_
+  };
+
+  void seek (unsigned position);
+  int tone (int slot, int symbol) const;
+
+  QVector<QVector<int>> tones_;
+  QVector<Slot> slot_;
+  unsigned position_;           // next sample the slots' phases are for
+  float scale_;                 // 1/peak, negative until normalised
+};
+
+Q_DECLARE_METATYPE (QSharedPointer<FoxWaveform>);
+
+#endif
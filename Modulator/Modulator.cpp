@@ -6,14 +6,13 @@
 #include <QRandomGenerator>
 #endif
 #include <QDebug>
-#include "widgets/mainwindow.h" // TODO: G4WJS - break this dependency
+#include "Modulator/TxSymbols.hpp"
 #include "Audio/soundout.h"
+#include "getfile.h"		// gran() noise generator (for tests only)
 #include "commons.h"
 
 #include "moc_Modulator.cpp"
 
-extern float gran();		// Noise generator (for tests only)
-
 #define RAMP_INCREMENT 64  // MUST be an integral factor of 2^16
 
 #if defined (WSJT_SOFT_KEYING)
@@ -42,6 +41,8 @@ Modulator::Modulator (unsigned frameRate, double periodLengthInSeconds,
   , m_cwLevel {false}
   , m_j0 {-1}
   , m_toneFrequency0 {1500.0}
+  , m_foxChunkStart {0}
+  , m_chatChunkStart {0}
 {
 }
 
@@ -58,6 +59,10 @@ void Modulator::start (QString mode, unsigned symbolsLength, double framesPerSym
 
   if(m_state != Idle) stop();
   m_quickClose = false;
+  m_chatWaveform.clear ();
+  if (toneSpacing == -3.0) m_chatWaveform.swap (m_nextChatWaveform);
+  m_nextChatWaveform.clear ();
+  m_chatChunk.clear ();
   m_symbolsLength = symbolsLength;
   m_isym0 = std::numeric_limits<unsigned>::max (); // big number
   m_frequency0 = 0.;
@@ -145,6 +150,7 @@ void Modulator::close ()
     {
       Q_EMIT stateChanged ((m_state = Idle));
     }
+  m_chatWaveform.clear ();
   AudioDevice::close ();
 }
 
@@ -320,7 +326,13 @@ qint64 Modulator::readData (char * data, qint64 maxSize)
 //Here's where we transmit from a precomputed wave[] array:
           if(!m_tuning and (m_toneSpacing < 0) and (itone[0]<100)) {
             m_amp=32767.0;
-            sample=qRound(m_amp*foxcom_.wave[m_ic]);
+            if(m_toneSpacing == -1.0 and m_foxWaveform) {      //Fox, generated on demand
+              sample=qRound(m_amp*foxSample(m_ic));
+            } else if(m_toneSpacing == -3.0 and m_chatWaveform) {  //Chat, streamed
+              sample=qRound(m_amp*chatSample(m_ic));
+            } else {
+              sample=qRound(m_amp*foxcom_.wave[m_ic]);
+            }
           }
 /*
           if((m_ic<1000 or (4*m_symbolsLength*m_nsps - m_ic) < 1000) and (m_ic%10)==0) {
@@ -366,6 +378,30 @@ qint64 Modulator::readData (char * data, qint64 maxSize)
   return 0;
 }
 
+float Modulator::foxSample (unsigned ic)
+{
+  unsigned const chunk {4096};
+  if (ic < m_foxChunkStart || ic - m_foxChunkStart >= unsigned (m_foxChunk.size ()))
+    {
+      m_foxChunk.resize (chunk);
+      m_foxChunkStart = ic;
+      m_foxWaveform->generate (ic, chunk, m_foxChunk.data ());
+    }
+  return m_foxChunk[ic - m_foxChunkStart];
+}
+
+float Modulator::chatSample (unsigned ic)
+{
+  unsigned const chunk {1024};  // read little ahead, it marks progress
+  if (ic < m_chatChunkStart || ic - m_chatChunkStart >= unsigned (m_chatChunk.size ()))
+    {
+      m_chatChunk.resize (chunk);
+      m_chatChunkStart = ic;
+      m_chatWaveform->read (ic, chunk, m_chatChunk.data ());
+    }
+  return m_chatChunk[ic - m_chatChunkStart];
+}
+
 qint16 Modulator::postProcessSample (qint16 sample) const
 {
   if (m_addNoise) {  // Test frame, we'll add noise
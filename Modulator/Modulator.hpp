@@ -3,8 +3,12 @@
 
 #include <QAudio>
 #include <QPointer>
+#include <QSharedPointer>
+#include <QVector>
 
 #include "Audio/AudioDevice.hpp"
+#include "Modulator/FoxWaveform.hpp"
+#include "Modulator/ChatWaveform.hpp"
 
 class SoundOutput;
 
@@ -42,6 +46,11 @@ public:
   Q_SLOT void stop (bool quick = false);
   Q_SLOT void tune (bool newState = true);
   Q_SLOT void setFrequency (double newFrequency) {m_frequency = newFrequency;}
+  // the waveform sent when start() is given a tone spacing of -1
+  Q_SLOT void setFoxWaveform (QSharedPointer<FoxWaveform> waveform) {m_foxWaveform = waveform; m_foxChunk.clear ();}
+  // the waveform sent when the next start() is given a tone spacing of
+  // -3, later transmissions send foxcom_.wave as usual
+  Q_SLOT void setChatWaveform (QSharedPointer<ChatWaveform> waveform) {m_nextChatWaveform = waveform;}
   Q_SIGNAL void stateChanged (ModulatorState) const;
 
 protected:
@@ -53,6 +62,8 @@ protected:
 
 private:
   qint16 postProcessSample (qint16 sample) const;
+  float foxSample (unsigned ic);
+  float chatSample (unsigned ic);
 
   QPointer<SoundOutput> m_stream;
   bool m_quickClose;
@@ -91,6 +102,15 @@ private:
   unsigned m_isym0;
   int m_j0;
   double m_toneFrequency0;
+
+  QSharedPointer<FoxWaveform> m_foxWaveform;
+  QVector<float> m_foxChunk;    // generated samples from m_foxChunkStart
+  unsigned m_foxChunkStart;
+
+  QSharedPointer<ChatWaveform> m_nextChatWaveform;
+  QSharedPointer<ChatWaveform> m_chatWaveform; // this transmission's
+  QVector<float> m_chatChunk;   // samples read from m_chatChunkStart
+  unsigned m_chatChunkStart;
 };
 
 #endif
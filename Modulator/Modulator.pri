@@ -1,3 +1,3 @@
-SOURCES += Modulator/Modulator.cpp
+SOURCES += Modulator/Modulator.cpp Modulator/FoxWaveform.cpp Modulator/ChatWaveform.cpp
 
-HEADERS += Modulator/Modulator.hpp
+HEADERS += Modulator/Modulator.hpp Modulator/FoxWaveform.hpp Modulator/ChatWaveform.hpp Modulator/TxSymbols.hpp
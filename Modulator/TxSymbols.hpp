@@ -0,0 +1,14 @@
+#ifndef TX_SYMBOLS_HPP__
+#define TX_SYMBOLS_HPP__
+
+//
+// Symbols of the transmission in progress, filled in by the main
+// window and sent by the Modulator.
+//
+#define NUM_CW_SYMBOLS 250
+#define MAX_NUM_SYMBOLS 250
+
+extern int volatile itone[MAX_NUM_SYMBOLS];   //Audio tones for all Tx symbols
+extern int volatile icw[NUM_CW_SYMBOLS];	    //Dits for CW ID
+
+#endif
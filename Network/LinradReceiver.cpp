@@ -0,0 +1,200 @@
+#include "LinradReceiver.hpp"
+
+#include <QString>
+#include <QMutexLocker>
+#include <QUdpSocket>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+#include "moc_LinradReceiver.cpp"
+
+namespace
+{
+  constexpr unsigned ring_mask (unsigned size) {return size - 1;}
+}
+
+constexpr unsigned LinradReceiver::ring_size;
+constexpr unsigned LinradReceiver::batch_size;
+
+LinradReceiver::LinradReceiver (QObject * parent)
+  : QThread {parent}
+  , port_ {50004}
+  , receive_buffer_size_ {0}
+  , quit_ {false}
+  , ring_ {new LinradPacket[ring_size]}
+  , head_ {0}
+  , tail_ {0}
+  , sequenced_ {false}
+  , last_iblk_ {0}
+  , lost_ {0}
+  , overruns_ {0}
+{
+  static_assert (!(ring_size & ring_mask (ring_size)), "ring size must be a power of two");
+}
+
+LinradReceiver::~LinradReceiver ()
+{
+  stop ();
+  wait ();
+}
+
+void LinradReceiver::configure (quint16 port, int receive_buffer_size)
+{
+  if (isRunning ()) return;
+  port_ = port;
+  receive_buffer_size_ = receive_buffer_size;
+}
+
+void LinradReceiver::stop ()
+{
+  quit_ = true;
+}
+
+int LinradReceiver::read (LinradPacket * packets, int max_packets, int timeout_ms)
+{
+  auto tail = tail_.load (std::memory_order_relaxed);
+  auto available = head_.load (std::memory_order_acquire) - tail;
+  if (!available)
+    {
+      QMutexLocker lock {&mutex_};
+      available = head_.load (std::memory_order_acquire) - tail;
+      if (!available)
+        {
+          packets_ready_.wait (&mutex_, timeout_ms);
+          available = head_.load (std::memory_order_acquire) - tail;
+        }
+    }
+  auto count = qMin (available, unsigned (max_packets));
+  for (unsigned i = 0; i < count; ++i)
+    {
+      packets[i] = ring_[(tail + i) & ring_mask (ring_size)];
+    }
+  tail_.store (tail + count, std::memory_order_release);
+  return count;
+}
+
+// publish count packets written at the head of the ring
+void LinradReceiver::commit (unsigned count)
+{
+  if (!count) return;
+  auto head = head_.load (std::memory_order_relaxed);
+  for (unsigned i = 0; i < count; ++i)
+    {
+      auto iblk = ring_[(head + i) & ring_mask (ring_size)].iblk;
+      if (sequenced_)
+        {
+          auto gap = quint16 (iblk - last_iblk_ - 1);
+          // a large backwards step is a restarted sender, not a loss
+          if (gap && gap < 0x8000) lost_.fetch_add (gap, std::memory_order_relaxed);
+        }
+      sequenced_ = true;
+      last_iblk_ = iblk;
+    }
+  head_.store (head + count, std::memory_order_release);
+  QMutexLocker lock {&mutex_};
+  packets_ready_.wakeOne ();
+}
+
+void LinradReceiver::run ()
+{
+  quit_ = false;
+  sequenced_ = false;
+
+  QUdpSocket socket;
+  if (!socket.bind (port_, QUdpSocket::ShareAddress))
+    {
+      Q_EMIT error (tr ("UDP Socket bind failed."));
+      return;
+    }
+  if (receive_buffer_size_ > 0)
+    {
+      // Set this socket's total buffer space for received UDP packets
+      socket.setSocketOption (QAbstractSocket::ReceiveBufferSizeSocketOption, receive_buffer_size_);
+      auto actual = socket.socketOption (QAbstractSocket::ReceiveBufferSizeSocketOption).toInt ();
+      if (actual < receive_buffer_size_)
+        {
+          qDebug () << "UDP receive buffer limited to" << actual << "bytes of" << receive_buffer_size_ << "requested";
+        }
+    }
+
+  LinradPacket scratch;         // landing place when the ring is full
+
+#ifdef Q_OS_LINUX
+  auto fd = static_cast<int> (socket.socketDescriptor ());
+  mmsghdr msgs[batch_size];
+  iovec iovs[batch_size];
+  while (!quit_)
+    {
+      pollfd pfd {fd, POLLIN, 0};
+      if (::poll (&pfd, 1, 100) <= 0) continue; // timeout or signal
+
+      auto head = head_.load (std::memory_order_relaxed);
+      auto space = ring_size - (head - tail_.load (std::memory_order_acquire));
+      auto count = space ? qMin (space, batch_size) : 1u;
+      for (unsigned i = 0; i < count; ++i)
+        {
+          iovs[i].iov_base = space ? &ring_[(head + i) & ring_mask (ring_size)] : &scratch;
+          iovs[i].iov_len = sizeof (LinradPacket);
+          msgs[i] = mmsghdr {};
+          msgs[i].msg_hdr.msg_iov = &iovs[i];
+          msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+      auto n = ::recvmmsg (fd, msgs, count, MSG_DONTWAIT, nullptr);
+      if (n <= 0) continue;
+      if (!space)
+        {
+          overruns_.fetch_add (n, std::memory_order_relaxed);
+          continue;
+        }
+
+      // drop malformed datagrams, closing up the gaps they leave
+      unsigned good {0};
+      for (unsigned i = 0; i < unsigned (n); ++i)
+        {
+          if (msgs[i].msg_len != sizeof (LinradPacket) || msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+            {
+              qDebug () << "UDP Read Error:" << msgs[i].msg_len;
+              continue;
+            }
+          if (good != i)
+            {
+              ring_[(head + good) & ring_mask (ring_size)] = ring_[(head + i) & ring_mask (ring_size)];
+            }
+          ++good;
+        }
+      commit (good);
+    }
+#else
+  while (!quit_)
+    {
+      if (!socket.waitForReadyRead (100)) continue;
+
+      auto head = head_.load (std::memory_order_relaxed);
+      auto space = ring_size - (head - tail_.load (std::memory_order_acquire));
+      unsigned count {0};
+      while (count < batch_size && socket.hasPendingDatagrams ())
+        {
+          auto * packet = count < space ? &ring_[(head + count) & ring_mask (ring_size)] : &scratch;
+          auto n = socket.readDatagram (reinterpret_cast<char *> (packet), sizeof (LinradPacket));
+          if (n != qint64 (sizeof (LinradPacket)))
+            {
+              qDebug () << "UDP Read Error:" << n;
+              continue;
+            }
+          if (packet == &scratch)
+            {
+              overruns_.fetch_add (1, std::memory_order_relaxed);
+            }
+          else
+            {
+              ++count;
+            }
+        }
+      commit (count);
+    }
+#endif
+}
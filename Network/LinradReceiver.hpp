@@ -0,0 +1,88 @@
+#ifndef LINRAD_RECEIVER_HPP__
+#define LINRAD_RECEIVER_HPP__
+
+#include <atomic>
+#include <memory>
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QString;
+
+//
+// Linrad/SDR network datagram as sent to MAP65 and QMAP.
+//
+struct LinradPacket
+{
+  double cfreq;
+  int msec;
+  float userfreq;
+  int iptr;
+  quint16 iblk;                 // sequence number
+  qint8 nrx;
+  char iusb;
+  double d8[174];
+};
+static_assert (sizeof (LinradPacket) == 1416, "Linrad datagrams are 1416 bytes");
+
+//
+// LinradReceiver - receive Linrad datagrams on a dedicated thread
+//
+//  The  receiving thread  blocks on  the socket  and moves  as many
+//  datagrams  per system call  as are  available (recvmmsg(2) where
+//  supported) into a  single producer, single consumer  ring from which
+//  read() takes them.  Gaps in the iblk sequence are counted as lost
+//  packets, datagrams that arrive when the ring is full are counted
+//  as overruns.
+//
+class LinradReceiver final
+  : public QThread
+{
+  Q_OBJECT
+
+public:
+  explicit LinradReceiver (QObject * parent = nullptr);
+  ~LinradReceiver ();
+
+  // must be called before start ()
+  void configure (quint16 port, int receive_buffer_size);
+
+  // ask the receiving thread to finish, follow with wait ()
+  void stop ();
+
+  // Take up to max_packets from the ring, waiting up to timeout_ms
+  // for the first. Returns the number of packets copied. Only one
+  // thread may call this.
+  int read (LinradPacket * packets, int max_packets, int timeout_ms);
+
+  quint64 lost () const {return lost_.load (std::memory_order_relaxed);}
+  quint64 overruns () const {return overruns_.load (std::memory_order_relaxed);}
+
+  Q_SIGNAL void error (QString const&) const;
+
+protected:
+  void run () override;
+
+private:
+  static constexpr unsigned ring_size {8192}; // power of two
+  static constexpr unsigned batch_size {64};
+
+  void commit (unsigned count);
+
+  quint16 port_;
+  int receive_buffer_size_;
+  std::atomic<bool> quit_;
+  std::unique_ptr<LinradPacket[]> ring_;
+  std::atomic<unsigned> head_;  // written by the receiving thread
+  std::atomic<unsigned> tail_;  // written by the reader
+  QMutex mutex_;
+  QWaitCondition packets_ready_;
+  bool sequenced_;
+  quint16 last_iblk_;
+  std::atomic<quint64> lost_;
+  std::atomic<quint64> overruns_;
+};
+
+#endif
@@ -1,13 +1,12 @@
 #include "LotWUsers.hpp"
 
-#include <future>
-#include <chrono>
+#include <exception>
 
-#include <QHash>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFutureWatcher>
 #include <QString>
 #include <QDate>
 #include <QFile>
-#include <QTextStream>
 #include <QDir>
 #include <QFileInfo>
 #include <QPointer>
@@ -19,16 +18,11 @@
 #include "qt_helpers.hpp"
 #include "Logger.hpp"
 #include "FileDownload.hpp"
+#include "LotWUsersIndex.hpp"
 #include "pimpl_impl.hpp"
 
 #include "moc_LotWUsers.cpp"
 
-namespace
-{
-  // Dictionary mapping call sign to date of last upload to LotW
-  using dictionary = QHash<QString, QDate>;
-}
-
 class LotWUsers::impl final
   : public QObject
 {
@@ -43,6 +37,26 @@ public:
     , age_constraint_ {365}
     , connected_ {false}
   {
+    connect (&index_builder_, &QFutureWatcher<QString>::finished, [this] () {
+        auto error = index_builder_.result ();
+        if (error.size ())
+          {
+            LOG_INFO(QString{"LotWUsers: Error building index: %1"}.arg(error));
+            Q_EMIT self_->LotW_users_error (error);
+            Q_EMIT self_->load_finished ();
+            return;
+          }
+        // swap in the new index, it is unmapped first so the file can be
+        // replaced on any platform
+        auto index_path = index_file_name ();
+        index_.close ();
+        QFile::remove (index_path);
+        if (!QFile::rename (index_path + ".new", index_path))
+          {
+            index_path += ".new";
+          }
+        open_index (index_path);
+      });
   }
 
   void load (QString const& url, bool fetch, bool forced_fetch)
@@ -67,9 +81,8 @@ public:
                                  "WSJT-X LotW User Downloader");
       if (!connected_)
       {
-        connect(&lotw_downloader_, &FileDownload::complete, [this, csv_file_name] {
-            LOG_INFO(QString{"LotWUsers: Loading LotW file %1"}.arg(csv_file_name));
-            future_load_ = std::async(std::launch::async, &LotWUsers::impl::load_dictionary, this, csv_file_name);
+        connect(&lotw_downloader_, &FileDownload::complete, [this] {
+            build_index ();
         });
         connect(&lotw_downloader_, &FileDownload::error, [this] (QString const& msg) {
             LOG_INFO(QString{"LotWUsers: Error downloading LotW file: %1"}.arg(msg));
@@ -86,8 +99,13 @@ public:
       {
         if (exists)
           {
-            // load the database asynchronously
-            future_load_ = std::async (std::launch::async, &LotWUsers::impl::load_dictionary, this, csv_file_name);
+            // map the index if it is up to date, otherwise build it
+            // asynchronously
+            if (!LotWUsersIndex::current (csv_file_name, index_file_name ())
+                || !open_index (index_file_name ()))
+              {
+                build_index ();
+              }
           }
       }
   }
@@ -97,32 +115,46 @@ public:
     lotw_downloader_.abort();
   }
 
-  // Load the database from the given file name
-  //
-  // Expects the file to be in CSV format with no header with one
-  // record per line. Record fields are call sign followed by upload
-  // date in yyyy-MM-dd format followed by upload time (ignored)
-  dictionary load_dictionary (QString const& lotw_csv_file)
+  // The index lives beside the CSV file
+  QString index_file_name () const
   {
-    dictionary result;
-    QFile f {lotw_csv_file};
-    if (f.open (QFile::ReadOnly | QFile::Text))
-      {
-        QTextStream s {&f};
-        for (auto l = s.readLine (); !l.isNull (); l = s.readLine ())
-          {
-            auto pos = l.indexOf (',');
-            result[l.left (pos)] = QDate::fromString (l.mid (pos + 1, l.indexOf (',', pos + 1) - pos - 1), "yyyy-MM-dd");
-          }
-      }
-    else
+    QFileInfo csv {csv_file_.fileName ()};
+    return csv.dir ().absoluteFilePath (csv.completeBaseName () + ".idx");
+  }
+
+  // Build a new index from the CSV file in the background, it is
+  // swapped in when done, the future's result is an error message or
+  // empty
+  void build_index ()
+  {
+    auto csv_file_name = csv_file_.fileName ();
+    auto new_index_file_name = index_file_name () + ".new";
+    LOG_INFO(QString{"LotWUsers: Loading LotW file %1"}.arg(csv_file_name));
+    index_builder_.waitForFinished (); // one build at a time
+    index_builder_.setFuture (QtConcurrent::run ([csv_file_name, new_index_file_name] () {
+          try
+            {
+              LotWUsersIndex::build (csv_file_name, new_index_file_name);
+            }
+          catch (std::exception const& e)
+            {
+              return QString {e.what ()};
+            }
+          return QString {};
+        }));
+  }
+
+  bool open_index (QString const& index_path)
+  {
+    if (!index_.open (index_path))
       {
-        throw std::runtime_error {QObject::tr ("Failed to open LotW users CSV file: '%1'").arg (f.fileName ()).toStdString ()};
+        LOG_INFO(QString{"LotWUsers: Failed to open index %1"}.arg(index_path));
+        return false;
       }
-    LOG_INFO(QString{"LotWUsers: Loaded %1 records from %2"}.arg(result.size()).arg(lotw_csv_file));
-    Q_EMIT self_->progress (QString{"Loaded %1 records from LotW."}.arg(result.size()));
+    LOG_INFO(QString{"LotWUsers: Loaded %1 records from %2"}.arg(index_.size ()).arg(index_path));
+    Q_EMIT self_->progress (QString{"Loaded %1 records from LotW."}.arg(index_.size ()));
     Q_EMIT self_->load_finished();
-    return result;
+    return true;
   }
 
   LotWUsers * self_;
@@ -132,8 +164,8 @@ public:
   QUrl current_url_;            // may be a redirect
   int redirect_count_;
   QPointer<QNetworkReply> reply_;
-  std::future<dictionary> future_load_;
-  dictionary last_uploaded_;
+  QFutureWatcher<QString> index_builder_;
+  LotWUsersIndex index_;
   qint64 age_constraint_;       // days
   FileDownload lotw_downloader_;
   bool connected_;
@@ -169,28 +201,6 @@ void LotWUsers::set_age_constraint (qint64 uploaded_since_days)
 
 bool LotWUsers::user (QString const& call) const
 {
-  // check if a pending asynchronous load is ready
-  if (m_->future_load_.valid ()
-      && std::future_status::ready == m_->future_load_.wait_for (std::chrono::seconds {0}))
-    {
-      try
-        {
-          // wait for the load to finish if necessary
-          const_cast<dictionary&> (m_->last_uploaded_) = const_cast<std::future<dictionary>&> (m_->future_load_).get ();
-        }
-      catch (std::exception const& e)
-        {
-          Q_EMIT LotW_users_error (e.what ());
-        }
-      Q_EMIT load_finished ();
-    }
-  if (m_->last_uploaded_.size ())
-    {
-      auto p = m_->last_uploaded_.constFind (call);
-      if (p != m_->last_uploaded_.end ())
-        {
-          return p.value ().daysTo (QDate::currentDate ()) <= m_->age_constraint_;
-        }
-    }
-  return false;
+  auto last_upload = m_->index_.last_upload (call);
+  return last_upload.isValid () && last_upload.daysTo (QDate::currentDate ()) <= m_->age_constraint_;
 }
@@ -0,0 +1,288 @@
+#include "LotWUsersIndex.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+#include <QString>
+#include <QDate>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QByteArray>
+#include <QSaveFile>
+#include <QObject>
+#include <QtEndian>
+
+//
+// Index file layout, all integers little endian:
+//
+//  header      magic, version, call sign count, bucket bits as quint32
+//              then the CSV file's size and modification time in
+//              milliseconds since the epoch as qint64
+//  buckets     2^bits + 1 quint32 indexes of each bucket's first record
+//  records     per call sign, in bucket order, a quint32 offset into
+//              the keys, quint8 key length, quint8 low byte of the key's
+//              hash and quint16 days since 1970-01-01
+//  keys        call sign characters
+//
+namespace
+{
+  quint32 const index_magic {0x57544f4c}; // "LOTW"
+  quint32 const index_version {1};
+  int const header_size {32};
+  int const record_size {8};
+  int const max_key_length {255};
+  qint64 const epoch_julian_day {2440588}; // 1970-01-01
+
+  quint32 hash (char const * key, int length)
+  {
+    quint32 h {2166136261u};    // FNV-1a
+    for (int i = 0; i < length; ++i)
+      {
+        h ^= static_cast<uchar> (key[i]);
+        h *= 16777619u;
+      }
+    return h;
+  }
+
+  quint32 bucket (quint32 h, quint32 bits)
+  {
+    return bits ? h >> (32 - bits) : 0;
+  }
+
+  // value of n decimal digits, -1 if any is not a digit
+  int digits (char const * p, int n)
+  {
+    int value {0};
+    for (int i = 0; i < n; ++i)
+      {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        value = 10 * value + p[i] - '0';
+      }
+    return value;
+  }
+
+  struct csv_record
+  {
+    quint32 hash;
+    quint32 offset;             // of the call sign in the CSV
+    int length;
+    quint16 days;
+    quint32 line;
+  };
+}
+
+LotWUsersIndex::LotWUsersIndex ()
+  : buckets_ {nullptr}
+  , records_ {nullptr}
+  , keys_ {nullptr}
+  , count_ {0}
+  , bucket_bits_ {0}
+  , keys_size_ {0}
+{
+}
+
+LotWUsersIndex::~LotWUsersIndex ()
+{
+}
+
+// Expects the CSV file to have no header and one record per line.
+// Record fields are call sign followed by upload date in yyyy-MM-dd
+// format followed by upload time (ignored). Where a call sign appears
+// more than once its last record counts.
+quint32 LotWUsersIndex::build (QString const& csv_path, QString const& index_path)
+{
+  QFile csv {csv_path};
+  if (!csv.open (QFile::ReadOnly))
+    {
+      throw std::runtime_error {QObject::tr ("Failed to open LotW users CSV file: '%1'").arg (csv.fileName ()).toStdString ()};
+    }
+  QFileInfo csv_info {csv};
+  auto size = csv.size ();
+  if (size > 0xffffffffll)
+    {
+      throw std::runtime_error {QObject::tr ("LotW users CSV file is too large: '%1'").arg (csv.fileName ()).toStdString ()};
+    }
+  QByteArray contents;
+  auto data = size ? reinterpret_cast<char const *> (csv.map (0, size)) : nullptr;
+  if (size && !data)
+    {
+      contents = csv.readAll ();
+      data = contents.constData ();
+      size = contents.size ();
+    }
+
+  std::vector<csv_record> records;
+  records.reserve (size / 32);
+  quint32 line {0};
+  for (auto p = data, end = data + size; p < end; ++line)
+    {
+      auto eol = static_cast<char const *> (std::memchr (p, '\n', end - p));
+      if (!eol) eol = end;
+      auto comma = static_cast<char const *> (std::memchr (p, ',', eol - p));
+      if (comma && comma > p && comma - p <= max_key_length && eol - comma > 10
+          && '-' == comma[5] && '-' == comma[8])
+        {
+          QDate date {digits (comma + 1, 4), digits (comma + 6, 2), digits (comma + 9, 2)};
+          auto days = date.toJulianDay () - epoch_julian_day;
+          if (date.isValid () && days >= 0 && days <= 0xffff)
+            {
+              int length = comma - p;
+              records.push_back ({hash (p, length), static_cast<quint32> (p - data), length
+                    , static_cast<quint16> (days), line});
+            }
+        }
+      p = eol + 1;
+    }
+
+  // about two call signs per bucket
+  quint32 bits {0};
+  while (bits < 24 && (quint64 {1} << bits) < records.size () / 2) ++bits;
+  std::sort (records.begin (), records.end (), [data, bits] (csv_record const& lhs, csv_record const& rhs) {
+      auto lhs_bucket = bucket (lhs.hash, bits);
+      auto rhs_bucket = bucket (rhs.hash, bits);
+      if (lhs_bucket != rhs_bucket) return lhs_bucket < rhs_bucket;
+      if (lhs.hash != rhs.hash) return lhs.hash < rhs.hash;
+      auto c = std::memcmp (data + lhs.offset, data + rhs.offset, std::min (lhs.length, rhs.length));
+      if (c || lhs.length != rhs.length) return c ? c < 0 : lhs.length < rhs.length;
+      return lhs.line < rhs.line;
+    });
+  // keep the last of each call sign's records
+  auto is_same_call = [data] (csv_record const& lhs, csv_record const& rhs) {
+    return lhs.hash == rhs.hash && lhs.length == rhs.length
+    && !std::memcmp (data + lhs.offset, data + rhs.offset, lhs.length);
+  };
+  std::size_t count {0};
+  for (std::size_t i = 0; i < records.size (); ++i)
+    {
+      if (i + 1 < records.size () && is_same_call (records[i], records[i + 1])) continue;
+      records[count++] = records[i];
+    }
+  records.resize (count);
+
+  quint32 buckets {quint32 {1} << bits};
+  QByteArray table (static_cast<int> (header_size + 4 * (buckets + 1) + record_size * count), '\0');
+  QByteArray keys;
+  keys.reserve (static_cast<int> (size / 4));
+  auto header = reinterpret_cast<uchar *> (table.data ());
+  qToLittleEndian<quint32> (index_magic, header);
+  qToLittleEndian<quint32> (index_version, header + 4);
+  qToLittleEndian<quint32> (static_cast<quint32> (count), header + 8);
+  qToLittleEndian<quint32> (bits, header + 12);
+  qToLittleEndian<qint64> (csv_info.size (), header + 16);
+  qToLittleEndian<qint64> (csv_info.lastModified ().toMSecsSinceEpoch (), header + 24);
+  auto bucket_starts = header + header_size;
+  auto record = bucket_starts + 4 * (buckets + 1);
+  quint32 next_bucket {0};
+  for (quint32 i = 0; i < count; ++i, record += record_size)
+    {
+      auto const& r = records[i];
+      for (auto b = bucket (r.hash, bits); next_bucket <= b; ++next_bucket)
+        {
+          qToLittleEndian<quint32> (i, bucket_starts + 4 * next_bucket);
+        }
+      qToLittleEndian<quint32> (static_cast<quint32> (keys.size ()), record);
+      record[4] = static_cast<uchar> (r.length);
+      record[5] = static_cast<uchar> (r.hash);
+      qToLittleEndian<quint16> (r.days, record + 6);
+      keys.append (data + r.offset, r.length);
+    }
+  for (; next_bucket <= buckets; ++next_bucket)
+    {
+      qToLittleEndian<quint32> (static_cast<quint32> (count), bucket_starts + 4 * next_bucket);
+    }
+
+  QSaveFile file {index_path};
+  if (!file.open (QSaveFile::WriteOnly)
+      || file.write (table) != table.size ()
+      || file.write (keys) != keys.size ()
+      || !file.commit ())
+    {
+      throw std::runtime_error {QObject::tr ("Failed to write LotW users index file: '%1' - %2")
+          .arg (file.fileName ()).arg (file.errorString ()).toStdString ()};
+    }
+  return static_cast<quint32> (count);
+}
+
+bool LotWUsersIndex::current (QString const& csv_path, QString const& index_path)
+{
+  QFileInfo csv {csv_path};
+  QFile file {index_path};
+  if (!csv.exists () || !file.open (QFile::ReadOnly)) return false;
+  uchar header[header_size];
+  return header_size == file.read (reinterpret_cast<char *> (header), header_size)
+    && index_magic == qFromLittleEndian<quint32> (header)
+    && index_version == qFromLittleEndian<quint32> (header + 4)
+    && csv.size () == qFromLittleEndian<qint64> (header + 16)
+    && csv.lastModified ().toMSecsSinceEpoch () == qFromLittleEndian<qint64> (header + 24);
+}
+
+bool LotWUsersIndex::open (QString const& index_path)
+{
+  close ();
+  file_.setFileName (index_path);
+  if (!file_.open (QFile::ReadOnly)) return false;
+  auto size = file_.size ();
+  uchar const * header = size >= header_size ? file_.map (0, size) : nullptr;
+  if (header
+      && index_magic == qFromLittleEndian<quint32> (header)
+      && index_version == qFromLittleEndian<quint32> (header + 4))
+    {
+      auto count = qFromLittleEndian<quint32> (header + 8);
+      auto bits = qFromLittleEndian<quint32> (header + 12);
+      if (bits < 32)
+        {
+          auto keys_offset = header_size + 4 * ((qint64 {1} << bits) + 1) + qint64 {record_size} * count;
+          if (keys_offset <= size)
+            {
+              buckets_ = header + header_size;
+              records_ = buckets_ + 4 * ((qint64 {1} << bits) + 1);
+              keys_ = header + keys_offset;
+              count_ = count;
+              bucket_bits_ = bits;
+              keys_size_ = size - keys_offset;
+              return true;
+            }
+        }
+    }
+  close ();
+  return false;
+}
+
+void LotWUsersIndex::close ()
+{
+  file_.close ();               // unmaps
+  buckets_ = records_ = keys_ = nullptr;
+  count_ = 0;
+  bucket_bits_ = 0;
+  keys_size_ = 0;
+}
+
+QDate LotWUsersIndex::last_upload (QString const& call) const
+{
+  auto length = call.size ();
+  if (!count_ || !length || length > max_key_length) return QDate {};
+  char key[max_key_length];
+  for (int i = 0; i < length; ++i)
+    {
+      auto c = call[i].unicode ();
+      if (c > 0x7f) return QDate {}; // call signs are ASCII
+      key[i] = static_cast<char> (c);
+    }
+  auto h = hash (key, length);
+  auto b = bucket (h, bucket_bits_);
+  auto last = std::min (qFromLittleEndian<quint32> (buckets_ + 4 * (b + 1)), count_);
+  for (auto i = qFromLittleEndian<quint32> (buckets_ + 4 * b); i < last; ++i)
+    {
+      auto record = records_ + record_size * i;
+      auto offset = qFromLittleEndian<quint32> (record);
+      if (length == record[4] && static_cast<uchar> (h) == record[5]
+          && quint64 {offset} + length <= keys_size_
+          && !std::memcmp (keys_ + offset, key, length))
+        {
+          return QDate::fromJulianDay (epoch_julian_day + qFromLittleEndian<quint16> (record + 6));
+        }
+    }
+  return QDate {};
+}
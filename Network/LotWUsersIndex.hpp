@@ -0,0 +1,52 @@
+#ifndef LOTW_USERS_INDEX_HPP_
+#define LOTW_USERS_INDEX_HPP_
+
+#include <QtGlobal>
+#include <QFile>
+
+class QString;
+class QDate;
+
+//
+// LotWUsersIndex - memory mapped index of LotW users
+//
+//  The index file is built from the LotW user activity CSV file and
+//  holds the day of each call sign's last upload. Call signs are
+//  hashed into buckets of a couple of records each, so a lookup reads
+//  a few bytes of the mapping and allocates nothing. The file records
+//  the size and modification time of the CSV file it was built from.
+//
+class LotWUsersIndex final
+{
+public:
+  LotWUsersIndex ();
+  ~LotWUsersIndex ();
+
+  // Build an index of csv_path as index_path, returns the number of
+  // call signs, throws std::runtime_error
+  static quint32 build (QString const& csv_path, QString const& index_path);
+
+  // true if index_path was built from csv_path as it is now
+  static bool current (QString const& csv_path, QString const& index_path);
+
+  // map index_path in place of any index mapped before, false if it
+  // is not a valid index in which case the index is empty
+  bool open (QString const& index_path);
+  void close ();
+
+  quint32 size () const {return count_;}
+
+  // date of the last upload by call, invalid if none
+  QDate last_upload (QString const& call) const;
+
+private:
+  QFile file_;
+  uchar const * buckets_;
+  uchar const * records_;
+  uchar const * keys_;
+  quint32 count_;
+  quint32 bucket_bits_;
+  quint64 keys_size_;
+};
+
+#endif
@@ -4,13 +4,16 @@
 #include <vector>
 #include <algorithm>
 #include <limits>
+#include <memory>
 
 #include <QUdpSocket>
 #include <QNetworkInterface>
 #include <QHostInfo>
 #include <QTimer>
 #include <QQueue>
+#include <QHash>
 #include <QByteArray>
+#include <QtEndian>
 #include <QColor>
 #include <QDebug>
 
@@ -27,6 +30,13 @@
 #define TRACE_UDP(MSG)
 #endif
 
+namespace
+{
+  // decodes are batched into datagrams no bigger than this, small
+  // enough to avoid fragmentation on most paths
+  int constexpr max_batch_datagram_size {1400};
+}
+
 class MessageClient::impl
   : public QUdpSocket
 {
@@ -45,8 +55,14 @@ public:
     , TTL_ {TTL}
     , schema_ {2}  // use 2 prior to negotiation not 1 which is broken
     , heartbeat_timer_ {new QTimer {this}}
+    , batch_timer_ {new QTimer {this}}
+    , batch_count_ {0}
+    , batch_count_offset_ {0}
   {
     connect (heartbeat_timer_, &QTimer::timeout, this, &impl::heartbeat);
+    batch_timer_->setSingleShot (true);
+    batch_timer_->setInterval (0); // when the current burst of decodes is done
+    connect (batch_timer_, &QTimer::timeout, this, &impl::flush_decodes);
     connect (this, &QIODevice::readyRead, this, &impl::pending_datagrams);
 
     heartbeat_timer_->start (NetworkMessage::pulse * 1000);
@@ -66,7 +82,7 @@ public:
   void set_server (QString const& server_name, QStringList const& network_interface_names);
   Q_SLOT void host_info_results (QHostInfo);
   void start ();
-  void parse_message (QByteArray const&);
+  void parse_message (QByteArray const&, QHostAddress const& sender, port_type sender_port);
   void pending_datagrams ();
   void heartbeat ();
   void closedown ();
@@ -74,6 +90,10 @@ public:
   void send_message (QByteArray const&, bool queue_if_pending = true, bool allow_duplicates = false);
   void send_message (QDataStream const& out, QByteArray const& message, bool queue_if_pending = true, bool allow_duplicates = false)
   {
+    if (&message != &batch_)
+      {
+        flush_decodes ();       // keep decodes in order with the rest
+      }
     if (OK == check_status (out))
       {
         send_message (message, queue_if_pending, allow_duplicates);
@@ -84,6 +104,19 @@ public:
       }
   }
 
+  // true if every server heard from reads DecodeBatch messages
+  bool batch_decodes () const
+  {
+    return servers_batch_.size () && !servers_batch_.values ().contains (false);
+  }
+
+  // add a decode, written by write_fields, to the DecodeBatch message
+  // being built, sending it first if the decode would not fit
+  template<typename F>
+  void queue_decode (NetworkMessage::Type, F write_fields);
+  void start_batch ();
+  Q_SLOT void flush_decodes ();
+
   MessageClient * self_;
   bool enabled_;
   QString id_;
@@ -101,6 +134,16 @@ public:
   // hold messages sent before host lookup completes asynchronously
   QQueue<QByteArray> pending_messages_;
   QByteArray last_message_;
+
+  // whether each server that has replied reads DecodeBatch messages
+  QHash<QString, bool> servers_batch_;
+
+  // the DecodeBatch message being built
+  QTimer * batch_timer_;
+  QByteArray batch_;
+  std::unique_ptr<NetworkMessage::Builder> batch_out_;
+  quint32 batch_count_;
+  int batch_count_offset_;
 };
 
 #include "MessageClient.moc"
@@ -108,6 +151,8 @@ public:
 void MessageClient::impl::set_server (QString const& server_name, QStringList const& network_interface_names)
 {
   // qDebug () << "MessageClient server:" << server_name << "port:" << server_port_ << "interfaces:" << network_interface_names;
+  flush_decodes ();
+  servers_batch_.clear ();
   server_.setAddress (server_name);
   network_interfaces_.clear ();
   for (auto const& net_if_name : network_interface_names)
@@ -213,12 +258,12 @@ void MessageClient::impl::pending_datagrams ()
       if (0 <= readDatagram (datagram.data (), datagram.size (), &sender_address, &sender_port))
         {
           TRACE_UDP ("message received from:" << sender_address << "port:" << sender_port);
-          parse_message (datagram);
+          parse_message (datagram, sender_address, sender_port);
         }
     }
 }
 
-void MessageClient::impl::parse_message (QByteArray const& msg)
+void MessageClient::impl::parse_message (QByteArray const& msg, QHostAddress const& sender, port_type sender_port)
 {
   try
     {
@@ -234,6 +279,19 @@ void MessageClient::impl::parse_message (QByteArray const& msg)
               schema_ = in.schema ();
             }
 
+          if (NetworkMessage::Heartbeat == in.type ())
+            {
+              // learn which message types this server reads
+              quint32 maximum_schema {0};
+              QByteArray version;
+              QByteArray revision;
+              quint32 type_count {0};
+              in >> maximum_schema >> version >> revision >> type_count;
+              TRACE_UDP ("Heartbeat from:" << sender << "port:" << sender_port << "message types:" << type_count);
+              servers_batch_[sender.toString () + ':' + QString::number (sender_port)]
+                = OK == check_status (in) && type_count > NetworkMessage::DecodeBatch;
+            }
+
           if (!enabled_)
             {
               TRACE_UDP ("message processing disabled for id:" << in.id ());
@@ -428,7 +486,8 @@ void MessageClient::impl::heartbeat ()
       QByteArray message;
       NetworkMessage::Builder out {&message, NetworkMessage::Heartbeat, id_, schema_};
       out << NetworkMessage::Builder::schema_number // maximum schema number accepted
-          << version_.toUtf8 () << revision_.toUtf8 ();
+          << version_.toUtf8 () << revision_.toUtf8 ()
+          << static_cast<quint32> (NetworkMessage::maximum_message_type_);
       TRACE_UDP ("schema:" << schema_ << "max schema:" << NetworkMessage::Builder::schema_number << "version:" << version_ << "revision:" << revision_);
       send_message (out, message, false, true);
     }
@@ -478,6 +537,52 @@ void MessageClient::impl::send_message (QByteArray const& message, bool queue_if
     }
 }
 
+template<typename F>
+void MessageClient::impl::queue_decode (NetworkMessage::Type type, F write_fields)
+{
+  if (!batch_out_)
+    {
+      start_batch ();
+    }
+  QByteArray fields;
+  QDataStream entry {&fields, QIODevice::WriteOnly};
+  entry.setVersion (batch_out_->version ());
+  write_fields (entry);
+  // type, then fields with their length
+  if (batch_count_ && batch_.size () + 8 + fields.size () > max_batch_datagram_size)
+    {
+      flush_decodes ();
+      start_batch ();
+    }
+  *batch_out_ << static_cast<quint32> (type) << fields;
+  ++batch_count_;
+  if (!batch_timer_->isActive ())
+    {
+      batch_timer_->start ();
+    }
+}
+
+void MessageClient::impl::start_batch ()
+{
+  batch_.clear ();
+  batch_out_.reset (new NetworkMessage::Builder {&batch_, NetworkMessage::DecodeBatch, id_, schema_});
+  batch_count_ = 0;
+  batch_count_offset_ = batch_.size ();
+  *batch_out_ << batch_count_;  // filled in when sent
+}
+
+void MessageClient::impl::flush_decodes ()
+{
+  batch_timer_->stop ();
+  if (batch_out_)
+    {
+      qToBigEndian (batch_count_, reinterpret_cast<uchar *> (batch_.data () + batch_count_offset_));
+      TRACE_UDP ("decodes:" << batch_count_ << "size:" << batch_.size ());
+      send_message (*batch_out_, batch_);
+      batch_out_.reset ();
+    }
+}
+
 auto MessageClient::impl::check_status (QDataStream const& stream) const -> StreamStatus
 {
   auto stat = stream.status ();
@@ -593,12 +698,22 @@ void MessageClient::decode (bool is_new, QTime time, qint32 snr, float delta_tim
 {
    if (m_->server_port_ && !m_->server_.isNull ())
     {
-      QByteArray message;
-      NetworkMessage::Builder out {&message, NetworkMessage::Decode, m_->id_, m_->schema_};
-      out << is_new << time << snr << delta_time << delta_frequency << mode.toUtf8 ()
-          << message_text.toUtf8 () << low_confidence << off_air;
+      auto write_fields = [&] (QDataStream& out) {
+        out << is_new << time << snr << delta_time << delta_frequency << mode.toUtf8 ()
+            << message_text.toUtf8 () << low_confidence << off_air;
+      };
       TRACE_UDP ("new" << is_new << "time:" << time << "snr:" << snr << "dt:" << delta_time << "df:" << delta_frequency << "mode:" << mode << "text:" << message_text << "low conf:" << low_confidence << "off air:" << off_air);
-      m_->send_message (out, message);
+      if (m_->batch_decodes ())
+        {
+          m_->queue_decode (NetworkMessage::Decode, write_fields);
+        }
+      else
+        {
+          QByteArray message;
+          NetworkMessage::Builder out {&message, NetworkMessage::Decode, m_->id_, m_->schema_};
+          write_fields (out);
+          m_->send_message (out, message);
+        }
     }
 }
 
@@ -608,12 +723,22 @@ void MessageClient::WSPR_decode (bool is_new, QTime time, qint32 snr, float delt
 {
    if (m_->server_port_ && !m_->server_.isNull ())
     {
-      QByteArray message;
-      NetworkMessage::Builder out {&message, NetworkMessage::WSPRDecode, m_->id_, m_->schema_};
-      out << is_new << time << snr << delta_time << frequency << drift << callsign.toUtf8 ()
-          << grid.toUtf8 () << power << off_air;
+      auto write_fields = [&] (QDataStream& out) {
+        out << is_new << time << snr << delta_time << frequency << drift << callsign.toUtf8 ()
+            << grid.toUtf8 () << power << off_air;
+      };
       TRACE_UDP ("new:" << is_new << "time:" << time << "snr:" << snr << "dt:" << delta_time << "frequency:" << frequency << "drift:" << drift << "call:" << callsign << "grid:" << grid << "pwr:" << power << "off air:" << off_air);
-      m_->send_message (out, message);
+      if (m_->batch_decodes ())
+        {
+          m_->queue_decode (NetworkMessage::WSPRDecode, write_fields);
+        }
+      else
+        {
+          QByteArray message;
+          NetworkMessage::Builder out {&message, NetworkMessage::WSPRDecode, m_->id_, m_->schema_};
+          write_fields (out);
+          m_->send_message (out, message);
+        }
     }
 }
 
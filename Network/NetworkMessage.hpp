@@ -112,6 +112,7 @@
  *                         Maximum schema number  quint32
  *                         version                utf8
  *                         revision               utf8
+ *                         Message type count     quint32
  *
  *    The heartbeat  message shall be  sent on a periodic  basis every
  *    NetworkMessage::pulse   seconds   (see    below),   the   WSJT-X
@@ -137,6 +138,14 @@
  *    schema 2 is the highest schema number supported if the Heartbeat
  *    message does not contain the "Maximum schema number" field.
  *
+ *    The "Message type count" field is one more than the highest
+ *    message type value the sender understands. Message types are only
+ *    ever added at the end so the sender understands every type below
+ *    it. A peer that does not send the field must be assumed to
+ *    understand no type above Configure (15). A client uses the count
+ *    sent by a server to decide whether it may send DecodeBatch
+ *    messages.
+ *
  *
  * Status        Out       1                      quint32
  *                         Id (unique key)        utf8
@@ -495,6 +504,30 @@
  *      and  Frequency  Tolerance  fields the  maximum  quint32  value
  *      implies  no change.   Invalid or  unrecognized values  will be
  *      silently ignored.
+ *
+ *
+ * Decode Batch   Out      16                     quint32
+ *                         Id (unique key)        utf8
+ *                         Count                  quint32
+ *                         Count times:
+ *                           Type                 quint32
+ *                           Fields               QByteArray
+ *
+ *      Carries several Decode (2) or WSPRDecode (10) messages in one
+ *      datagram. Each one's Type is the message type it stands for,
+ *      and its Fields are that message's fields after the Id,
+ *      serialized with the same schema as this message. Fields is a
+ *      length-prefixed byte array, so new fields may be added to the
+ *      end of Decode and WSPRDecode as usual. A reader that does not
+ *      know an entry's Type skips it.
+ *
+ *      A client sends the decodes of a burst, usually a decoding pass,
+ *      as one of these messages. If they do not fit in one datagram of
+ *      a safe size for the network, it sends as few messages as fit.
+ *      A client only sends Decode Batch when every server that replied
+ *      to its Heartbeat sent a "Message type count" above 16, which
+ *      matters for multicast groups with several servers. Otherwise it
+ *      sends a Decode or WSPRDecode message per decode as before.
  */
 
 #include <QDataStream>
@@ -526,6 +559,7 @@ namespace NetworkMessage
       HighlightCallsign,
       SwitchConfiguration,
       Configure,
+      DecodeBatch,
       maximum_message_type_     // ONLY add new message types
                                 // immediately before here
     };
@@ -9,6 +9,7 @@
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <list>
 #include <QObject>
 #include <QString>
 #include <QDateTime>
@@ -17,6 +18,7 @@
 #include <QTcpSocket>
 #include <QHostInfo>
 #include <QQueue>
+#include <QHash>
 #include <QByteArray>
 #include <QDataStream>
 #include <QTimer>
@@ -27,6 +29,7 @@
 
 #include "Logger.hpp"
 #include "Configuration.hpp"
+#include "models/Bands.hpp"
 #include "pimpl_impl.hpp"
 
 
@@ -46,11 +49,81 @@ namespace
   int MIN_PAYLOAD_LENGTH {508};
   int MAX_PAYLOAD_LENGTH {10000};
   int CACHE_TIMEOUT {300}; // default to 5 minutes for repeating spots
-  QMap<QString, time_t> spot_cache;
-}
 
-static int added;
-static int removed;
+  //
+  // Expiring set of recently reported spots keyed by call, band and
+  // mode. Entries are kept in a list in order of their last refresh
+  // so expired ones are always at the front; each lookup or insert is
+  // O(1) and eviction is amortised over the inserts that created the
+  // entries.
+  //
+  class SpotCache final
+  {
+  public:
+    explicit SpotCache (int timeout) : timeout_ {timeout} {}
+
+    void timeout (int seconds) {timeout_ = seconds;}
+
+    // true if key was refreshed within the timeout, otherwise
+    // (re)inserts key with time now
+    bool seen (QString const& key, qint64 now)
+    {
+      expire (now);
+      auto pos = index_.find (key);
+      if (pos != index_.end ())
+        {
+          ++hits_;
+          return true;
+        }
+      insert (key, now);
+      return false;
+    }
+
+    // (re)insert key with time now
+    void refresh (QString const& key, qint64 now)
+    {
+      expire (now);
+      insert (key, now);
+    }
+
+    int size () const {return index_.size ();}
+    quint64 hits () const {return hits_;}
+    quint64 evicted () const {return evicted_;}
+
+  private:
+    void insert (QString const& key, qint64 now)
+    {
+      auto pos = index_.find (key);
+      if (pos != index_.end ())
+        {
+          entries_.erase (pos.value ());
+        }
+      entries_.push_back ({key, now});
+      index_[key] = std::prev (entries_.end ());
+    }
+
+    void expire (qint64 now)
+    {
+      while (!entries_.empty () && now - entries_.front ().time_ > timeout_)
+        {
+          index_.remove (entries_.front ().key_);
+          entries_.pop_front ();
+          ++evicted_;
+        }
+    }
+
+    struct Entry
+    {
+      QString key_;
+      qint64 time_;
+    };
+    int timeout_;
+    std::list<Entry> entries_;
+    QHash<QString, std::list<Entry>::iterator> index_;
+    quint64 hits_ {0};
+    quint64 evicted_ {0};
+  };
+}
 
 class PSKReporter::impl final
   : public QObject
@@ -69,6 +142,8 @@ public:
     , send_receiver_data_ {0}
     , flush_counter_ {0u}
     , prog_id_ {program_info}
+    , spot_cache_ {CACHE_TIMEOUT}
+    , spots_offered_ {0u}
   {
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
     observation_id_ = qrand();
@@ -260,6 +335,8 @@ public:
     QDateTime time_;
   };
   QQueue<Spot> spots_;
+  SpotCache spot_cache_;
+  quint64 spots_offered_;
   QTimer report_timer_;
   QTimer descriptor_timer_;
 };
@@ -498,6 +575,10 @@ void PSKReporter::impl::send_report (bool send_residue)
         }
 
       LOG_LOG_LOCATION (logger_, debug, "pending spots: " << spots_.size ());
+      LOG_LOG_LOCATION (logger_, debug, "spot cache: " << spot_cache_.size () << " entries, "
+                        << spot_cache_.hits () << " of " << spots_offered_ << " spots suppressed ("
+                        << (spots_offered_ ? 100. * spot_cache_.hits () / spots_offered_ : 0.) << "%), "
+                        << spot_cache_.evicted () << " evicted");
       while (spots_.size () || flush)
         {
           auto tx_data_size = tx_data_.size ();
@@ -600,6 +681,11 @@ void PSKReporter::reconnect ()
   m_->reconnect ();
 }
 
+void PSKReporter::setSpotCacheTimeout (int seconds)
+{
+  m_->spot_cache_.timeout (seconds);
+}
+
 bool PSKReporter::eclipse_active(QDateTime now)
 {
   return m_->eclipse_active(now);
@@ -631,45 +717,20 @@ bool PSKReporter::addRemoteStation (QString const& call, QString const& grid, Ra
         {
            reconnect ();
         }
-      // remove any earlier spots of this call to reduce pskreporter load
-#ifdef DEBUGPSK
-      static std::fstream fs;
-      if (!fs.is_open()) fs.open("/temp/psk.log", std::fstream::in | std::fstream::out | std::fstream::app);
-#endif
-      added++;
-
-      QDateTime qdateNow = QDateTime::currentDateTime().toUTC();
+      // suppress repeats of a call on the same band and mode to reduce pskreporter load
+      ++m_->spots_offered_;
+      auto now = QDateTime::currentDateTimeUtc ();
+      auto key = call + '|' + m_->config_->bands ()->find (freq) + '|' + mode;
       // we allow all spots through +/- 6 hours around an eclipse for the HamSCI group
-      if (!spot_cache.contains(call) || freq > 49000000 || eclipse_active(qdateNow)) // then it's a new spot
-      {
-        m_->spots_.enqueue ({call, grid, snr, freq, mode, QDateTime::currentDateTimeUtc ()});
-        spot_cache.insert(call, time(NULL));
-#ifdef DEBUGPSK
-        if (fs.is_open()) fs << "Adding   " << call << " freq=" << freq << " " << spot_cache[call] <<  " count=" << m_->spots_.count() << std::endl;
-#endif
-      }
-      else if (time(NULL) - spot_cache[call] > CACHE_TIMEOUT) // then the cache has expired  
-      {
-        m_->spots_.enqueue ({call, grid, snr, freq, mode, QDateTime::currentDateTimeUtc ()});
-#ifdef DEBUGPSK
-        if (fs.is_open()) fs << "Adding # " << call << spot_cache[call] << " count=" << m_->spots_.count() << std::endl;
-#endif
-        spot_cache[call] = time(NULL);
-      }
-      else
-      {
-        removed++;
-#ifdef DEBUGPSK
-        if (fs.is_open()) fs << "Removing " << call << " " << time(NULL) << " reduction=" << removed/(double)added*100 << "%" << std::endl;
-#endif
-      }
-      // remove cached items over 10 minutes old to save a little memory
-      QMapIterator<QString, time_t> i(spot_cache);
-      time_t tmptime = time(NULL);
-      while(i.hasNext()) {
-          i.next();
-          if (tmptime - i.value() > 600) spot_cache.remove(i.key());
-      }
+      if (freq > 49000000 || eclipse_active (now))
+        {
+          m_->spot_cache_.refresh (key, now.toSecsSinceEpoch ());
+          m_->spots_.enqueue ({call, grid, snr, freq, mode, now});
+        }
+      else if (!m_->spot_cache_.seen (key, now.toSecsSinceEpoch ())) // new or expired
+        {
+          m_->spots_.enqueue ({call, grid, snr, freq, mode, now});
+        }
       return true;
     }
   return false;
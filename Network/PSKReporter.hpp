@@ -26,6 +26,12 @@ public:
   //
   bool addRemoteStation (QString const& call, QString const& grid, Radio::Frequency freq, QString const& mode, int snr);
 
+  //
+  // Repeat spots of a call on the same band and mode are not sent
+  // again until this many seconds have passed
+  //
+  void setSpotCacheTimeout (int seconds);
+
   //
   // Flush any pending spots to PSK Reporter
   //
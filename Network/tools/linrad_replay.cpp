@@ -0,0 +1,252 @@
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <locale>
+#include <cmath>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QHostAddress>
+#include <QUdpSocket>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QThread>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "revision_utils.hpp"
+#include "Network/LinradReceiver.hpp"
+
+//
+// Send Linrad format datagrams to MAP65 or QMAP at the real time rate,
+// either replayed from a file of raw 1416 byte datagrams or
+// synthesized as a tone in noise. Packets can be dropped on purpose to
+// check the receiver's loss accounting.
+//
+namespace
+{
+  QTextStream qtout {stdout};
+
+  double const pi {4. * std::atan (1.)};
+  int const sample_rate {96000};
+
+  // samples per datagram for each Linrad data format
+  int samples_per_packet (int nrx)
+  {
+    switch (nrx)
+      {
+      case +1: return 348;      // one RF channel, i*2 data
+      case -1: return 174;      // one RF channel, r*4 data
+      case +2: return 174;      // two RF channels, i*2 data
+      case -2: return 87;       // two RF channels, r*4 data
+      }
+    throw std::invalid_argument {"nrx must be one of -2, -1, +1 or +2"};
+  }
+
+  // fill the payload of packet with a complex tone plus noise
+  void synthesize (LinradPacket& packet, int nrx, double f0, double& phase)
+  {
+    auto iz = samples_per_packet (nrx);
+    auto channels = std::abs (nrx);
+    auto * rng = QRandomGenerator::global ();
+    auto dphi = 2. * pi * f0 / sample_rate;
+    auto * i2 = reinterpret_cast<qint16 *> (packet.d8);
+    auto * r4 = reinterpret_cast<float *> (packet.d8);
+    for (int i = 0; i < iz; ++i)
+      {
+        for (int j = 0; j < channels; ++j)
+          {
+            auto x = 100. * std::cos (phase) + 300. * (rng->generateDouble () - .5);
+            auto y = 100. * std::sin (phase) + 300. * (rng->generateDouble () - .5);
+            auto n = 2 * (i * channels + j);
+            if (nrx > 0)
+              {
+                i2[n] = static_cast<qint16> (x);
+                i2[n + 1] = static_cast<qint16> (y);
+              }
+            else
+              {
+                r4[n] = static_cast<float> (x);
+                r4[n + 1] = static_cast<float> (y);
+              }
+          }
+        phase = std::fmod (phase + dphi, 2. * pi);
+      }
+  }
+}
+
+int main (int argc, char * argv[])
+{
+  QCoreApplication app {argc, argv};
+  try
+    {
+      std::locale::global (std::locale::classic ());
+
+      app.setApplicationName ("Linrad UDP Replay");
+      app.setApplicationVersion (version ());
+
+      QCommandLineParser parser;
+      parser.setApplicationDescription ("\nSend Linrad network datagrams to MAP65 or QMAP for testing");
+      auto help_option = parser.addHelpOption ();
+      auto version_option = parser.addVersionOption ();
+
+      parser.addOptions ({
+          {{"a", "address"},
+              app.translate ("main", "Send to <address>, default 127.0.0.1"),
+              app.translate ("main", "address")},
+          {{"p", "port"},
+              app.translate ("main", "Send to UDP <port>, default 50004"),
+              app.translate ("main", "port")},
+          {{"i", "input"},
+              app.translate ("main", "Replay raw datagrams from <input-file>"),
+              app.translate ("main", "input-file")},
+          {{"n", "nrx"},
+              app.translate ("main", "Synthesize data in Linrad format <nrx> (-2, -1, +1 or +2), default +1"),
+              app.translate ("main", "nrx")},
+          {{"f", "frequency"},
+              app.translate ("main", "Synthesize a tone <offset> Hz from the centre, default 1000"),
+              app.translate ("main", "offset")},
+          {{"c", "centre"},
+              app.translate ("main", "Report a centre frequency of <MHz>, default 144.125"),
+              app.translate ("main", "MHz")},
+          {{"d", "duration"},
+              app.translate ("main", "Send for <duration> seconds, default 60"),
+              app.translate ("main", "duration")},
+          {{"D", "drop"},
+              app.translate ("main", "Drop every <n>th datagram"),
+              app.translate ("main", "n")},
+          {{"s", "speed"},
+              app.translate ("main", "Send at <factor> times real time, zero for as fast as possible"),
+              app.translate ("main", "factor")},
+        });
+      parser.process (app);
+
+      bool ok {true};
+      QHostAddress address {QHostAddress::LocalHost};
+      if (parser.isSet ("a") && !address.setAddress (parser.value ("a")))
+        {
+          throw std::invalid_argument {"invalid address"};
+        }
+      quint16 port {50004};
+      if (parser.isSet ("p"))
+        {
+          port = parser.value ("p").toUShort (&ok);
+          if (!ok) throw std::invalid_argument {"port not a number"};
+        }
+      int nrx {+1};
+      if (parser.isSet ("n"))
+        {
+          nrx = parser.value ("n").toInt (&ok);
+          if (!ok) throw std::invalid_argument {"nrx not a number"};
+        }
+      auto iz = samples_per_packet (nrx);
+      double f0 {1000.};
+      if (parser.isSet ("f"))
+        {
+          f0 = parser.value ("f").toDouble (&ok);
+          if (!ok) throw std::invalid_argument {"frequency not a number"};
+        }
+      double cfreq {144.125};
+      if (parser.isSet ("c"))
+        {
+          cfreq = parser.value ("c").toDouble (&ok);
+          if (!ok) throw std::invalid_argument {"centre frequency not a number"};
+        }
+      int duration {60};
+      if (parser.isSet ("d"))
+        {
+          duration = parser.value ("d").toInt (&ok);
+          if (!ok) throw std::invalid_argument {"duration not a number"};
+        }
+      int drop {0};
+      if (parser.isSet ("D"))
+        {
+          drop = parser.value ("D").toInt (&ok);
+          if (!ok) throw std::invalid_argument {"drop interval not a number"};
+        }
+      double speed {1.};
+      if (parser.isSet ("s"))
+        {
+          speed = parser.value ("s").toDouble (&ok);
+          if (!ok || speed < 0.) throw std::invalid_argument {"invalid speed factor"};
+        }
+
+      QFile input;
+      if (parser.isSet ("i"))
+        {
+          input.setFileName (parser.value ("i"));
+          if (!input.open (QIODevice::ReadOnly))
+            {
+              throw std::invalid_argument {"cannot open input file: " + input.errorString ().toStdString ()};
+            }
+        }
+
+      QUdpSocket socket;
+      LinradPacket packet {};
+      packet.cfreq = cfreq;
+      packet.nrx = nrx;
+      packet.iusb = 1;
+      double phase {0.};
+      auto total = qint64 (duration) * sample_rate / iz;
+      qint64 sent {0};
+      qint64 dropped {0};
+      qint64 samples {0};
+      QElapsedTimer clock;
+      clock.start ();
+      for (qint64 n = 0; n < total; ++n)
+        {
+          if (input.isOpen ())
+            {
+              if (input.read (reinterpret_cast<char *> (&packet), sizeof packet) != qint64 (sizeof packet))
+                {
+                  if (!input.seek (0)) break; // loop the recording
+                  if (input.read (reinterpret_cast<char *> (&packet), sizeof packet) != qint64 (sizeof packet)) break;
+                }
+              // the receiver assumes the sample rate from the format
+              iz = samples_per_packet (packet.nrx);
+            }
+          else
+            {
+              synthesize (packet, nrx, f0, phase);
+            }
+          packet.msec = QDateTime::currentMSecsSinceEpoch () % 86400000;
+          packet.iblk = quint16 (n);
+          if (drop > 0 && !((n + 1) % drop))
+            {
+              ++dropped;
+            }
+          else
+            {
+              if (socket.writeDatagram (reinterpret_cast<char const *> (&packet), sizeof packet, address, port) != qint64 (sizeof packet))
+                {
+                  throw std::runtime_error {"send failed: " + socket.errorString ().toStdString ()};
+                }
+              ++sent;
+            }
+
+          samples += iz;
+          if (speed > 0.)
+            {
+              // keep to the sample clock, catching up after any delay
+              auto due_us = qint64 (samples * 1e6 / (sample_rate * speed));
+              auto ahead_us = due_us - clock.nsecsElapsed () / 1000;
+              if (ahead_us > 0) QThread::usleep (ahead_us);
+            }
+        }
+      qtout << "sent " << sent << " datagrams, dropped " << dropped << " in "
+            << clock.elapsed () / 1000. << " s\n";
+    }
+  catch (std::exception const& e)
+    {
+      std::cerr << "Error: " << e.what () << '\n';
+      return -1;
+    }
+  catch (...)
+    {
+      std::cerr << "Unexpected fatal error\n";
+      throw;                    // hoping the runtime might tell us more
+    }
+  return 0;
+}
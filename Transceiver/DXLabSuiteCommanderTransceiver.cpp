@@ -197,7 +197,7 @@ void DXLabSuiteCommanderTransceiver::do_ptt (bool on)
       Q_ASSERT (wrapped_);
       TransceiverState new_state {wrapped_->state ()};
       new_state.ptt (on);
-      wrapped_->set (new_state, 0);
+      wrapped_->set_now (new_state, 0);
       update_PTT (on);
     }
 }
@@ -1229,3 +1229,9 @@ void HamlibTransceiver::do_ptt (bool on)
 
   update_PTT (on);
 }
+
+int HamlibTransceiver::do_ptt_settle_time () const
+{
+  // the dummy rig and PTT only instances take no CAT commands
+  return m_->is_dummy_ || m_->ptt_only_ ? 0 : PollingTransceiver::do_ptt_settle_time ();
+}
@@ -702,7 +702,7 @@ void OmniRigTransceiver::do_ptt (bool on)
           CAT_TRACE ("set PTT using basic transceiver");
           TransceiverState new_state {wrapped_->state ()};
           new_state.ptt (on);
-          wrapped_->set (new_state, 0);
+          wrapped_->set_now (new_state, 0);
         }
     }
   update_PTT (on);
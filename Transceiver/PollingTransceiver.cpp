@@ -142,7 +142,9 @@ void PollingTransceiver::handle_timeout ()
   // inform our parent of the failure via the offline() message
   try
     {
-      do_poll ();              // tell sub-classes to update our state
+      timed (Command::poll, [this] {
+          do_poll ();          // tell sub-classes to update our state
+        });
 
       // Signal new state if it what we expected or, hasn't become
       // what we expected after polls_to_stabilize polls. Unsolicited
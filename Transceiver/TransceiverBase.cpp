@@ -1,6 +1,9 @@
 #include "TransceiverBase.hpp"
 
 #include <exception>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 
 #include <QString>
 #include <QTimer>
@@ -18,6 +21,7 @@ void TransceiverBase::start (unsigned sequence_number) noexcept
 {
   CAT_TRACE ("#: " << sequence_number);
 
+  process_requests ();          // in the order they were made
   QString message;
   try
     {
@@ -45,7 +49,54 @@ void TransceiverBase::start (unsigned sequence_number) noexcept
 void TransceiverBase::set (TransceiverState const& s,
                            unsigned sequence_number) noexcept
 {
-  CAT_TRACE ("#: " << s);
+  CAT_TRACE ("#: " << sequence_number << " " << s);
+
+  // a pending request is replaced unless PTT or on-line state
+  // changes between them
+  if (pending_.size ()
+      && pending_.last ().state.ptt () == s.ptt ()
+      && pending_.last ().state.online () == s.online ())
+    {
+      CAT_TRACE ("replaces #: " << pending_.last ().sequence_number);
+      pending_.last ().state = s;
+      pending_.last ().sequence_number = sequence_number;
+      ++coalesced_;
+    }
+  else
+    {
+      pending_ << Request {s, sequence_number, clock_.elapsed ()};
+    }
+  if (!flush_scheduled_)
+    {
+      // requests that arrive before this runs are coalesced
+      flush_scheduled_ = true;
+      QTimer::singleShot (0, this, &TransceiverBase::process_requests);
+    }
+}
+
+void TransceiverBase::set_now (TransceiverState const& s,
+                               unsigned sequence_number) noexcept
+{
+  process_requests ();          // in the order they were made
+  apply (s, sequence_number);
+}
+
+void TransceiverBase::process_requests ()
+{
+  flush_scheduled_ = false;
+  while (pending_.size ())
+    {
+      auto request = pending_.takeFirst ();
+      latencies_[static_cast<int> (Command::queued)].add (clock_.elapsed () - request.queued_at);
+      apply (request.state, request.sequence_number);
+    }
+  report_latencies (false);
+}
+
+void TransceiverBase::apply (TransceiverState const& s,
+                             unsigned sequence_number)
+{
+  CAT_TRACE ("#: " << sequence_number << " " << s);
 
   QString message;
   try
@@ -71,19 +122,15 @@ void TransceiverBase::set (TransceiverState const& s,
               ptt_on = s.ptt ();
               ptt_off = !s.ptt ();
             }
-          if (ptt_off)
+          if (ptt_off)          // before any QSY
             {
-              do_ptt (false);
-              do_post_ptt (false);
-              QThread::msleep (100); // some rigs cannot process CAT
-                                     // commands while switching from
-                                     // Tx to Rx
+              ptt (false);
             }
           if (s.frequency ()    // ignore bogus zero frequencies
               && ((s.frequency () != requested_.frequency () // and QSY
                    || (s.mode () != UNK && s.mode () != requested_.mode ())))) // or mode change
             {
-              do_frequency (s.frequency (), s.mode (), ptt_off);
+              timed (Command::frequency, [&] {do_frequency (s.frequency (), s.mode (), ptt_off);});
               do_post_frequency (s.frequency (), s.mode ());
 
               // record what actually changed
@@ -99,7 +146,7 @@ void TransceiverBase::set (TransceiverState const& s,
                   // || s.split () != requested_.split ())) // or split change
                   || (s.tx_frequency () && ptt_on)) // or about to tx split
                 {
-                  do_tx_frequency (s.tx_frequency (), s.mode (), ptt_on);
+                  timed (Command::tx_frequency, [&] {do_tx_frequency (s.tx_frequency (), s.mode (), ptt_on);});
                   do_post_tx_frequency (s.tx_frequency (), s.mode ());
 
                   // record what actually changed
@@ -107,13 +154,11 @@ void TransceiverBase::set (TransceiverState const& s,
                   requested_.split (actual_.split ());
                 }
             }
-          if (ptt_on)
+          if (ptt_on)           // after the Tx QSY it depends on
             {
-              do_ptt (true);
-              do_post_ptt (true);
-              QThread::msleep (100); // some rigs cannot process CAT
-                                     // commands while switching from
-                                     // Rx to Tx
+              ptt (true);
+              settle ();        // the rig is transmitting when we
+                                // signal that it is
             }
 
           // record what actually changed
@@ -136,6 +181,83 @@ void TransceiverBase::set (TransceiverState const& s,
     }
 }
 
+void TransceiverBase::ptt (bool on)
+{
+  timed (Command::ptt, [&] {do_ptt (on);});
+  do_post_ptt (on);
+  // some rigs cannot process CAT commands while switching between Rx
+  // and Tx
+  settled_at_ = clock_.elapsed () + do_ptt_settle_time ();
+}
+
+void TransceiverBase::settle ()
+{
+  auto wait = settled_at_ - clock_.elapsed ();
+  if (wait > 0)
+    {
+      CAT_TRACE ("settling for: " << wait << "ms");
+      QThread::msleep (wait);
+    }
+}
+
+void TransceiverBase::report_latencies (bool always)
+{
+  if (!always && clock_.elapsed () - reported_at_ < 60000) return;
+  reported_at_ = clock_.elapsed ();
+  static char const * const names[] {"queued", "frequency", "tx frequency", "PTT", "poll"};
+  for (int i = 0; i < static_cast<int> (Command::count); ++i)
+    {
+      if (latencies_[i].count ())
+        {
+          CAT_DEBUG ("latency " << names[i] << ": " << latencies_[i].summary ());
+        }
+    }
+  if (coalesced_)
+    {
+      CAT_DEBUG ("requests coalesced: " << coalesced_);
+    }
+}
+
+void TransceiverBase::LatencyHistogram::add (qint64 ms)
+{
+  int bucket {0};
+  while (bucket < buckets - 1 && ms >= (qint64 {1} << bucket)) ++bucket;
+  ++counts_[bucket];
+  ++count_;
+  total_ += ms;
+  max_ = std::max (max_, ms);
+}
+
+void TransceiverBase::LatencyHistogram::clear ()
+{
+  std::fill (counts_, counts_ + buckets, 0u);
+  count_ = 0;
+  total_ = 0;
+  max_ = 0;
+}
+
+std::string TransceiverBase::LatencyHistogram::summary () const
+{
+  std::ostringstream os;
+  os << "n: " << count_ << " mean: " << (count_ ? total_ / count_ : 0) << "ms max: " << max_ << "ms";
+  for (int i = 0; i < buckets; ++i)
+    {
+      if (counts_[i])
+        {
+          if (i < buckets - 1)
+            {
+              os << " <" << (qint64 {1} << i);
+            }
+          else
+            {
+              os << " >=" << (qint64 {1} << (i - 1));
+            }
+          os << "ms: " << counts_[i];
+        }
+    }
+  return os.str ();
+}
+
 void TransceiverBase::startup ()
 {
   CAT_TRACE ("startup");
@@ -189,7 +311,11 @@ void TransceiverBase::shutdown ()
           CAT_TRACE ("shutdown");
           // don't care about exceptions
         }
+      report_latencies (true);
     }
+  for (auto& latency : latencies_) latency.clear ();
+  coalesced_ = 0;
+  settled_at_ = 0;
   actual_ = TransceiverState {};
   requested_ = TransceiverState {};
 }
@@ -197,6 +323,7 @@ void TransceiverBase::shutdown ()
 void TransceiverBase::stop () noexcept
 {
   CAT_TRACE ("stop");
+  process_requests ();          // in the order they were made
   QString message;
   try
     {
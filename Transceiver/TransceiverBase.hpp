@@ -2,8 +2,11 @@
 #define TRANSCEIVER_BASE_HPP__
 
 #include <stdexcept>
+#include <string>
 
 #include <QString>
+#include <QVector>
+#include <QElapsedTimer>
 
 #include "Logger.hpp"
 #include "Transceiver.hpp"
@@ -56,6 +59,16 @@
 //  Transceiver implementation, thus allowing multiple state component
 //  updates to be signalled together if required.
 //
+//  Queue set  state requests and apply  them once the thread's  event
+//  queue is drained.  Each request is a complete  target state so a
+//  new one replaces the last pending  one unless they differ in PTT or
+//  on-line state, such transitions are always carried out in turn.
+//
+//  Wait after a PTT change for as long as the concrete implementation
+//  says the rig needs  before the next CAT command, and  keep latency
+//  histograms of CAT commands that are  written to the CAT trace at
+//  intervals and on shutdown.
+//
 class TransceiverBase
   : public Transceiver
 {
@@ -65,7 +78,13 @@ protected:
   TransceiverBase (logger_type * logger, QObject * parent)
     : Transceiver {logger, parent}
     , last_sequence_number_ {0}
-  {}
+    , flush_scheduled_ {false}
+    , settled_at_ {0}
+    , coalesced_ {0}
+    , reported_at_ {0}
+  {
+    clock_.start ();
+  }
 
 public:
   //
@@ -76,6 +95,10 @@ public:
             unsigned sequence_number) noexcept override final;
   void stop () noexcept override final;
 
+  // Apply a state change at once rather than queueing it, for
+  // transceivers that use another for PTT
+  void set_now (TransceiverState const&, unsigned sequence_number) noexcept;
+
   //
   // Query operations
   //
@@ -115,6 +138,10 @@ protected:
 
   virtual bool do_pre_update () {return true;}
 
+  // milliseconds the rig needs after a PTT change before it will
+  // accept CAT commands
+  virtual int do_ptt_settle_time () const {return 100;}
+
   // sub classes report rig state changes with these methods
   void update_rx_frequency (Frequency);
   void update_other_frequency (Frequency = 0);
@@ -128,7 +155,51 @@ protected:
   // sub class may asynchronously take the rig offline by calling this
   void offline (QString const& reason);
 
+  // CAT commands timed by latency histograms
+  enum class Command {queued, frequency, tx_frequency, ptt, poll, count};
+
+  // sub classes call this to time CAT commands they make outside of
+  // the template methods, first waiting out any PTT settle time
+  template<typename F>
+  void timed (Command command, F&& f)
+  {
+    settle ();
+    auto start = clock_.elapsed ();
+    f ();
+    latencies_[static_cast<int> (command)].add (clock_.elapsed () - start);
+  }
+
 private:
+  struct Request
+  {
+    TransceiverState state;
+    unsigned sequence_number;
+    qint64 queued_at;           // ms
+  };
+
+  // counts of command latencies in power of two ms buckets
+  class LatencyHistogram
+  {
+  public:
+    LatencyHistogram () {clear ();}
+    void add (qint64 ms);
+    void clear ();
+    unsigned count () const {return count_;}
+    std::string summary () const;
+
+  private:
+    static int const buckets {12}; // <1 <2 <4 ... <1024 >=1024 ms
+    unsigned counts_[buckets];
+    unsigned count_;
+    qint64 total_;
+    qint64 max_;
+  };
+
+  void process_requests ();
+  void apply (TransceiverState const&, unsigned sequence_number);
+  void ptt (bool);
+  void settle ();
+  void report_latencies (bool always);
   void startup ();
   void shutdown ();
   bool maybe_low_resolution (Frequency low_res, Frequency high_res);
@@ -151,6 +222,14 @@ private:
   TransceiverState actual_;
   TransceiverState last_;
   unsigned last_sequence_number_;    // from set state operation
+
+  QVector<Request> pending_;
+  bool flush_scheduled_;
+  QElapsedTimer clock_;
+  qint64 settled_at_;           // ms on clock_ when rig can take CAT
+  LatencyHistogram latencies_[static_cast<int> (Command::count)];
+  unsigned coalesced_;          // requests replaced before being applied
+  qint64 reported_at_;          // ms on clock_ of last latency report
 };
 
 // some loggimg macros
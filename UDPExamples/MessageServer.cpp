@@ -58,6 +58,8 @@ public:
   void leave_multicast_group ();
   void join_multicast_group ();
   void parse_message (QHostAddress const& sender, port_type sender_port, QByteArray const& msg);
+  void parse_decode (ClientKey const&, QDataStream&);
+  void parse_WSPR_decode (ClientKey const&, QDataStream&);
   void tick ();
   void pending_datagrams ();
   StreamStatus check_status (QDataStream const&) const;
@@ -156,6 +158,51 @@ void MessageServer::impl::pending_datagrams ()
     }
 }
 
+void MessageServer::impl::parse_decode (ClientKey const& client_key, QDataStream& in)
+{
+  // unpack message
+  bool is_new {true};
+  QTime time;
+  qint32 snr;
+  float delta_time;
+  quint32 delta_frequency;
+  QByteArray mode;
+  QByteArray message;
+  bool low_confidence {false};
+  bool off_air {false};
+  in >> is_new >> time >> snr >> delta_time >> delta_frequency >> mode
+     >> message >> low_confidence >> off_air;
+  if (check_status (in) != Fail)
+    {
+      Q_EMIT self_->decode (is_new, client_key, time, snr, delta_time, delta_frequency
+                            , QString::fromUtf8 (mode), QString::fromUtf8 (message)
+                            , low_confidence, off_air);
+    }
+}
+
+void MessageServer::impl::parse_WSPR_decode (ClientKey const& client_key, QDataStream& in)
+{
+  // unpack message
+  bool is_new {true};
+  QTime time;
+  qint32 snr;
+  float delta_time;
+  Frequency frequency;
+  qint32 drift;
+  QByteArray callsign;
+  QByteArray grid;
+  qint32 power;
+  bool off_air {false};
+  in >> is_new >> time >> snr >> delta_time >> frequency >> drift >> callsign >> grid >> power
+     >> off_air;
+  if (check_status (in) != Fail)
+    {
+      Q_EMIT self_->WSPR_decode (is_new, client_key, time, snr, delta_time, frequency, drift
+                                 , QString::fromUtf8 (callsign), QString::fromUtf8 (grid)
+                                 , power, off_air);
+    }
+}
+
 void MessageServer::impl::parse_message (QHostAddress const& sender, port_type sender_port, QByteArray const& msg)
 {
   try
@@ -189,7 +236,8 @@ void MessageServer::impl::parse_message (QHostAddress const& sender, port_type s
                       QByteArray message;
                       NetworkMessage::Builder hb {&message, NetworkMessage::Heartbeat, id, client.negotiated_schema_number_};
                       hb << NetworkMessage::Builder::schema_number // maximum schema number accepted
-                         << version_.toUtf8 () << revision_.toUtf8 ();
+                         << version_.toUtf8 () << revision_.toUtf8 ()
+                         << static_cast<quint32> (NetworkMessage::maximum_message_type_);
                       if (impl::OK == check_status (hb))
                         {
                           writeDatagram (message, client_key.first, sender_port);
@@ -265,48 +313,41 @@ void MessageServer::impl::parse_message (QHostAddress const& sender, port_type s
               break;
 
             case NetworkMessage::Decode:
-              {
-                // unpack message
-                bool is_new {true};
-                QTime time;
-                qint32 snr;
-                float delta_time;
-                quint32 delta_frequency;
-                QByteArray mode;
-                QByteArray message;
-                bool low_confidence {false};
-                bool off_air {false};
-                in >> is_new >> time >> snr >> delta_time >> delta_frequency >> mode
-                   >> message >> low_confidence >> off_air;
-                if (check_status (in) != Fail)
-                  {
-                    Q_EMIT self_->decode (is_new, client_key, time, snr, delta_time, delta_frequency
-                                          , QString::fromUtf8 (mode), QString::fromUtf8 (message)
-                                          , low_confidence, off_air);
-                  }
-              }
+              parse_decode (client_key, in);
               break;
 
             case NetworkMessage::WSPRDecode:
+              parse_WSPR_decode (client_key, in);
+              break;
+
+            case NetworkMessage::DecodeBatch:
               {
-                // unpack message
-                bool is_new {true};
-                QTime time;
-                qint32 snr;
-                float delta_time;
-                Frequency frequency;
-                qint32 drift;
-                QByteArray callsign;
-                QByteArray grid;
-                qint32 power;
-                bool off_air {false};
-                in >> is_new >> time >> snr >> delta_time >> frequency >> drift >> callsign >> grid >> power
-                   >> off_air;
-                if (check_status (in) != Fail)
+                quint32 count {0};
+                in >> count;
+                for (quint32 i = 0; i < count && OK == check_status (in); ++i)
                   {
-                    Q_EMIT self_->WSPR_decode (is_new, client_key, time, snr, delta_time, frequency, drift
-                                               , QString::fromUtf8 (callsign), QString::fromUtf8 (grid)
-                                               , power, off_air);
+                    quint32 type {NetworkMessage::maximum_message_type_};
+                    QByteArray fields;
+                    in >> type >> fields;
+                    if (OK == check_status (in))
+                      {
+                        QDataStream entry {fields};
+                        entry.setVersion (in.version ());
+                        switch (type)
+                          {
+                          case NetworkMessage::Decode:
+                            parse_decode (client_key, entry);
+                            break;
+
+                          case NetworkMessage::WSPRDecode:
+                            parse_WSPR_decode (client_key, entry);
+                            break;
+
+                          default:
+                            // Ignore
+                            break;
+                          }
+                      }
                   }
               }
               break;
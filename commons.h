@@ -4,6 +4,7 @@
 #define NSMAX 6827
 #define NTMAX 30*60
 #define RX_SAMPLE_RATE 12000
+#define NDECREC 1024
 
 #ifdef __cplusplus
 #include <cstdbool>
@@ -67,6 +68,36 @@ typedef struct dec_data {
   } params;
 } dec_data_t;
 
+  /*
+   * Decodes passed from jt9 as fixed size records in a ring that
+   * follows struct dec_data in shared memory, used when jt9 is started
+   * with --decode-records. It MUST be kept in sync with
+   * lib/decode_records.f90
+   */
+#define DECODE_RECORD_MESSAGE 1  // a decoded message
+#define DECODE_RECORD_FINISHED 2 // end of a decoding pass
+
+typedef struct decode_record {
+  int   kind;                   // DECODE_RECORD_MESSAGE or DECODE_RECORD_FINISHED
+  int   nutc;                   // -1 if only the text is known
+  int   snr;
+  float dt;
+  float freq;
+  int   nap;                    // AP type, 0 for none
+  float qual;                   // decoder quality, -1 if none
+  int   navg;                   // transmissions averaged, 0 for none
+  float w50;                    // FST4 spread (Hz), -1 if none
+  int   nsynced;                // DECODE_RECORD_FINISHED only
+  int   ndecoded;               // DECODE_RECORD_FINISHED only
+  int   navg0;                  // DECODE_RECORD_FINISHED only
+  char  line[80];               // text as jt9 writes it to stdout, blank padded
+} decode_record_t;
+
+typedef struct decode_records {
+  int   nwritten;               // records written since the segment was created
+  struct decode_record rec[NDECREC];
+} decode_records_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
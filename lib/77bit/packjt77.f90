@@ -1,18 +1,29 @@
 module packjt77
 
 ! These variables are accessible from outside via "use packjt77":
-  parameter (MAXHASH=1000,MAXRECENT=10)
+  parameter (MAXHASH=20000,MAXRECENT=10)
   character (len=13), dimension(0:1023) ::  calls10=''
   character (len=13), dimension(0:4095) ::  calls12=''
-  character (len=13), dimension(1:MAXHASH) :: calls22=''
   character (len=13), dimension(1:MAXRECENT) :: recent_calls=''
   character (len=13) :: mycall13=''
   character (len=13) :: dxcall13=''
   character (len=6)  :: dxbase=''
-  integer, dimension(1:MAXHASH) :: ihash22=-1
   integer :: nzhash=0
   integer n28a,n28b
 
+! Callsigns by 22-bit hash. Entries are found through a chained hash on
+! the low bits of n22 and kept on a most recently used list; when the
+! table is full the least recently used entry is replaced.
+  integer, private :: maxhash22=MAXHASH         !Capacity, see hash22_capacity
+  integer, private :: nbucket22=0               !Power of two, 0 until allocated
+  character (len=13), allocatable, private :: calls22(:)
+  integer, allocatable, private :: ihash22(:)
+  integer, allocatable, private :: mru_prev(:),mru_next(:),chain22(:),bucket22(:)
+  integer, private :: mru_head=0,mru_tail=0
+  integer, private :: lu_hash22=0               !hash22_open's file if not 0
+
+  private hash22_alloc,hash22_find,hash22_unlink,hash22_push,hash22_store
+
   contains
 
 subroutine hash10(n10,c13)
@@ -49,17 +60,184 @@ subroutine hash22(n22,c13)
   character*13 c13
   
   c13='<...>'
-  do i=1,nzhash
-     if(ihash22(i).eq.n22) then
-        c13=calls22(i)
-        c13='<'//trim(c13)//'>'
-        go to 900
-     endif
-  enddo
+  !$omp critical(hash22_table)
+  i=hash22_find(n22)
+  if(i.gt.0) c13='<'//trim(calls22(i))//'>'
+  !$omp end critical(hash22_table)
 
-900 return
+  return
 end subroutine hash22
 
+subroutine hash22_capacity(n)
+
+! Set the number of 22-bit hashes remembered, emptying the table. Call
+! before hash22_open.
+  
+  !$omp critical(hash22_table)
+  maxhash22=max(n,16)
+  if(allocated(calls22)) deallocate(calls22,ihash22,mru_prev,mru_next,      &
+       chain22,bucket22)
+  nbucket22=0
+  !$omp end critical(hash22_table)
+
+  return
+end subroutine hash22_capacity
+
+subroutine hash22_open(fname)
+
+! Load the 22-bit hash table saved in fname and append callsigns saved
+! from now on to it, one "n22 callsign" line each, oldest first. The
+! file is only rewritten, without the lines that have been superseded,
+! when most of it is stale.
+
+  character*(*) fname
+  character*13 cw
+  logical exists
+
+  !$omp critical(hash22_table)
+  if(lu_hash22.ne.0) close(lu_hash22)
+  lu_hash22=0
+  nlines=0
+  inquire(file=fname,exist=exists)
+  if(exists) then
+     open(newunit=lu,file=fname,status='old',action='read',err=20)
+     do
+        read(lu,1000,err=10,end=10) n22,cw
+1000    format(i7,1x,a13)
+        nlines=nlines+1
+        if(n22.ge.0 .and. len(trim(cw)).ge.3) call hash22_store(cw,n22,.false.)
+     enddo
+10   close(lu)
+  endif
+20 if(nlines.gt.2*nzhash+100) then
+     open(newunit=lu_hash22,file=fname,status='replace',action='write',err=30)
+     i=mru_tail
+     do while(i.gt.0)
+        write(lu_hash22,1010) ihash22(i),trim(calls22(i))
+1010    format(i7,1x,a)
+        i=mru_prev(i)
+     enddo
+  else
+     open(newunit=lu_hash22,file=fname,status='unknown',position='append',    &
+          action='write',err=30)
+  endif
+  flush(lu_hash22)
+  go to 40
+30 lu_hash22=0
+40 continue
+  !$omp end critical(hash22_table)
+
+  return
+end subroutine hash22_open
+
+subroutine hash22_alloc()
+
+  if(nbucket22.gt.0) return
+  nbucket22=1
+  do while(nbucket22.lt.2*maxhash22)
+     nbucket22=2*nbucket22
+  enddo
+  allocate(calls22(maxhash22),ihash22(maxhash22),mru_prev(maxhash22),      &
+       mru_next(maxhash22),chain22(maxhash22),bucket22(0:nbucket22-1))
+  calls22=''
+  ihash22=-1
+  bucket22=0
+  nzhash=0
+  mru_head=0
+  mru_tail=0
+
+  return
+end subroutine hash22_alloc
+
+integer function hash22_find(n22)
+
+  hash22_find=0
+  if(nbucket22.eq.0) return
+  i=bucket22(iand(n22,nbucket22-1))
+  do while(i.gt.0)
+     if(ihash22(i).eq.n22) exit
+     i=chain22(i)
+  enddo
+  hash22_find=i
+
+  return
+end function hash22_find
+
+subroutine hash22_unlink(i)
+
+! Take entry i off the most recently used list
+  if(mru_prev(i).gt.0) then
+     mru_next(mru_prev(i))=mru_next(i)
+  else
+     mru_head=mru_next(i)
+  endif
+  if(mru_next(i).gt.0) then
+     mru_prev(mru_next(i))=mru_prev(i)
+  else
+     mru_tail=mru_prev(i)
+  endif
+
+  return
+end subroutine hash22_unlink
+
+subroutine hash22_push(i)
+
+! Put entry i at the head of the most recently used list
+  mru_prev(i)=0
+  mru_next(i)=mru_head
+  if(mru_head.gt.0) mru_prev(mru_head)=i
+  mru_head=i
+  if(mru_tail.eq.0) mru_tail=i
+
+  return
+end subroutine hash22_push
+
+subroutine hash22_store(cw,n22,lappend)
+
+! Make cw the most recently used callsign, and the one for n22. Caller
+! holds critical(hash22_table).
+  character*13 cw
+  logical lappend,lnew
+
+  call hash22_alloc()
+  i=hash22_find(n22)
+  lnew=i.eq.0
+  if(i.gt.0) then
+     lnew=calls22(i).ne.cw
+     call hash22_unlink(i)
+  else
+     if(nzhash.lt.maxhash22) then
+        nzhash=nzhash+1
+        i=nzhash
+     else
+        i=mru_tail                       !Replace the least recently used
+        call hash22_unlink(i)
+        ib=iand(ihash22(i),nbucket22-1)
+        if(bucket22(ib).eq.i) then
+           bucket22(ib)=chain22(i)
+        else
+           j=bucket22(ib)
+           do while(chain22(j).ne.i)
+              j=chain22(j)
+           enddo
+           chain22(j)=chain22(i)
+        endif
+     endif
+     ihash22(i)=n22
+     ib=iand(n22,nbucket22-1)
+     chain22(i)=bucket22(ib)
+     bucket22(ib)=i
+  endif
+  calls22(i)=cw
+  call hash22_push(i)
+  if(lappend .and. lnew .and. lu_hash22.ne.0) then
+     write(lu_hash22,'(i7,1x,a)') n22,trim(cw)
+     flush(lu_hash22)
+  endif
+
+  return
+end subroutine hash22_store
+
 
 integer function ihashcall(c0,m)
 
@@ -97,20 +275,10 @@ subroutine save_hash_call(c13,n10,n12,n22)
   if(n12.ge.0 .and. n12 .le. 4095 .and. cw.ne.mycall13) calls12(n12)=cw
 
   n22=ihashcall(cw,22)
-  if(any(ihash22.eq.n22)) then   ! If entry exists, make sure callsign is the most recently received one 
-    where(ihash22.eq.n22) calls22=cw
-    go to 900
-  endif
-
-! New entry: move table down, making room for new one at the top
-  ihash22(MAXHASH:2:-1)=ihash22(MAXHASH-1:1:-1)
+  !$omp critical(hash22_table)
+  call hash22_store(cw,n22,.true.)
+  !$omp end critical(hash22_table)
 
-! Add the new entry
-  calls22(MAXHASH:2:-1)=calls22(MAXHASH-1:1:-1)
-  ihash22(1)=n22
-  calls22(1)=cw
-  if(nzhash.lt.MAXHASH) nzhash=nzhash+1
-900 continue
   return 
 end subroutine save_hash_call
 
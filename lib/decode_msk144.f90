@@ -1,4 +1,5 @@
 subroutine decode_msk144(audio_samples, params, data_dir)
+  use decode_records, only: decode_out, decode_finished
   include 'jt9com.f90'
 
   ! constants
@@ -43,15 +44,14 @@ subroutine decode_msk144(audio_samples, params, data_dir)
 
     if (line(1:1) .ne. char(0)) then
       line = line(1:index(line, char(0))-1)
-      write(*, 1001) line
-      1001 format(a80)
+      ! only the text, the GUI parses it
+      call decode_out(line, -1, 0, 0.0, 0.0, 0, -1.0, 0, -1.0)
       message_count = message_count + 1;
     end if
   end do
 
   if (.not. params%ndiskdat) then
-    write(*, 1002) 0, message_count, 0
-    1002 format('<DecodeFinished>', 2i4, i9)
+    call decode_finished(0, message_count, 0)
   end if
 
 end subroutine decode_msk144
\ No newline at end of file
@@ -0,0 +1,123 @@
+module decode_records
+
+! Decodes as fixed size records in a ring that follows the dec_data
+! block in shared memory.  When jt9 is started with --decode-records
+! the GUI reads them instead of parsing the text written to stdout; an
+! empty line on stdout tells it that new records are waiting.  The
+! stand-alone jt9 writes text as before.
+!
+! These structures must be kept in sync with ../commons.h
+
+  use, intrinsic :: iso_c_binding, only: c_int, c_float, c_char, c_ptr,  &
+       c_associated, c_f_pointer
+
+  integer, parameter :: NDECREC=1024          !Records in the ring
+  integer, parameter :: KIND_MESSAGE=1        !A decoded message
+  integer, parameter :: KIND_FINISHED=2       !End of a decoding pass
+
+  type, bind(C) :: decode_record
+     integer(c_int) :: kind
+     integer(c_int) :: nutc
+     integer(c_int) :: snr
+     real(c_float) :: dt
+     real(c_float) :: freq
+     integer(c_int) :: nap                    !AP type, 0 for none
+     real(c_float) :: qual                    !Decoder quality, -1 if none
+     integer(c_int) :: navg                   !Transmissions averaged, 0 for none
+     real(c_float) :: w50                     !FST4 spread (Hz), -1 if none
+     integer(c_int) :: nsynced                !DECODE_FINISHED only
+     integer(c_int) :: ndecoded               !DECODE_FINISHED only
+     integer(c_int) :: navg0                  !DECODE_FINISHED only
+     character(kind=c_char) :: line(80)       !Text as written to stdout
+  end type decode_record
+
+  type, bind(C) :: decode_ring
+     integer(c_int) :: nwritten               !Records written since creation
+     type(decode_record) :: rec(NDECREC)
+  end type decode_ring
+
+  type(decode_ring), pointer, volatile :: ring => null()
+
+contains
+
+  subroutine decode_records_attach(p)
+    type(c_ptr), intent(in) :: p
+    if(c_associated(p)) call c_f_pointer(p,ring)
+  end subroutine decode_records_attach
+
+  subroutine decode_out(line,nutc,snr,dt,freq,nap,qual,navg,w50)
+
+! Send one decode to the GUI's ring, or write its text to stdout when
+! there is no ring; nutc is -1 when only the text is known
+
+    character(len=*), intent(in) :: line
+    integer, intent(in) :: nutc,snr,nap,navg
+    real, intent(in) :: dt,freq,qual,w50
+    integer i,j
+
+    if(.not.associated(ring)) then
+       write(*,'(a)') trim(line)
+       return
+    endif
+
+    !$omp critical(record_ring)
+    i=mod(ring%nwritten,NDECREC)+1
+    ring%rec(i)%kind=KIND_MESSAGE
+    ring%rec(i)%nutc=nutc
+    ring%rec(i)%snr=snr
+    ring%rec(i)%dt=dt
+    ring%rec(i)%freq=freq
+    ring%rec(i)%nap=nap
+    ring%rec(i)%qual=qual
+    ring%rec(i)%navg=navg
+    ring%rec(i)%w50=w50
+    ring%rec(i)%nsynced=0
+    ring%rec(i)%ndecoded=0
+    ring%rec(i)%navg0=0
+    do j=1,80
+       ring%rec(i)%line(j)=' '
+       if(j.le.len(line)) ring%rec(i)%line(j)=line(j:j)
+    enddo
+    ring%nwritten=ring%nwritten+1
+    write(*,'(a)') ''                        !Wake the GUI
+    !$omp end critical(record_ring)
+
+  end subroutine decode_out
+
+  subroutine decode_finished(nsynced,ndecoded,navg0)
+
+! Mark the end of a decoding pass
+
+    integer, intent(in) :: nsynced,ndecoded,navg0
+    integer i,j
+
+    if(.not.associated(ring)) then
+       write(*,1010) nsynced,ndecoded,navg0
+1010   format('<DecodeFinished>',2i4,i9)
+       return
+    endif
+
+    !$omp critical(record_ring)
+    i=mod(ring%nwritten,NDECREC)+1
+    ring%rec(i)%kind=KIND_FINISHED
+    ring%rec(i)%nutc=0
+    ring%rec(i)%snr=0
+    ring%rec(i)%dt=0.
+    ring%rec(i)%freq=0.
+    ring%rec(i)%nap=0
+    ring%rec(i)%qual=-1.
+    ring%rec(i)%navg=0
+    ring%rec(i)%w50=-1.
+    ring%rec(i)%nsynced=nsynced
+    ring%rec(i)%ndecoded=ndecoded
+    ring%rec(i)%navg0=navg0
+    do j=1,80
+       ring%rec(i)%line(j)=' '
+    enddo
+    ring%nwritten=ring%nwritten+1
+    write(*,'(a)') ''                        !Wake the GUI
+    !$omp end critical(record_ring)
+
+  end subroutine decode_finished
+
+end module decode_records
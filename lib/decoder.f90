@@ -10,6 +10,7 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
   use ft4_decode
   use fst4_decode
   use q65_decode
+  use decode_records, only: decode_out, decode_finished
 
   include 'jt9com.f90'
   include 'timer_common.inc'
@@ -325,6 +326,7 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
   newdat9=params%newdat
 
 !$call omp_set_dynamic(.true.)
+!$ call omp_set_max_active_levels(2)     !Let ftrsdap run its trials in parallel
 !$omp parallel sections num_threads(2) copyin(/timer_private/) shared(ndecoded) if(.true.) !iif() needed on Mac
 
 !$omp section
@@ -393,8 +395,7 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
   if(params%nmode.ne.8 .or. params%nzhsym.eq.50 .or.                     &
        .not.params%ndiskdat) then
 
-     write(*,1010) nsynced,ndecoded,navg0
-1010 format('<DecodeFinished>',2i4,i9)
+     call decode_finished(nsynced,ndecoded,navg0)
      call flush(6)
   endif
   close(13)
@@ -421,8 +422,13 @@ contains
 
     character*22 decoded
     character*3 cflags
+    character*80 line
+    integer navg
+    real q
 
     if(ich.eq.-99) stop                         !Silence compiler warning
+    navg=0
+    q=-1.0
     if (have_sync) then
        decoded=decoded0
        cflags='   '
@@ -433,18 +439,21 @@ contains
              write(cflags(2:2),'(i1)') min(int(qual),9)
              if(qual.ge.10.0) cflags(2:2)='*'
              if(qual.lt.3.0) decoded(22:22)='?'
+             q=qual
           endif
           if(is_average) then
              write(cflags(3:3),'(i1)') min(ave,9)
              if(ave.ge.10) cflags(3:3)='*'
              if(cflags(1:1).eq.'f') cflags=cflags(1:1)//cflags(3:3)//' '
+             navg=min(ave,10)
           endif
        endif
-       write(*,1000) params%nutc,snr,dt,freq,sync,decoded,cflags
+       write(line,1000) params%nutc,snr,dt,freq,sync,decoded,cflags
 1000   format(i4.4,i4,f5.1,i5,1x,'$',a1,1x,a22,1x,a3)
     else
-       write(*,1000) params%nutc,snr,dt,freq
+       write(line,1000) params%nutc,snr,dt,freq
     end if
+    call decode_out(line,params%nutc,snr,dt,float(freq),0,q,navg,-1.0)
 
     select type(this)
     type is (counting_jt4_decoder)
@@ -492,18 +501,23 @@ contains
     integer, intent(in) :: nsum
     integer, intent(in) :: minsync
 
-    integer i,nap
+    integer i,nap,navg
     logical is_deep,is_average
     character decoded*22,csync*2,cflags*3
+    character*80 line
+    real q
 
     if(width.eq.-9999.0) stop              !Silence compiler warning
 !$omp critical(decode_results)
     decoded=decoded0
     cflags='   '
     is_deep=ft.eq.2
+    nap=0
+    navg=0
+    q=-1.0
 
     if(ft.eq.0 .and. minsync.ge.0 .and. int(sync).lt.minsync) then
-       write(*,1010) params%nutc,snr,dt,freq
+       write(line,1010) params%nutc,snr,dt,freq
     else
        is_average=nsum.ge.2
        if(bVHF .and. ft.gt.0) then
@@ -513,10 +527,12 @@ contains
              write(cflags(2:2),'(i1)') min(qual,9)
              if(qual.ge.10) cflags(2:2)='*'
              if(qual.lt.3) decoded(22:22)='?'
+             q=qual
           endif
           if(is_average) then
              write(cflags(3:3),'(i1)') min(nsum,9)
              if(nsum.ge.10) cflags(3:3)='*'
+             navg=min(nsum,10)
           endif
           nap=ishft(ft,-2)
           if(nap.ne.0) then
@@ -546,9 +562,10 @@ contains
           cflags(2:2)=cflags(3:3)
           cflags(3:3)=' '
        endif
-       write(*,1010) params%nutc,snr,dt,freq,csync,decoded,cflags
+       write(line,1010) params%nutc,snr,dt,freq,csync,decoded,cflags
 1010   format(i4.4,i4,f5.1,i5,1x,a2,1x,a22,1x,a3)
     endif
+    call decode_out(line,params%nutc,snr,dt,float(freq),nap,q,navg,-1.0)
     if(ios13.eq.0) write(13,1012) params%nutc,nint(sync),snr,dt,    &
          float(freq),drift,decoded,ft,nsum,nsmo
 1012 format(i4.4,i4,i5,f6.2,f8.0,i4,3x,a22,' JT65',3i3)
@@ -572,10 +589,12 @@ contains
     real, intent(in) :: freq
     integer, intent(in) :: drift
     character(len=22), intent(in) :: decoded
+    character*80 line
 
     !$omp critical(decode_results)
-    write(*,1000) params%nutc,snr,dt,nint(freq),decoded
+    write(line,1000) params%nutc,snr,dt,nint(freq),decoded
 1000 format(i4.4,i4,f5.1,i5,1x,'@ ',1x,a22)
+    call decode_out(line,params%nutc,snr,dt,freq,0,-1.0,0,-1.0)
     if(ios13.eq.0) write(13,1002) params%nutc,nint(sync),snr,dt,freq,  &
          drift,decoded
 1002 format(i4.4,i4,i5,f6.1,f8.0,i4,3x,a22,' JT9')
@@ -603,6 +622,7 @@ contains
     real, intent(in) :: qual 
     character*2 annot
     character*37 decoded0
+    character*80 line
     logical isgrid4,first,b0,b1,b2
     data first/.true./
     save
@@ -637,10 +657,11 @@ contains
 ! to decide how many chars to print?
 !TEMP
     i0=1
-    if(i0.le.0) write(*,1000) params%nutc,snr,dt,nint(freq),decoded0(1:22),annot
+    if(i0.le.0) write(line,1000) params%nutc,snr,dt,nint(freq),decoded0(1:22),annot
+    if(i0.gt.0) write(line,1001) params%nutc,snr,dt,nint(freq),decoded0,annot
 1000 format(i6.6,i4,f5.1,i5,' ~ ',1x,a22,1x,a2)
-    if(i0.gt.0) write(*,1001) params%nutc,snr,dt,nint(freq),decoded0,annot
 1001 format(i6.6,i4,f5.1,i5,' ~ ',1x,a37,1x,a2)
+    call decode_out(line,params%nutc,snr,dt,freq,nap,qual,0,-1.0)
     if(ios13.eq.0) write(13,1002) params%nutc,nint(sync),snr,dt,freq,0,decoded0
 1002 format(i6.6,i4,i5,f6.1,f8.0,i4,3x,a37,' FT8')
 
@@ -702,6 +723,7 @@ contains
     real, intent(in) :: qual 
     character*2 annot
     character*37 decoded0
+    character*80 line
     
     decoded0=decoded
 
@@ -711,8 +733,9 @@ contains
        if(qual.lt.0.17) decoded0(37:37)='?'
     endif
 
-    write(*,1001) params%nutc,snr,dt,nint(freq),decoded0,annot
+    write(line,1001) params%nutc,snr,dt,nint(freq),decoded0,annot
 1001 format(i6.6,i4,f5.1,i5,' + ',1x,a37,1x,a2)
+    call decode_out(line,params%nutc,snr,dt,freq,nap,qual,0,-1.0)
 
     if(ios13.eq.0) then
        write(13,1002,err=10) params%nutc,nint(sync),snr,dt,freq,0,decoded0
@@ -752,6 +775,7 @@ contains
     character*2 annot
     character*37 decoded0
     character*70 line
+    real spread
 
     decoded0=decoded
     annot='  '
@@ -772,13 +796,14 @@ contains
 1004   format(i4.4,i4,i5,f6.1,f8.0,i4,3x,a37,' FST4')
     endif
 
+    spread=-1.0
     if(fmid.ne.-999.0) then
        if(w50.lt.0.95) write(line(65:70),'(f6.3)') w50
        if(w50.ge.0.95) write(line(65:70),'(f6.2)') w50
+       spread=w50
     endif
 
-    write(*,1005) line
-1005 format(a70)
+    call decode_out(line,nutc,nsnr,dt,freq,nap,qual,0,spread)
 
     call flush(6)
     if(ios13.eq.0) call flush(13)
@@ -808,6 +833,8 @@ contains
     integer, intent(in) :: nused
     integer, intent(in) :: ntrperiod
     character*3 cflags
+    character*80 line
+    integer navg
   
     cflags='   '
     if(idec.ge.0) then
@@ -817,17 +844,20 @@ contains
     endif
 
     if(ntrperiod.lt.60) then
-       write(*,1001) nutc,nsnr,dt,nint(freq),decoded,cflags
+       write(line,1001) nutc,nsnr,dt,nint(freq),decoded,cflags
 1001   format(i6.6,i4,f5.1,i5,' : ',1x,a37,1x,a3)
     if(ios13.eq.0) write(13,1002) nutc,nint(snr1),nsnr,dt,freq,0,decoded
 1002 format(i6.6,i4,i5,f6.1,f8.0,i4,3x,a37,' Q65')
     else
-       write(*,1003) nutc,nsnr,dt,nint(freq),decoded,cflags
+       write(line,1003) nutc,nsnr,dt,nint(freq),decoded,cflags
 1003   format(i4.4,i4,f5.1,i5,' : ',1x,a37,1x,a3)
        if(ios13.eq.0) write(13,1004) nutc,nint(snr1),nsnr,dt,freq,0,decoded
 1004   format(i4.4,i4,i5,f6.1,f8.0,i4,3x,a37,' Q65')
 
     endif
+    navg=0
+    if(idec.ge.0 .and. nused.ge.2) navg=min(nused,10)
+    call decode_out(line,nutc,nsnr,dt,freq,max(idec,0),-1.0,navg,-1.0)
     call flush(6)
     if(ios13.eq.0) call flush(13)
 
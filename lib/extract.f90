@@ -231,11 +231,7 @@ subroutine getpp(workdat,p)
 
   psum=0.
   do j=1,63
-     i=a(j)+1
-     x=s3a(i,j)
-     s3a(i,j)=0.
-     psum=psum + x
-     s3a(i,j)=x
+     psum=psum + s3a(a(j)+1,j)      !Read only: called from parallel trials
   enddo
   p=psum/63.0
 
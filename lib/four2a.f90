@@ -1,3 +1,36 @@
+module four2a_cache
+
+! Plans made by four2a are kept in a hash table keyed on (nfft, isign,
+! iform, alignment of a).  They are executed with FFTW's new-array
+! interface, so one plan serves every buffer with the same alignment.
+! Each thread keeps a private copy of the table that it searches
+! without locking; only a miss takes the shared table's critical
+! section.  Hit and miss counts are written to timer.out.
+
+  parameter (NHASH=8191)                 !Hash table size (prime)
+  parameter (NPMAX=6000)                 !Max number of stored plans
+  integer*8 :: gkey(0:NHASH-1)=0         !Keys of the shared table, 0=empty
+  integer*8 :: gplan(0:NHASH-1)          !Plans of the shared table
+  integer*8 :: tkey(0:NHASH-1)=0         !Per-thread copy of the table
+  integer*8 :: tplan(0:NHASH-1)
+  integer :: ngen=0                      !Bumped when all plans are destroyed
+  integer :: tgen=0                      !Generation of the per-thread copy
+  integer :: nplan=0                     !Number of stored plans
+  integer*8 :: nhits=0,nmisses=0         !Lookups found/not found per thread
+  !$omp threadprivate(tkey,tplan,tgen)
+
+contains
+
+  integer function hash_slot(key,keys)
+    integer*8 key,keys(0:NHASH-1)
+    hash_slot=int(mod(key,int(NHASH,8)))
+    do while(keys(hash_slot).ne.0 .and. keys(hash_slot).ne.key)
+       hash_slot=mod(hash_slot+1,NHASH)             !Linear probing
+    enddo
+  end function hash_slot
+
+end module four2a_cache
+
 subroutine four2a(a,nfft,ndim,isign,iform)
 
 ! IFORM = 1, 0 or -1, as data is
@@ -9,106 +42,120 @@ subroutine four2a(a,nfft,ndim,isign,iform)
 ! by ... will be returned in the same array, now considered to
 ! be complex of dimensions N(1)/2+1 by N(2) by ....  Note that if
 ! IFORM = 0 or -1, N(1) must be even, and enough room must be
-! reserved.  The missing values may be obtained by complex conjugation.  
+! reserved.  The missing values may be obtained by complex conjugation.
 
 ! The reverse transformation of a half complex array dimensioned
 ! N(1)/2+1 by N(2) by ..., is accomplished by setting IFORM
 ! to -1.  In the N array, N(1) must be the true N(1), not N(1)/2+1.
 ! The transform will be real and returned to the input array.
 
-! This version of four2a makes calls to the FFTW library to do the 
+! This version of four2a makes calls to the FFTW library to do the
 ! actual computations.
 
   use fftw3
-  parameter (NPMAX=2100)                 !Max number of stored plans
+  use four2a_cache
   parameter (NSMALL=16385)               !Max half complex size of "small" FFTs
   complex a(nfft)                        !Array to be transformed
   complex aa(NSMALL)                     !Local copy of "small" a()
-  integer nn(NPMAX),ns(NPMAX),nf(NPMAX)  !Params of stored plans 
-  integer*8 nl(NPMAX),nloc               !More params of plans
-  integer*8 plan(NPMAX)                  !Pointers to stored plans
-  logical found_plan
-  data nplan/0/                          !Number of stored plans
+  integer*8 key                          !Params of the plan
+  integer*8 plan                         !Pointer to the plan
+  integer ngen0
   common/patience/npatience,nthreads     !Patience and threads for FFTW plans
-  save plan,nplan,nn,ns,nf,nl
 
   if(nfft.lt.0) go to 999
 
-  nloc=loc(a)
-
-  found_plan = .false.
-  !$omp critical(four2a_setup)
-  do i=1,nplan
-     if(nfft.eq.nn(i) .and. isign.eq.ns(i) .and.                     &
-          iform.eq.nf(i) .and. nloc.eq.nl(i)) then
-        found_plan = .true.
-        exit
-     end if
-  enddo
-
-  if(i.ge.NPMAX) stop 'Too many FFTW plans requested.'
-
-  if (.not. found_plan) then
-     nplan=nplan+1
-     i=nplan
+! The plan depends on the alignment of a() but not on its address.
+! Keying on loc(a) mod 64 covers any SIMD alignment FFTW may use.
+  key=iand(int(loc(a),8),63_8) + 64*((iform+1) + 4*((isign+1) + 4*int(nfft,8)))
+
+  !$omp atomic read
+  ngen0=ngen
+  if(tgen.ne.ngen0) then                 !Plans were destroyed, start afresh
+     tkey=0
+     tgen=ngen0
+  endif
+
+  i=hash_slot(key,tkey)
+  if(tkey(i).eq.key) then
+     plan=tplan(i)
+     !$omp atomic update
+     nhits=nhits+1
+  else
+     !$omp critical(four2a_setup)
+     j=hash_slot(key,gkey)
+     if(gkey(j).ne.key) then
+        if(nplan.ge.NPMAX) stop 'Too many FFTW plans requested.'
+
+! Planning: FFTW_ESTIMATE, FFTW_ESTIMATE_PATIENT, FFTW_MEASURE,
+!            FFTW_PATIENT,  FFTW_EXHAUSTIVE
+        nflags=FFTW_ESTIMATE
+        if(npatience.eq.1) nflags=FFTW_ESTIMATE_PATIENT
+        if(npatience.eq.2) nflags=FFTW_MEASURE
+        if(npatience.eq.3) nflags=FFTW_PATIENT
+        if(npatience.eq.4) nflags=FFTW_EXHAUSTIVE
+
+        if(nfft.le.NSMALL) then
+           jz=nfft
+           if(iform.le.0) jz=nfft/2+1
+           aa(1:jz)=a(1:jz)
+        endif
 
-     nn(i)=nfft
-     ns(i)=isign
-     nf(i)=iform
-     nl(i)=nloc
+        !$omp critical(fftw) ! serialize non thread-safe FFTW3 calls
+        if(isign.eq.-1 .and. iform.eq.1) then
+           call sfftw_plan_dft_1d(gplan(j),nfft,a,a,FFTW_FORWARD,nflags)
+        else if(isign.eq.1 .and. iform.eq.1) then
+           call sfftw_plan_dft_1d(gplan(j),nfft,a,a,FFTW_BACKWARD,nflags)
+        else if(isign.eq.-1 .and. iform.eq.0) then
+           call sfftw_plan_dft_r2c_1d(gplan(j),nfft,a,a,nflags)
+        else if(isign.eq.1 .and. iform.eq.-1) then
+           call sfftw_plan_dft_c2r_1d(gplan(j),nfft,a,a,nflags)
+        else
+           stop 'Unsupported request in four2a'
+        endif
+        !$omp end critical(fftw)
 
-! Planning: FFTW_ESTIMATE, FFTW_ESTIMATE_PATIENT, FFTW_MEASURE, 
-!            FFTW_PATIENT,  FFTW_EXHAUSTIVE
-     nflags=FFTW_ESTIMATE
-     if(npatience.eq.1) nflags=FFTW_ESTIMATE_PATIENT
-     if(npatience.eq.2) nflags=FFTW_MEASURE
-     if(npatience.eq.3) nflags=FFTW_PATIENT
-     if(npatience.eq.4) nflags=FFTW_EXHAUSTIVE
-
-     if(nfft.le.NSMALL) then
-        jz=nfft
-        if(iform.le.0) jz=nfft/2+1
-        aa(1:jz)=a(1:jz)
-     endif
-
-     !$omp critical(fftw) ! serialize non thread-safe FFTW3 calls
-     if(isign.eq.-1 .and. iform.eq.1) then
-        call sfftw_plan_dft_1d(plan(i),nfft,a,a,FFTW_FORWARD,nflags)
-     else if(isign.eq.1 .and. iform.eq.1) then
-        call sfftw_plan_dft_1d(plan(i),nfft,a,a,FFTW_BACKWARD,nflags)
-     else if(isign.eq.-1 .and. iform.eq.0) then
-        call sfftw_plan_dft_r2c_1d(plan(i),nfft,a,a,nflags)
-     else if(isign.eq.1 .and. iform.eq.-1) then
-        call sfftw_plan_dft_c2r_1d(plan(i),nfft,a,a,nflags)
-     else
-        stop 'Unsupported request in four2a'
-     endif
-     !$omp end critical(fftw)
-
-     if(nfft.le.NSMALL) then
-        jz=nfft
-        if(iform.le.0) jz=nfft/2+1
-        a(1:jz)=aa(1:jz)
-     endif
+        if(nfft.le.NSMALL) then
+           jz=nfft
+           if(iform.le.0) jz=nfft/2+1
+           a(1:jz)=aa(1:jz)
+        endif
+        gkey(j)=key
+        nplan=nplan+1
+     end if
+     plan=gplan(j)
+     !$omp end critical(four2a_setup)
+     tkey(i)=key
+     tplan(i)=plan
+     !$omp atomic update
+     nmisses=nmisses+1
   end if
-  !$omp end critical(four2a_setup)
 
-  call sfftw_execute(plan(i))
+! New-array execute: the plan may have been made for another buffer
+  if(iform.eq.1) then
+     call sfftw_execute_dft(plan,a,a)
+  else if(iform.eq.0) then
+     call sfftw_execute_dft_r2c(plan,a,a)
+  else
+     call sfftw_execute_dft_c2r(plan,a,a)
+  endif
   return
 
 999 continue
 
-  !$omp critical(four2a)
-  do i=1,nplan
-! The test is only to silence a compiler warning:
-     if(ndim.ne.-999) then
+  !$omp critical(four2a_setup)
+  do j=0,NHASH-1
+! The test on ndim is only to silence a compiler warning:
+     if(gkey(j).ne.0 .and. ndim.ne.-999) then
         !$omp critical(fftw) ! serialize non thread-safe FFTW3 calls
-        call sfftw_destroy_plan(plan(i))
+        call sfftw_destroy_plan(gplan(j))
         !$omp end critical(fftw)
      end if
   enddo
+  gkey=0
   nplan=0
-  !$omp end critical(four2a)
+  !$omp atomic update
+  ngen=ngen+1
+  !$omp end critical(four2a_setup)
 
   return
 end subroutine four2a
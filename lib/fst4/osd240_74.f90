@@ -333,6 +333,7 @@ subroutine boxit74(reset,e2,ntau,npindex,i1,i2)
    integer   indexes(5000,2),fp(0:525000),np(5000)
    logical reset
    common/boxes/indexes,fp,np
+   !$omp threadprivate(/boxes/)
 
    if(reset) then
       patterns=-1
@@ -370,7 +371,9 @@ subroutine fetchit74(reset,e2,ntau,i1,i2)
    integer*1 e2(ntau)
    logical reset
    common/boxes/indexes,fp,np
+   !$omp threadprivate(/boxes/)
    save lastpat,inext
+   !$omp threadprivate(lastpat,inext)
 
    if(reset) then
       lastpat=-1
@@ -17,6 +17,7 @@ program ft4sim_mult
   integer itone(NN)
   integer*1 msgbits(77)
   integer*2 iwave(NZZ)                  !Generated full-length waveform
+  integer, allocatable :: iseed(:)
   
 ! Get command-line argument(s)
   nargs=iargc()
@@ -39,6 +40,12 @@ program ft4sim_mult
   txt=NZ*dt                       !Transmission length (s) without ramp up/down
   bandwidth_ratio=2500.0/(fs/2.0)
   txt=NN*NSPS/12000.0
+! Fixed seed for the random DTs, gfortran otherwise seeds differently
+! on every run
+  call random_seed(size=nseed)
+  allocate(iseed(nseed))
+  iseed=12345
+  call random_seed(put=iseed)
   open(10,file='messages.txt',status='old',err=998)
 
   do ifile=1,nfiles
@@ -35,7 +35,7 @@ subroutine foxgen()
   twopi=8.d0*atan(1.d0)
   irpt=0
   nplot=0
-  wave=0.
+  wave(1:NN*NSPS)=0.                 !Touch only what FT8 uses of wave()
 
   do n=1,nslots
      msg=cmsg(n)(1:37)
@@ -59,12 +59,12 @@ subroutine foxgen()
   enddo
   kz=k
   
-  peak1=maxval(abs(wave))
-  wave=wave/peak1
+  peak1=maxval(abs(wave(1:kz)))
+  wave(1:kz)=wave(1:kz)/peak1
   width=50.0
   call foxfilt(nslots,nfreq,width,wave)
-  peak3=maxval(abs(wave))
-  wave=wave/peak3
+  peak3=maxval(abs(wave(1:kz)))
+  wave(1:kz)=wave(1:kz)/peak3
   
   return
 end subroutine foxgen
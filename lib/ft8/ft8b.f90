@@ -48,6 +48,7 @@ subroutine ft8b(dd0,newdat,nQSOProgress,nfqso,nftx,ndepth,nzhsym,lapon,     &
   data graymap/0,1,3,2,5,6,4,7/
   save nappasses,naptypes,ncontest0,one
 
+  !$omp critical(ft8b_init) ! ft8_decode may run several ft8b calls at once
   if(first.or.(ncontest.ne.ncontest0)) then
      mcq=2*mcq-1
      mcqfd=2*mcqfd-1
@@ -89,9 +90,7 @@ subroutine ft8b(dd0,newdat,nQSOProgress,nfqso,nftx,ndepth,nzhsym,lapon,     &
      first=.false.
      ncontest0=ncontest
   endif
-
-  dxcall13=hiscall12  ! initialize for use in packjt77
-  mycall13=mycall12
+  !$omp end critical(ft8b_init)
 
   max_iterations=30
   nharderrors=-1
@@ -426,7 +425,11 @@ subroutine ft8b(dd0,newdat,nQSOProgress,nfqso,nftx,ndepth,nzhsym,lapon,     &
      read(c77(75:77),'(b3)') i3
      if(i3.gt.5 .or. (i3.eq.0.and.n3.gt.6)) cycle
      if(i3.eq.0 .and. n3.eq.2) cycle
+     !$omp critical(packjt77) ! the callsign hash tables are shared
+     dxcall13=hiscall12  ! initialize for use in packjt77
+     mycall13=mycall12
      call unpack77(c77,1,msg37,unpk77_success)
+     !$omp end critical(packjt77)
      if(.not.unpk77_success) cycle
      nbadcrc=0  ! If we get this far: valid codeword, valid (i3,n3), nonquirky message.
      call get_ft8_tones_from_77bits(message77,itone)
@@ -0,0 +1,96 @@
+program ft8sim_mult
+
+! Generate simulated crowded-band FT8 files from a list of signals.
+! Same messages.txt format as ft4sim_mult, except that DT and the
+! audio frequency are used as given.  No seed is set, so the noise and
+! hence the files are the same on every run.
+
+  use wavhdr
+  use packjt77
+  include 'ft8_params.f90'               !FT8 protocol constants
+  parameter (NWAVE=NN*NSPS)
+  type(hdr) h                            !Header for .wav file
+  character arg*12,fname*17,cjunk*4
+  character msg37*37,msgsent37*37,c77*77
+  complex cwave0(NWAVE)
+  real wave0(NWAVE)
+  real wave(NMAX)
+  real tmp(NMAX)
+  integer itone(NN)
+  integer*1 msgbits(77)
+  integer*2 iwave(NMAX)                  !Generated full-length waveform
+
+! Get command-line argument(s)
+  nargs=iargc()
+  if(nargs.ne.2) then
+     print*,'Usage:    ft8sim_mult nsigs nfiles'
+     print*,'Example:  ft8sim_mult  20     8 '
+     go to 999
+  endif
+  call getarg(1,arg)
+  read(arg,*) nsigs               !Number of signals
+  call getarg(2,arg)
+  read(arg,*) nfiles              !Number of files
+
+  fs=12000.0                      !Sample rate (Hz)
+  dt=1.0/fs                       !Sample interval (s)
+  bt=2.0                          !Gaussian smoothing
+  bandwidth_ratio=2500.0/(fs/2.0)
+  open(10,file='messages.txt',status='old',err=998)
+
+  do ifile=1,nfiles
+1    read(10,1001,end=999) cjunk,n
+1001 format(a4,i2)
+     if(cjunk.ne.'File' .or. n.ne.ifile) go to 1
+     wave=0.
+     write(fname,1002) ifile
+1002 format('000000_',i6.6,'.wav')
+
+     do isig=1,nsigs
+        read(10,1003,end=100) cjunk,isnr,xdt,ifreq,msg37
+1003    format(a4,30x,i3,f5.1,i5,1x,a37)
+        if(cjunk.eq.'File') go to 100
+        f0=ifreq
+! Source-encode, then get itone()
+        i3=-1
+        n3=-1
+        call pack77(msg37,i3,n3,c77)
+        call genft8(msg37,i3,n3,msgsent37,msgbits,itone)
+        icmplx=0
+        call gen_ft8wave(itone,NN,NSPS,bt,fs,f0,cwave0,wave0,icmplx,NWAVE)
+
+        k0=nint((xdt+0.5)/dt)
+        if(k0.lt.1) k0=1
+        k1=min(k0+NWAVE-1,NMAX)
+        tmp=0.0
+        tmp(k0:k1)=wave0(1:k1-k0+1)
+
+! Insert this signal into wave() array
+        sig=sqrt(2*bandwidth_ratio) * 10.0**(0.05*isnr)
+        wave=wave + sig*tmp
+        write(*,1100) fname(1:13),isig,isnr,xdt,nint(f0),msgsent37
+1100    format(a13,i4,i5,f5.1,i6,2x,a37)
+     enddo   ! isig
+
+100  backspace 10
+
+     do i=1,NMAX                  !Add gaussian noise at specified SNR
+        xnoise=gran()
+        wave(i)=wave(i) + xnoise
+     enddo
+
+     gain=30.0
+     wave=gain*wave
+     if(any(abs(wave).gt.32767.0)) print*,"Warning - data will be clipped."
+     iwave=nint(wave)
+     h=default_header(12000,NMAX)
+     open(12,file=fname,status='unknown',access='stream')
+     write(12) h,iwave                !Save to *.wav file
+     close(12)
+     print*,' '
+  enddo      ! ifile
+  go to 999
+
+998 print*,'Cannot open file "messages.txt"'
+
+999 end program ft8sim_mult
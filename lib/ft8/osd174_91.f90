@@ -34,6 +34,7 @@ subroutine osd174_91(llr,k,apmask,ndeep,message91,cw,nhardmin,dmin)
    allocate( temp(k), m0(k), me(k), mi(k), misub(k), e2sub(N-k), e2(N-k), ui(N-k) )
    allocate( r2pat(N-k), decoded(k) )
 
+   !$omp critical(osd174_91_init) ! candidates may be decoded in parallel
    if( first ) then ! fill the generator matrix
 !
 ! Create generator matrix for partial CRC cascaded with LDPC code.
@@ -63,6 +64,7 @@ subroutine osd174_91(llr,k,apmask,ndeep,message91,cw,nhardmin,dmin)
 
       first=.false.
    endif
+   !$omp end critical(osd174_91_init)
 
    rx=llr
    apmaskr=apmask
@@ -338,6 +340,7 @@ subroutine boxit91(reset,e2,ntau,npindex,i1,i2)
    integer   indexes(5000,2),fp(0:525000),np(5000)
    logical reset
    common/boxes/indexes,fp,np
+   !$omp threadprivate(/boxes/)
 
    if(reset) then
       patterns=-1
@@ -375,7 +378,9 @@ subroutine fetchit91(reset,e2,ntau,i1,i2)
    integer*1 e2(ntau)
    logical reset
    common/boxes/indexes,fp,np
+   !$omp threadprivate(/boxes/)
    save lastpat,inext
+   !$omp threadprivate(lastpat,inext)
 
    if(reset) then
       lastpat=-1
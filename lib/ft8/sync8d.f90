@@ -17,6 +17,7 @@ subroutine sync8d(cd0,i0,ctwk,itwk,sync)
   p(z1)=real(z1)**2 + aimag(z1)**2          !Statement function for power
 
 ! Set some constants and compute the csync array.  
+  !$omp critical(sync8d_init)
   if( first ) then
     twopi=8.0*atan(1.0)
     do i=0,6
@@ -29,6 +30,7 @@ subroutine sync8d(cd0,i0,ctwk,itwk,sync)
     enddo
     first=.false.
   endif
+  !$omp end critical(sync8d_init)
 
   sync=0
   do i=0,6                              !Sum over 7 Costas frequencies and
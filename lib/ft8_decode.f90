@@ -38,9 +38,11 @@ contains
     use iso_c_binding, only: c_bool, c_int
     use timer_module, only: timer
     use shmem, only: shmem_lock, shmem_unlock
+    use prog_args, only: ndecthreads
     use ft8_a7
 
     include 'ft8/ft8_params.f90'
+    include 'timer_common.inc'
 
     class(ft8_decoder), intent(inout) :: this
     procedure(ft8_decode_callback) :: callback
@@ -49,8 +51,9 @@ contains
     real sbase(NH1)
     real candidate(3,MAXCAND)
     real dd(15*12000),dd1(15*12000)
+    complex cd0(0:3199)
     logical, intent(in) :: lft8apon,lapcqonly,nagain
-    logical newdat,lsubtract,ldupe,lrefinedt
+    logical newdat,newdat1,lsubtract,ldupe,lrefinedt,lbail,lbail1
     logical*1 ldiskdat
     logical lsubtracted(MAX_EARLY)
     character*12 mycall12,hiscall12,call_1,call_2
@@ -65,6 +68,12 @@ contains
     integer itone_save(NN,MAX_EARLY)
     real f1_save(MAX_EARLY)
     real xdt_save(MAX_EARLY)
+! Per-candidate results, filled in by the (possibly parallel) ft8b loop
+    logical ldone_cand(MAXCAND)
+    integer nbadcrc_cand(MAXCAND),nharderrors_cand(MAXCAND),iaptype_cand(MAXCAND)
+    integer itone_cand(NN,MAXCAND)
+    real f1_cand(MAXCAND),xdt_cand(MAXCAND),xsnr_cand(MAXCAND),dmin_cand(MAXCAND)
+    character*37 msg37_cand(MAXCAND)
     data nutc0/-1/
 
     save dd,dd1,nutc0,ndec_early,itone_save,f1_save,xdt_save,lsubtracted,  &
@@ -171,6 +180,7 @@ contains
 ! ndepth=3: subtraction, 3 passes, bp+osd
     npass=3
     if(ndepth.eq.1) npass=2
+    nthr=max(1,ndecthreads)
     do ipass=1,npass
       newdat=.true.
       syncmin=1.3
@@ -194,45 +204,99 @@ contains
       maxc=MAXCAND
       call sync8(dd,ifa,ifb,syncmin,nfqso,maxc,candidate,ncand,sbase)
       call timer('sync8   ',1)
+! Candidates are decoded independently, possibly by several threads.
+! ft8b only reads dd and the long FFT, which is computed once here, so
+! the subtraction of decoded signals is deferred to the end of the pass
+! and the results are merged in candidate order.  The output does not
+! depend on the number of threads.
+      if(ncand.ge.1 .and. newdat) then
+         call timer('ft8_down',0)
+         call ft8_downsample(dd,newdat,candidate(1,1),cd0)
+         call timer('ft8_down',1)
+      endif
+      ldone_cand(1:ncand)=.false.
+      lbail=.false.
+      !$omp parallel do schedule(dynamic) num_threads(nthr) if(nthr.gt.1)    &
+      !$omp   default(shared) copyin(/timer_private/)                         &
+      !$omp   private(f1,xdt,xbase,msg37,newdat1,iaptype,nharderrors,dmin,    &
+      !$omp           nbadcrc,iappass,xsnr,itone,tsec,tseq,ctime,lbail1)
       do icand=1,ncand
-        sync=candidate(3,icand)
+        !$omp atomic read
+        lbail1=lbail
+        if(lbail1) cycle
         f1=candidate(1,icand)
         xdt=candidate(2,icand)
         xbase=10.0**(0.1*(sbase(nint(f1/3.125))-40.0))
         msg37='                                     '
+        newdat1=.false.
         call timer('ft8b    ',0)
-        call ft8b(dd,newdat,nQSOProgress,nfqso,nftx,ndeep,nzhsym,lft8apon,  &
-             lapcqonly,napwid,lsubtract,nagain,ncontest,iaptype,mycall12,   &
+        call ft8b(dd,newdat1,nQSOProgress,nfqso,nftx,ndeep,nzhsym,lft8apon, &
+             lapcqonly,napwid,.false.,nagain,ncontest,iaptype,mycall12,     &
              hiscall12,f1,xdt,xbase,apsym2,aph10,nharderrors,dmin,          &
              nbadcrc,iappass,msg37,xsnr,itone)
         call timer('ft8b    ',1)
-        nsnr=nint(xsnr)
-        xdt=xdt-0.5
-        hd=nharderrors+dmin
-        if(nbadcrc.eq.0) then
-           ldupe=.false.
-           do id=1,ndecodes
-              if(msg37.eq.allmessages(id)) ldupe=.true.
-           enddo
-           if(.not.ldupe) then
-              ndecodes=ndecodes+1
-              allmessages(ndecodes)=msg37
-              allsnrs(ndecodes)=nsnr
-              f1_save(ndecodes)=f1
-              xdt_save(ndecodes)=xdt+0.5
-              itone_save(1:NN,ndecodes)=itone
-           endif
-           if(.not.ldupe .and. associated(this%callback)) then
-              qual=1.0-(nharderrors+dmin)/60.0 ! scale qual to [0.0,1.0]
-              if(emedelay.ne.0) xdt=xdt+2.0
-              call this%callback(sync,nsnr,xdt,f1,msg37,iaptype,qual)
-              call ft8_a7_save(nutc,xdt,f1,msg37)  !Enter decode in table
+        nbadcrc_cand(icand)=nbadcrc
+        nharderrors_cand(icand)=nharderrors
+        iaptype_cand(icand)=iaptype
+        f1_cand(icand)=f1
+        xdt_cand(icand)=xdt
+        xsnr_cand(icand)=xsnr
+        dmin_cand(icand)=dmin
+        msg37_cand(icand)=msg37
+        if(nbadcrc.eq.0) itone_cand(1:NN,icand)=itone
+        ldone_cand(icand)=.true.
+        if(.not.ldiskdat .and. nzhsym.eq.41) then
+           call timestamp(tsec,tseq,ctime)
+           if(tseq.ge.13.4d0) then                     !Bail out before done
+              !$omp atomic write
+              lbail=.true.
            endif
         endif
-        call timestamp(tsec,tseq,ctime)
-        if(.not.ldiskdat .and. nzhsym.eq.41 .and.                        &
-             tseq.ge.13.4d0) go to 800                 !Bail out before done
       enddo  ! icand
+      !$omp end parallel do
+
+      do icand=1,ncand
+        if(.not.ldone_cand(icand)) cycle
+        if(nbadcrc_cand(icand).ne.0) cycle
+        sync=candidate(3,icand)
+        f1=f1_cand(icand)
+        msg37=msg37_cand(icand)
+        nharderrors=nharderrors_cand(icand)
+        dmin=dmin_cand(icand)
+        iaptype=iaptype_cand(icand)
+        nsnr=nint(xsnr_cand(icand))
+        xdt=xdt_cand(icand)-0.5
+        ldupe=.false.
+        do id=1,ndecodes
+           if(msg37.eq.allmessages(id)) ldupe=.true.
+        enddo
+        if(.not.ldupe) then
+           ndecodes=ndecodes+1
+           allmessages(ndecodes)=msg37
+           allsnrs(ndecodes)=nsnr
+           f1_save(ndecodes)=f1
+           xdt_save(ndecodes)=xdt+0.5
+           itone_save(1:NN,ndecodes)=itone_cand(1:NN,icand)
+        endif
+        if(.not.ldupe .and. associated(this%callback)) then
+           qual=1.0-(nharderrors+dmin)/60.0 ! scale qual to [0.0,1.0]
+           if(emedelay.ne.0) xdt=xdt+2.0
+           call this%callback(sync,nsnr,xdt,f1,msg37,iaptype,qual)
+           call ft8_a7_save(nutc,xdt,f1,msg37)  !Enter decode in table
+        endif
+      enddo  ! icand
+
+      if(lsubtract) then
+         call timer('sub_ft8a',0)
+         do icand=1,ncand
+            if(.not.ldone_cand(icand)) cycle
+            if(nbadcrc_cand(icand).ne.0) cycle
+            call subtractft8(dd,itone_cand(1,icand),f1_cand(icand),       &
+                 xdt_cand(icand),.false.)
+         enddo
+         call timer('sub_ft8a',1)
+      endif
+      if(lbail) go to 800
    enddo  ! ipass
 
 800 ndec_early=0
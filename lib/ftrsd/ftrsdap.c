@@ -19,11 +19,104 @@
 #include <unistd.h>
 #include <time.h>
 #include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "../ftrsd/rs2.h"
 
 static void *rs;
 void getpp_(int workdat[], float *pp);
 
+// Trials each thread is given per round
+#define NROUND 64
+
+// Outcome of one random erasure trial, numera<0 if it found no codeword
+struct trial {
+  int numera;
+  int nhard;
+  int nsoft;
+  float pp;
+  int workdat[63];
+};
+
+/*
+Advance the trial random number generator n steps. Trial k starts
+63*(k-1) steps from the seed, so any trial can be run on its own and
+draws exactly the numbers it would have drawn in sequence.
+*/
+static unsigned int skip_seed(unsigned int seed, unsigned long n)
+{
+  unsigned int a=1103515245, c=12345, an=1, cn=0;
+  while(n) {
+    if(n&1) {
+      an=a*an;
+      cn=a*cn+c;
+    }
+    c=(a+1)*c;
+    a=a*a;
+    n>>=1;
+  }
+  return an*seed+cn;
+}
+
+/*
+Run trial k. Only the syndrome left by the hard-decision attempt and
+getpp's read of the symbol spectra are shared, so trials may run
+concurrently.
+*/
+static void run_trial(int k, int rxdat[], int rxdat2[], int rxprob[],
+                      int indexes[], int thresh0[], int nsum, struct trial *t)
+{
+  int era_pos[51];
+  int i, j, numera, nerr, nn=63;
+  unsigned int nseed=skip_seed(1,63UL*(k-1));
+
+  memset(era_pos,0,51*sizeof(int));
+  memcpy(t->workdat,rxdat,63*sizeof(int));
+
+/* 
+Mark a subset of the symbols as erasures.
+Run through the ranked symbols, starting with the worst, i=0.
+NB: j is the symbol-vector index of the symbol with rank i.
+*/
+  numera=0;
+  for (i=0; i<nn; i++) {
+    j = indexes[62-i];
+    long int ir;
+
+// Generate a random number ir, 0 <= ir < 100 (see POSIX.1-2001 example).
+    nseed = nseed * 1103515245 + 12345;
+    ir = (unsigned)(nseed/65536) % 32768;
+    ir = (100*ir)/32768;
+
+    if((ir < thresh0[i] ) && numera < 51) {
+      era_pos[numera]=j;
+      numera=numera+1;
+    }
+  }
+
+  t->numera=-1;
+  nerr=decode_rs_int(rs,t->workdat,era_pos,numera,0);
+  if( nerr < 0 ) return;
+
+// We have a candidate codeword.  Find its hard and soft distance from
+// the received word.  Also find pp from the full array s3(64,63) of
+// synchronized symbol spectra.
+  t->numera=numera;
+  t->nhard=0;
+  t->nsoft=0;
+  for (i=0; i<63; i++) {
+    if(t->workdat[i] != rxdat[i]) {
+      t->nhard=t->nhard+1;
+      if(t->workdat[i] != rxdat2[i]) {
+        t->nsoft=t->nsoft+rxprob[i];
+      }
+    }
+  }
+  t->nsoft=63*t->nsoft/nsum;
+  getpp_(t->workdat,&t->pp);
+}
+
 void ftrsdap_(int mrsym[], int mrprob[], int mr2sym[], int mr2prob[], 
 	     int ap[], int* ntrials0, int correct[], int param[], int ntry[])
 {
@@ -37,7 +130,6 @@ void ftrsdap_(int mrsym[], int mrprob[], int mr2sym[], int mr2prob[],
   int ntotal=0,ntotal_min=32768,ncandidates;
   int nera_best=0;
   float pp,pp1,pp2;
-  static unsigned int nseed;
   
 // Power-percentage symbol metrics - composite gnnf/hf 
   int perr[8][8] = {
@@ -53,7 +145,7 @@ void ftrsdap_(int mrsym[], int mrprob[], int mr2sym[], int mr2prob[],
     
 // Initialize the KA9Q Reed-Solomon encoder/decoder
   unsigned int symsize=6, gfpoly=0x43, fcr=3, prim=1, nroots=51;
-  rs=init_rs_int(symsize, gfpoly, fcr, prim, nroots, 0);
+  if(!rs) rs=init_rs_int(symsize, gfpoly, fcr, prim, nroots, 0);
 
 // Reverse the received symbol vectors for BM decoder
   for (i=0; i<63; i++) {
@@ -125,9 +217,8 @@ symbol spectra, and using these to decide which candidate
 codeword is "best".
 */
 
-  nseed=1;                                 //Seed for random numbers
   float ratio;
-  int thresh, nsum;
+  int nsum;
   int thresh0[63];
   ncandidates=0;
   nsum=0;
@@ -148,70 +239,84 @@ codeword is "best".
 
   if(nsum<=0) return;
 
-  pp1=0.0;
-  pp2=0.0;
-  for (k=1; k<=ntrials; k++) {
-    memset(era_pos,0,51*sizeof(int));
-    memcpy(workdat,rxdat,sizeof(rxdat));
-
-/* 
-Mark a subset of the symbols as erasures.
-Run through the ranked symbols, starting with the worst, i=0.
-NB: j is the symbol-vector index of the symbol with rank i.
+/*
+The trials are run in rounds, each thread taking a share of the next
+nthreads*NROUND of them. A thread gives up on trials past the first
+one whose candidate would end the search by itself. The candidates
+found are then taken in trial order exactly as a single thread would
+have taken them, so the result does not depend on the thread count.
 */
-    numera=0;
-    for (i=0; i<nn; i++) {
-      j = indexes[62-i];
-      thresh=thresh0[i];
-      long int ir;
+  int nthreads=1, nslot, k0, k1, kend, stop, done=0;
+  struct trial one, *trials;
+#ifdef _OPENMP
+  if(omp_get_active_level() < omp_get_max_active_levels()) {
+    nthreads=omp_get_max_threads();
+  }
+#endif
+  nslot=nthreads*NROUND;
+  if(nslot>ntrials) nslot=ntrials;
+  trials=NULL;
+  if(nslot>1) trials=malloc(nslot*sizeof(struct trial));
+  if(!trials) {
+    trials=&one;
+    nslot=1;
+  }
 
-// Generate a random number ir, 0 <= ir < 100 (see POSIX.1-2001 example).
-      nseed = nseed * 1103515245 + 12345;
-      ir = (unsigned)(nseed/65536) % 32768;
-      ir = (100*ir)/32768;
+  pp1=0.0;
+  pp2=0.0;
+  for (k0=1; k0<=ntrials && !done; k0=kend+1) {
+    k1=k0+nslot-1;
+    if(k1>ntrials) k1=ntrials;
+    stop=k1;
 
-      if((ir < thresh ) && numera < 51) {
-        era_pos[numera]=j;
-        numera=numera+1;
+#pragma omp parallel for schedule(dynamic,4) num_threads(nthreads) if(nthreads>1)
+    for (k=k0; k<=k1; k++) {
+      struct trial *t=&trials[k-k0];
+      int last;
+#pragma omp atomic read
+      last=stop;
+      t->numera=-1;
+      if(k>last) continue;
+      run_trial(k,rxdat,rxdat2,rxprob,indexes,thresh0,nsum,t);
+      if(t->numera>=0 && t->nhard<=41 && t->nhard+t->nsoft<=71) {
+#pragma omp critical (ftrsdap_stop)
+        if(k<stop) {
+#pragma omp atomic write
+          stop=k;
+        }
       }
     }
 
-    nerr=decode_rs_int(rs,workdat,era_pos,numera,0);        
-    if( nerr >= 0 ) {
-      // We have a candidate codeword.  Find its hard and soft distance from
-      // the received word.  Also find pp1 and pp2 from the full array 
-      // s3(64,63) of synchronized symbol spectra.
-      ncandidates=ncandidates+1;
-      nhard=0;
-      nsoft=0;
-      for (i=0; i<63; i++) {
-        if(workdat[i] != rxdat[i]) {
-          nhard=nhard+1;
-          if(workdat[i] != rxdat2[i]) {
-            nsoft=nsoft+rxprob[i];
-          }
+    kend=stop;
+    for (k=k0; k<=kend; k++) {
+      struct trial *t=&trials[k-k0];
+      if( t->numera >= 0 ) {
+        ncandidates=ncandidates+1;
+        nhard=t->nhard;
+        nsoft=t->nsoft;
+        ntotal=nsoft+nhard;
+        pp=t->pp;
+        if(pp>pp1) {
+          pp2=pp1;
+          pp1=pp;
+          nsoft_min=nsoft;
+          nhard_min=nhard;
+          ntotal_min=ntotal;
+          memcpy(correct,t->workdat,63*sizeof(int));
+          nera_best=t->numera;
+          ntry[0]=k;
+        } else {
+          if(pp>pp2 && pp!=pp1) pp2=pp;
+        }
+        if(nhard_min <= 41 && ntotal_min <= 71) {
+          done=1;
+          break;
         }
       }
-      nsoft=63*nsoft/nsum;
-      ntotal=nsoft+nhard;
-
-      getpp_(workdat,&pp);
-      if(pp>pp1) {
-        pp2=pp1;
-        pp1=pp;
-        nsoft_min=nsoft;
-        nhard_min=nhard;
-        ntotal_min=ntotal;
-        memcpy(correct,workdat,63*sizeof(int));
-        nera_best=numera;
-        ntry[0]=k;
-      } else {
-        if(pp>pp2 && pp!=pp1) pp2=pp;
-      }
-      if(nhard_min <= 41 && ntotal_min <= 71) break;
+      if(k == ntrials) ntry[0]=k;
     }
-    if(k == ntrials) ntry[0]=k;
   }
+  if(trials!=&one) free(trials);
   
   param[0]=ncandidates;
   param[1]=nhard_min;
@@ -10,6 +10,8 @@ program jt9
   use timer_module, only: timer
   use timer_impl, only: init_timer, fini_timer
   use readwav
+  use jt9_batch
+  use packjt77, only: hash22_capacity
 
   include 'jt9com.f90'
 
@@ -23,13 +25,18 @@ program jt9
   character wisfile*256
 !### ndepth was defined as 60001.  Why???
   integer :: arglen,stat,offset,remain,mode=0,flow=200,fsplit=2700,          &
-       fhigh=4000,nrxfreq=1500,ndepth=1,nexp_decode=0,nQSOProg=0
+       fhigh=4000,nrxfreq=1500,ndepth=1,nexp_decode=0,nQSOProg=0,nworkers=0,      &
+       nhashcalls=20000
   logical :: read_files = .true., tx9 = .false., display_help = .false.,     &
        bLowSidelobes = .false., nexp_decode_set = .false.,                   &
        have_ntol = .false.
-  type (option) :: long_options(33) = [                                      &
+  type (option) :: long_options(38) = [                                      &
     option ('help', .false., 'h', 'Display this help message', ''),          &
     option ('shmem',.true.,'s','Use shared memory for sample data','KEY'),   &
+    option ('shmem-events', .false., 'E',                                    &
+        'Wait for shared memory wakeup events instead of polling', ''),      &
+    option ('decode-records', .false., 'R',                                  &
+        'Pass decodes to shared memory records instead of stdout text', ''), &
     option ('tr-period', .true., 'p', 'Tx/Rx period, default SECONDS=60',    &
         'SECONDS'),                                                          &
     option ('executable-path', .true., 'e',                                  &
@@ -54,6 +61,14 @@ program jt9
     option ('fft-threads', .true., 'm',                                      &
         'Number of threads to process large FFTs, default THREADS=1',        &
         'THREADS'),                                                          &
+    option ('decoder-threads', .true., 'j',                                  &
+        'Number of threads decoding FT8 candidates, default THREADS=1',      &
+        'THREADS'),                                                          &
+    option ('batch', .true., 'B',                                            &
+        'Decode files with WORKERS processes in parallel, timing each',      &
+        'WORKERS'),                                                          &
+    option ('hash-calls', .true., 'C',                                       &
+        'Callsigns remembered by 22-bit hash, default CALLS=20000', 'CALLS'),&
     option ('q65', .false., '3', 'Q65 mode', ''),                            &
     option ('jt4', .false., '4', 'JT4 mode', ''),                            &
     option ('ft4', .false., '5', 'FT4 mode', ''),                            &
@@ -85,14 +100,14 @@ program jt9
   character(len=6) :: mygrid='', hisgrid='EN37'
   common/patience/npatience,nthreads
   common/decstats/ntry65a,ntry65b,n65a,n65b,num9,numfano
-  data npatience/1/,nthreads/1/,wisfile/' '/
+  data npatience/1/,nthreads/1/,wisfile/' '/,iworker/0/
 
   nsubmode = 0
   ntol = 20
   TRperiod=60.d0
 
   do
-     call getopt('hs:e:a:b:r:m:p:d:f:F:w:t:9876543WYqkTL:S:H:c:G:x:g:X:Q:',     &
+     call getopt('hs:ERe:a:b:r:m:j:B:C:p:d:f:F:w:t:9876543WYqkTL:S:H:c:G:x:g:X:Q:',     &
           long_options,c,optarg,arglen,stat,offset,remain,.true.)
      if (stat .ne. 0) then
         exit
@@ -103,6 +118,10 @@ program jt9
         case ('s')
            read_files = .false.
            shm_key = optarg(:arglen)
+        case ('E')
+           shm_events = .true.
+        case ('R')
+           shm_records = .true.
         case ('e')
            exe_dir = optarg(:arglen)
         case ('a')
@@ -113,6 +132,13 @@ program jt9
            temp_dir = optarg(:arglen)
         case ('m')
            read (optarg(:arglen), *) nthreads
+        case ('j')
+           read (optarg(:arglen), *) ndecthreads
+        case ('B')
+           read (optarg(:arglen), *) nworkers
+           nworkers=max(nworkers,1)
+        case ('C')
+           read (optarg(:arglen), *) nhashcalls
         case ('p')
            read (optarg(:arglen), *) TRperiod
         case ('d')
@@ -177,7 +203,12 @@ program jt9
      print *, 'Usage: jt9 [OPTIONS] file1 [file2 ...]'
      print *, '       Reads data from *.wav files.'
      print *, ''
-     print *, '       jt9 -s <key> [-w patience] [-m threads] [-e path] [-a path] [-t path]'
+     print *, '       jt9 -B <workers> [OPTIONS] <file | directory | @list> ...'
+     print *, '       Decodes *.wav files, directories of them and files listed'
+     print *, '       in <list> with a pool of worker processes, output is in'
+     print *, '       file order with the time taken for each file.'
+     print *, ''
+     print *, '       jt9 -s <key> [-E] [-w patience] [-m threads] [-j threads] [-e path] [-a path] [-t path]'
      print *, '       Gets data from shared memory region with key==<key>'
      print *, ''
      print *, 'OPTIONS:'
@@ -204,6 +235,8 @@ program jt9
   num9=0
   numfano=0
 
+  call hash22_capacity(nhashcalls)
+
   if (.not. read_files) then
      call jt9a()          !We're running under control of WSJT-X
      go to 999
@@ -229,11 +262,29 @@ program jt9
         nexp_decode = 3 * 256   ! single decode off and nb=0
      end if
   end if
-  allocate(shared_data)
-  nflatten=0
   do iarg = offset + 1, offset + remain
      call get_command_argument (iarg, optarg, arglen)
-     infile = optarg(:arglen)
+     call batch_add (optarg(:arglen)//C_NULL_CHAR)
+  enddo
+! Each worker process has its own copy of the decoders' state
+  iworker=batch_start(nworkers,trim(temp_dir)//C_NULL_CHAR)
+  if(iworker.lt.0) go to 999           !Parent, the workers have finished
+  if(batch_workers().gt.0) then
+     write(infile,'(a,i2.2,a)') trim(data_dir)//'/timer_',iworker,'.out'
+     call init_timer (trim(infile))
+  else
+     call init_timer (trim(data_dir)//'/timer.out')
+  endif
+  call timer('jt9     ',0)
+
+  allocate(shared_data)
+  nflatten=0
+  do
+     ifile=batch_next()
+     if(ifile.eq.0) exit
+     call batch_name (ifile, infile, len(infile))
+     flush(6)
+     call batch_begin (ifile)
      call wav%read (infile)
      nfsample=wav%audio_format%sample_rate
      i1=index(infile,'.wav')
@@ -251,10 +302,6 @@ program jt9
      k=0
      nhsym=0
      nhsym0=-999
-     if(iarg .eq. offset + 1) then
-        call init_timer (trim(data_dir)//'/timer.out')
-        call timer('jt9     ',0)
-     endif
      shared_data%id2=0          !??? Why is this necessary ???
      if(mode.eq.5) npts=21*3456
      if(mode.eq.66) npts=TRperiod*12000
@@ -354,7 +401,7 @@ program jt9
         shared_data%params%nzhsym=50
         call multimode_decoder(shared_data%ss,id2a,      &
              shared_data%params,nfsample)
-        cycle
+        go to 10
 
      ! MSK144        
      else if (mode .eq. 144) then
@@ -364,7 +411,10 @@ program jt9
 ! Normal decoding pass
      call multimode_decoder(shared_data%ss,shared_data%id2, &
           shared_data%params,nfsample)
+10   flush(6)
+     call batch_end (ifile)
   enddo
+  call batch_finish ()
 
   call timer('jt9     ',1)
   call timer('jt9     ',101)
@@ -373,7 +423,9 @@ program jt9
 ! Output decoder statistics
   call fini_timer ()
 ! Save FFTW wisdom and free memory
-  if(len(trim(wisfile)).gt.0) iret=fftwf_export_wisdom_to_filename(wisfile)
+! Only one process writes it when decoding in a batch
+  if(len(trim(wisfile)).gt.0 .and. iworker.eq.0)                        &
+       iret=fftwf_export_wisdom_to_filename(wisfile)
   call four2a(a,-1,1,1,1)
   call filbig(a,-1,1,0.0,0,0,0,0,0)        !used for FFT plans
   call fftwf_cleanup_threads()
@@ -0,0 +1,357 @@
+/*
+ * Batch decoding support for jt9.
+ *
+ * Builds the list of files to decode from the command line, where an
+ * argument may be a *.wav file, a directory of them or @listfile, and
+ * shares the list among a pool of forked worker processes.  Each
+ * worker has its own copy of the decoders' SAVEd and module state.
+ * Workers take the next file from a counter in shared memory and send
+ * its output to a temporary file, which the parent copies to stdout in
+ * list order, followed by the time spent decoding the file.  Where
+ * fork() is not available the files are decoded in turn by the one
+ * process.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#define BATCH_FORK 1
+#endif
+
+enum {PENDING, DONE, FAILED};
+
+struct result
+{
+  int state;
+  double seconds;
+};
+
+static char **files;            /* the list of files to decode */
+static int nfiles;
+static int capacity;
+
+static int timing;              /* -B given, report times */
+static int nworkers;            /* forked workers, 0 when in-process */
+static int worker;              /* this worker's number */
+static int next;                /* in-process counterpart of shared->next */
+static double begun;            /* start of the file being decoded */
+static double batch_begun;
+static int ndone;
+static double busy;
+
+#ifdef BATCH_FORK
+struct shared
+{
+  int next;                     /* files handed out so far */
+  int current[64];              /* file each worker is decoding, 0 if none */
+  struct result results[1];     /* nfiles of them */
+};
+static struct shared *shared;
+static char const *dir;
+static long batch_id;           /* the parent's pid, names temporary files */
+static int saved_stdout = -1;
+#endif
+
+static double now(void)
+{
+  struct timespec t;
+#ifdef _WIN32
+  timespec_get(&t, TIME_UTC);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &t);
+#endif
+  return t.tv_sec + 1.e-9 * t.tv_nsec;
+}
+
+static void add_file(char const *path)
+{
+  if(nfiles == capacity) {
+    capacity = capacity ? 2 * capacity : 256;
+    files = realloc(files, capacity * sizeof *files);
+    if(!files) {
+      fprintf(stderr, "jt9: out of memory listing files\n");
+      exit(1);
+    }
+  }
+  files[nfiles++] = strdup(path);
+}
+
+static int is_wav(char const *name)
+{
+  size_t n = strlen(name);
+  return n > 4 && name[n - 4] == '.'
+    && tolower((unsigned char)name[n - 3]) == 'w'
+    && tolower((unsigned char)name[n - 2]) == 'a'
+    && tolower((unsigned char)name[n - 1]) == 'v';
+}
+
+static int compare_names(void const *a, void const *b)
+{
+  return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Add path to the list, expanding directories and @listfiles */
+void batch_add(char const *path)
+{
+  struct stat st;
+
+  if(path[0] == '@') {
+    FILE *list = fopen(path + 1, "r");
+    char line[1024];
+    if(!list) {
+      fprintf(stderr, "jt9: cannot open file list %s\n", path + 1);
+      return;
+    }
+    while(fgets(line, sizeof line, list)) {
+      size_t n = strlen(line);
+      while(n && isspace((unsigned char)line[n - 1])) line[--n] = '\0';
+      if(n) batch_add(line);
+    }
+    fclose(list);
+  } else if(!stat(path, &st) && S_ISDIR(st.st_mode)) {
+    /* yyMMdd_hhmmss names sort into time order */
+    DIR *d = opendir(path);
+    struct dirent *e;
+    int first = nfiles;
+    if(!d) {
+      fprintf(stderr, "jt9: cannot read directory %s\n", path);
+      return;
+    }
+    while((e = readdir(d))) {
+      if(is_wav(e->d_name)) {
+        char *name = malloc(strlen(path) + strlen(e->d_name) + 2);
+        sprintf(name, "%s/%s", path, e->d_name);
+        add_file(name);
+        free(name);
+      }
+    }
+    closedir(d);
+    qsort(files + first, nfiles - first, sizeof *files, compare_names);
+  } else {
+    add_file(path);
+  }
+}
+
+int batch_count(void)
+{
+  return nfiles;
+}
+
+/* Copy the name of file i (1..nfiles) to a blank padded Fortran string */
+void batch_name(int i, char *name, int len)
+{
+  int n = strlen(files[i - 1]);
+  if(n > len) n = len;
+  memcpy(name, files[i - 1], n);
+  memset(name + n, ' ', len - n);
+}
+
+int batch_workers(void)
+{
+  return nworkers;
+}
+
+static void report(int i, struct result const *r)
+{
+  if(r->state == DONE) {
+    printf("<BatchFile> %s %9.3f s\n", files[i - 1], r->seconds);
+  } else {
+    printf("<BatchFile> %s failed\n", files[i - 1]);
+  }
+}
+
+static void summary(void)
+{
+  double elapsed = now() - batch_begun;
+  printf("<BatchSummary> %d periods in %.2f s, %.2f periods/s, %.2f s decoding per period, %d worker%s\n",
+         ndone, elapsed, elapsed > 0. ? ndone / elapsed : 0.,
+         ndone ? busy / ndone : 0., nworkers ? nworkers : 1,
+         nworkers > 1 ? "s" : "");
+  fflush(stdout);
+}
+
+#ifdef BATCH_FORK
+static void temp_name(char *name, size_t size, int i)
+{
+  snprintf(name, size, "%s/jt9_batch_%ld_%d.txt", dir, batch_id, i);
+}
+
+/* Parent: copy each file's output to stdout in list order */
+static void collect(pid_t const *pids, int nlive)
+{
+  int j = 1;
+  while(j <= nfiles) {
+    struct result r;
+    r.state = __atomic_load_n(&shared->results[j - 1].state, __ATOMIC_ACQUIRE);
+    r.seconds = shared->results[j - 1].seconds;
+    if(r.state != PENDING) {
+      char name[1024];
+      FILE *f;
+      temp_name(name, sizeof name, j);
+      if((f = fopen(name, "r"))) {
+        char buf[4096];
+        size_t n;
+        while((n = fread(buf, 1, sizeof buf, f))) fwrite(buf, 1, n, stdout);
+        fclose(f);
+        remove(name);
+      }
+      report(j, &r);
+      fflush(stdout);
+      if(r.state == DONE) {
+        ++ndone;
+        busy += r.seconds;
+      }
+      ++j;
+      continue;
+    }
+
+    /* a worker that dies takes its current file with it */
+    int status;
+    pid_t pid;
+    while(nlive && (pid = waitpid(-1, &status, WNOHANG)) > 0) {
+      int w;
+      --nlive;
+      for(w = 0; w < nworkers; ++w) {
+        int i = shared->current[w];
+        if(pids[w] == pid && i
+           && PENDING == __atomic_load_n(&shared->results[i - 1].state, __ATOMIC_ACQUIRE)) {
+          shared->results[i - 1].state = FAILED;
+        }
+      }
+    }
+    if(!nlive) {
+      /* nobody left to decode it */
+      if(PENDING == __atomic_load_n(&shared->results[j - 1].state, __ATOMIC_ACQUIRE)) {
+        shared->results[j - 1].state = FAILED;
+      }
+      continue;
+    }
+    struct timespec pause = {0, 5000000};
+    nanosleep(&pause, NULL);
+  }
+  while(nlive && wait(NULL) > 0) --nlive;
+}
+#endif
+
+/*
+ * Start decoding the list with n workers, n = 0 decodes in-process
+ * without reporting times.  Returns this process's worker number, or
+ * -1 in the parent once all the output has been collected.
+ */
+int batch_start(int n, char const *temp_dir)
+{
+  timing = n > 0;
+  nworkers = 0;
+  worker = 0;
+  batch_begun = now();
+  if(n > 64) n = 64;
+#ifdef BATCH_FORK
+  if(n > nfiles) n = nfiles;
+  if(n > 1) {
+    size_t size = sizeof *shared + nfiles * sizeof shared->results[0];
+    pid_t pids[64];
+    int w;
+    shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(shared == MAP_FAILED) {
+      fprintf(stderr, "jt9: cannot share the batch, decoding in one process\n");
+      shared = NULL;
+    } else {
+      memset(shared, 0, size);
+      dir = temp_dir;
+      batch_id = (long)getpid();
+      nworkers = n;
+      fflush(stdout);
+      for(w = 0; w < n; ++w) {
+        pids[w] = fork();
+        if(!pids[w]) {
+          worker = w;
+          return worker;
+        }
+        if(pids[w] < 0) {
+          fprintf(stderr, "jt9: fork failed, continuing with %d workers\n", w);
+          nworkers = w;
+          break;
+        }
+      }
+      collect(pids, w);
+      summary();
+      return -1;
+    }
+  }
+#else
+  (void)temp_dir;
+#endif
+  return worker;
+}
+
+/* Number of the next file to decode, 0 when there are no more */
+int batch_next(void)
+{
+  int i;
+#ifdef BATCH_FORK
+  if(nworkers) {
+    i = __atomic_add_fetch(&shared->next, 1, __ATOMIC_RELAXED);
+    if(i > nfiles) i = 0;
+    shared->current[worker] = i;
+    return i;
+  }
+#endif
+  i = ++next;
+  return i > nfiles ? 0 : i;
+}
+
+/* Call before decoding file i, with Fortran output flushed */
+void batch_begin(int i)
+{
+#ifdef BATCH_FORK
+  if(nworkers) {
+    char name[1024];
+    int fd;
+    temp_name(name, sizeof name, i);
+    fflush(stdout);
+    if(saved_stdout < 0) saved_stdout = dup(1);
+    if((fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) >= 0) {
+      dup2(fd, 1);
+      close(fd);
+    }
+  }
+#else
+  (void)i;
+#endif
+  begun = now();
+}
+
+/* Call after decoding file i, with Fortran output flushed */
+void batch_end(int i)
+{
+  struct result r = {DONE, now() - begun};
+#ifdef BATCH_FORK
+  if(nworkers) {
+    fflush(stdout);
+    dup2(saved_stdout, 1);
+    shared->results[i - 1].seconds = r.seconds;
+    __atomic_store_n(&shared->results[i - 1].state, DONE, __ATOMIC_RELEASE);
+    return;
+  }
+#endif
+  if(timing) {
+    report(i, &r);
+    fflush(stdout);
+  }
+  ++ndone;
+  busy += r.seconds;
+}
+
+/* Call when this process has no more files to decode */
+void batch_finish(void)
+{
+  if(timing && !nworkers) summary();
+}
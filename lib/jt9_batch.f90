@@ -0,0 +1,52 @@
+module jt9_batch
+  ! external routines in jt9_batch.c that share a list of *.wav files
+  ! among a pool of worker processes
+  interface
+     subroutine batch_add (path) bind(C, name="batch_add")
+       use iso_c_binding, only: c_char
+       character(kind=c_char), intent(in) :: path(*)
+     end subroutine batch_add
+
+     function batch_count () bind(C, name="batch_count")
+       use iso_c_binding, only: c_int
+       integer(c_int) :: batch_count
+     end function batch_count
+
+     subroutine batch_name (i, name, len) bind(C, name="batch_name")
+       use iso_c_binding, only: c_int, c_char
+       integer(c_int), value, intent(in) :: i
+       character(kind=c_char), intent(out) :: name(*)
+       integer(c_int), value, intent(in) :: len
+     end subroutine batch_name
+
+     function batch_start (nworkers, temp_dir) bind(C, name="batch_start")
+       use iso_c_binding, only: c_int, c_char
+       integer(c_int) :: batch_start
+       integer(c_int), value, intent(in) :: nworkers
+       character(kind=c_char), intent(in) :: temp_dir(*)
+     end function batch_start
+
+     function batch_workers () bind(C, name="batch_workers")
+       use iso_c_binding, only: c_int
+       integer(c_int) :: batch_workers
+     end function batch_workers
+
+     function batch_next () bind(C, name="batch_next")
+       use iso_c_binding, only: c_int
+       integer(c_int) :: batch_next
+     end function batch_next
+
+     subroutine batch_begin (i) bind(C, name="batch_begin")
+       use iso_c_binding, only: c_int
+       integer(c_int), value, intent(in) :: i
+     end subroutine batch_begin
+
+     subroutine batch_end (i) bind(C, name="batch_end")
+       use iso_c_binding, only: c_int
+       integer(c_int), value, intent(in) :: i
+     end subroutine batch_end
+
+     subroutine batch_finish () bind(C, name="batch_finish")
+     end subroutine batch_finish
+  end interface
+end module jt9_batch
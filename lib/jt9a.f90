@@ -4,6 +4,8 @@ subroutine jt9a()
   use timer_module, only: timer
   use timer_impl, only: init_timer !, limtrace
   use shmem
+  use decode_records, only: decode_records_attach
+  use packjt77, only: hash22_open
 
   include 'jt9com.f90'
 
@@ -14,6 +16,8 @@ subroutine jt9a()
   logical(c_bool) :: ok
 
   call init_timer (trim(data_dir)//'/timer.out')
+! Nonstandard callsigns heard in earlier sessions, hashtable.txt is WSPR's
+  call hash22_open(trim(data_dir)//'/hashtable77.txt')
 !  open(23,file=trim(data_dir)//'/CALL3.TXT',status='unknown')
 
 !  limtrace=-1                            !Disable all calls to timer()
@@ -23,7 +27,11 @@ subroutine jt9a()
   ok=shmem_attach()
   if(.not.ok) call abort
   msdelay=30
+! Block on the GUI's wakeup events if asked to, else poll every msdelay ms
+  if(shm_events) shm_events=shmem_events_open()
   call c_f_pointer(shmem_address(),shared_data)
+! Decodes go to the record ring after dec_data if the GUI asked for them
+  if(shm_records) call decode_records_attach(shmem_records_address())
 
 ! Terminate if ipc(2) is 999
 10 ok=shmem_lock()
@@ -37,7 +45,11 @@ subroutine jt9a()
   if(shared_data%ipc(2).ne.1) then
      ok=shmem_unlock()
      if(.not.ok) call abort
-     call sleep_msec(msdelay)
+     if(shm_events) then
+        if(.not.shmem_wait_start()) shm_events=.false.   !Fall back to polling
+     else
+        call sleep_msec(msdelay)
+     endif
      go to 10
   endif
   shared_data%ipc(2)=0
@@ -85,10 +97,19 @@ subroutine jt9a()
 ! Wait here until GUI routine decodeDone() has set ipc(3) to 1
 100 ok=shmem_lock()
   if(.not.ok) call abort
+  if(shared_data%ipc(2).eq.999.0) then
+     ok=shmem_unlock()
+     ok=shmem_detach()
+     go to 999
+  endif
   if(shared_data%ipc(3).ne.1) then
      ok=shmem_unlock()
      if(.not.ok) call abort
-     call sleep_msec(msdelay)
+     if(shm_events) then
+        if(.not.shmem_wait_ack()) shm_events=.false.     !Fall back to polling
+     else
+        call sleep_msec(msdelay)
+     endif
      go to 100
   endif
   shared_data%ipc(3)=0
@@ -1,4 +1,7 @@
 MODULE prog_args
   CHARACTER(len=80) :: shm_key
+  LOGICAL :: shm_events = .false.
+  LOGICAL :: shm_records = .false.
+  INTEGER :: ndecthreads = 1
   CHARACTER(len=500) :: exe_dir = '.', data_dir = '.', temp_dir = '.'
 END MODULE prog_args
@@ -1,9 +1,21 @@
 #include <QSharedMemory>
+#include <QSystemSemaphore>
+#include <QScopedPointer>
 #include <QLatin1String>
 
+#include "commons.h"
+#include "shmem_events.h"
+
 // Multiple instances: KK1D, 17 Jul 2013
 QSharedMemory shmem;
 
+namespace
+{
+  // wakeup events posted by the GUI, see shmem_events.h
+  QScopedPointer<QSystemSemaphore> decode_start_event;
+  QScopedPointer<QSystemSemaphore> decode_ack_event;
+}
+
 struct jt9com;
 
 // C wrappers for a QSharedMemory class instance
@@ -14,7 +26,35 @@ extern "C"
   bool shmem_attach () {return shmem.attach();}
   int shmem_size () {return static_cast<int> (shmem.size());}
   struct jt9com * shmem_address () {return reinterpret_cast<struct jt9com *>(shmem.data());}
+  // the decode record ring follows dec_data, null if the GUI did not make room for it
+  void * shmem_records_address ()
+  {
+    if (shmem.size () < static_cast<int> (sizeof (dec_data_t) + sizeof (decode_records_t))) return nullptr;
+    return static_cast<char *> (shmem.data ()) + sizeof (dec_data_t);
+  }
   bool shmem_lock () {return shmem.lock();}
   bool shmem_unlock () {return shmem.unlock();}
   bool shmem_detach () {return shmem.detach();}
+
+  // Open the wakeup events belonging to the current key, returns
+  // false if they are not available and the caller must poll
+  bool shmem_events_open ()
+  {
+    decode_start_event.reset (new QSystemSemaphore {decode_start_event_key (shmem.key ()), 0, QSystemSemaphore::Open});
+    decode_ack_event.reset (new QSystemSemaphore {decode_ack_event_key (shmem.key ()), 0, QSystemSemaphore::Open});
+    if (QSystemSemaphore::NoError != decode_start_event->error ()
+        || QSystemSemaphore::NoError != decode_ack_event->error ())
+      {
+        decode_start_event.reset ();
+        decode_ack_event.reset ();
+        return false;
+      }
+    return true;
+  }
+
+  // Block until the GUI posts a start decode (or terminate) request
+  bool shmem_wait_start () {return decode_start_event && decode_start_event->acquire ();}
+
+  // Block until the GUI acknowledges a finished decode
+  bool shmem_wait_ack () {return decode_ack_event && decode_ack_event->acquire ();}
 }
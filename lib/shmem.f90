@@ -22,6 +22,11 @@ module shmem
        type(c_ptr) :: shmem_address
      end function shmem_address
 
+     function shmem_records_address() bind(C, name="shmem_records_address")
+       use, intrinsic :: iso_c_binding, only: c_ptr
+       type(c_ptr) :: shmem_records_address
+     end function shmem_records_address
+
      function shmem_size() bind(C, name="shmem_size")
        use, intrinsic :: iso_c_binding, only: c_int
        integer(c_int) :: shmem_size
@@ -41,5 +46,20 @@ module shmem
        use iso_c_binding, only: c_bool
        logical(c_bool) :: shmem_detach
      end function shmem_detach
+
+     function shmem_events_open () bind(C, name="shmem_events_open")
+       use iso_c_binding, only: c_bool
+       logical(c_bool) :: shmem_events_open
+     end function shmem_events_open
+
+     function shmem_wait_start () bind(C, name="shmem_wait_start")
+       use iso_c_binding, only: c_bool
+       logical(c_bool) :: shmem_wait_start
+     end function shmem_wait_start
+
+     function shmem_wait_ack () bind(C, name="shmem_wait_ack")
+       use iso_c_binding, only: c_bool
+       logical(c_bool) :: shmem_wait_ack
+     end function shmem_wait_ack
   end interface
 end module shmem
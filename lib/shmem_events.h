@@ -0,0 +1,26 @@
+#ifndef SHMEM_EVENTS_H
+#define SHMEM_EVENTS_H
+
+#include <QString>
+
+//
+// Keys of the QSystemSemaphore pair used to wake jt9 without polling
+// the shared memory segment.  The GUI creates both and releases
+// "start" whenever it sets ipc[1] (start decode or terminate) and
+// "ack" whenever it sets ipc[2] (decode finished acknowledged).  jt9
+// still re-checks the ipc[] values under the shared memory lock after
+// every wakeup so a spurious or stale release is harmless.
+//
+inline
+QString decode_start_event_key (QString const& shmem_key)
+{
+  return shmem_key + "_decode_start";
+}
+
+inline
+QString decode_ack_event_key (QString const& shmem_key)
+{
+  return shmem_key + "_decode_ack";
+}
+
+#endif
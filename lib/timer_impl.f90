@@ -10,14 +10,24 @@ module timer_impl
 
   private
 
+  ! There is one entry per name, parent and thread so the tables start
+  ! at MAXCALL entries per thread and grow when they fill up
   integer, parameter :: MAXCALL=100
   integer :: lu=6
   real :: dut
-  integer :: i,nmax=0,ncall(MAXCALL),nlevel(MAXCALL),nparent(MAXCALL)
-  character(len=8) :: name(MAXCALL),space='        '
-  logical :: on(MAXCALL)
-  real :: total,sum,sumf,ut(MAXCALL),ut0(MAXCALL)
-  !$ integer :: j,l,m,ntid(MAXCALL)
+  integer :: i,nmax=0
+  integer, allocatable :: ncall(:),nlevel(:),nparent(:)
+  character(len=8), allocatable :: name(:)
+  character(len=8) :: space='        '
+  logical, allocatable :: on(:)
+  real :: total,sum,sumf
+  real, allocatable :: ut(:),ut0(:)
+  !$ integer :: j,l,m
+  !$ integer, allocatable :: ntid(:)
+
+  interface resize
+     module procedure resize_integer, resize_real, resize_logical, resize_name
+  end interface resize
 
   !
   ! C interoperable callback setup
@@ -59,6 +69,7 @@ contains
   ! default Fortran implementation which is thread safe using OpenMP
   !
   subroutine default_timer (dname, k)
+    use four2a_cache, only: nhits, nmisses, nplan
 
     ! Times procedure number n between a call with k=0 (tstart) and with
     ! k=1 (tstop). Accumulates sums of these times in array ut (user time).
@@ -98,6 +109,7 @@ contains
        end if
     enddo
 
+    if(nmax.ge.size(name)) call grow(2*size(name))
     nmax=nmax+1                                !This is a new one
     n=nmax
     !$ ntid(n)=tid
@@ -148,7 +160,7 @@ contains
 
     ntrace=ntrace+1
     tname='TopLevel'
-    if(nparent(n).ge.1 .and. nparent(n).le.MAXCALL) tname=name(nparent(n))
+    if(nparent(n).ge.1 .and. nparent(n).le.nmax) tname=name(nparent(n))
     if(ntrace.lt.limtrace) write(lu,1020) ntrace,dname,k,level,nparent(n),tname
 1020 format(i8,': ',a8,3i5,2x,a8)
     flush(lu)
@@ -197,6 +209,8 @@ contains
     call print_root(1)
     write(lu,1070) sum,sumf
 1070 format(58('-')/32x,f10.3,f6.2)
+    write(lu,1080) nhits,nmisses,nplan
+1080 format(/' four2a plans:',i12,' hits',i10,' misses',i6,' plans')
     nmax=0
     eps=0.000001
     ntrace=0
@@ -241,13 +255,71 @@ contains
     return
   end subroutine print_root
 
+  ! Makes room for n entries keeping the first nmax
+  subroutine grow (n)
+    implicit none
+    integer, intent(in) :: n
+    call resize (ncall, n)
+    call resize (nlevel, n)
+    call resize (nparent, n)
+    call resize (name, n)
+    call resize (on, n)
+    call resize (ut, n)
+    call resize (ut0, n)
+    !$ call resize (ntid, n)
+  end subroutine grow
+
+  subroutine resize_integer (a, n)
+    implicit none
+    integer, allocatable, intent(inout) :: a(:)
+    integer, intent(in) :: n
+    integer, allocatable :: b(:)
+    allocate (b(n))
+    if (allocated (a)) b(1:nmax)=a(1:nmax)
+    call move_alloc (b, a)
+  end subroutine resize_integer
+
+  subroutine resize_real (a, n)
+    implicit none
+    real, allocatable, intent(inout) :: a(:)
+    integer, intent(in) :: n
+    real, allocatable :: b(:)
+    allocate (b(n))
+    if (allocated (a)) b(1:nmax)=a(1:nmax)
+    call move_alloc (b, a)
+  end subroutine resize_real
+
+  subroutine resize_logical (a, n)
+    implicit none
+    logical, allocatable, intent(inout) :: a(:)
+    integer, intent(in) :: n
+    logical, allocatable :: b(:)
+    allocate (b(n))
+    if (allocated (a)) b(1:nmax)=a(1:nmax)
+    call move_alloc (b, a)
+  end subroutine resize_logical
+
+  subroutine resize_name (a, n)
+    implicit none
+    character(len=8), allocatable, intent(inout) :: a(:)
+    integer, intent(in) :: n
+    character(len=8), allocatable :: b(:)
+    allocate (b(n))
+    if (allocated (a)) b(1:nmax)=a(1:nmax)
+    call move_alloc (b, a)
+  end subroutine resize_name
+
   subroutine init_timer (filename)
     use, intrinsic :: iso_c_binding, only: c_char
     use timer_module, only: timer
     implicit none
     character(len=*), optional, intent(in) :: filename
+    integer :: nthreads
     include 'timer_common.inc'
     data level/0/, onlevel/11 * 0/
+    nthreads=1
+    !$ nthreads=omp_get_max_threads()
+    if (.not.allocated (name)) call grow (MAXCALL*nthreads)
     if (present (filename)) then
        open (newunit=lu, file=filename, status='unknown')
     else
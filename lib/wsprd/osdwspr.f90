@@ -23,6 +23,7 @@ data gg/1,1,0,1,0,1,0,0,1,0,0,0,1,1,0,0,1,0,1,0,0,1,0,1,1,1,0,1,1,0,0,0, &
 
 save first,gen
 
+!$omp critical (osdwspr_gen)
 if( first ) then ! fill the generator matrix
   gen=0
   gen(1,1:2*L)=gg(1:2*L)
@@ -31,6 +32,7 @@ if( first ) then ! fill the generator matrix
   enddo
   first=.false.
 endif
+!$omp end critical (osdwspr_gen)
 
 rx=ss/127.0
 apmaskr=apmask
@@ -290,6 +292,7 @@ subroutine boxit(reset,e2,ntau,npindex,i1,i2)
   integer   indexes(4000,2),fp(0:525000),np(4000)
   logical reset
   common/boxes/indexes,fp,np
+  !$omp threadprivate(/boxes/)
 
   if(reset) then
     patterns=-1
@@ -327,7 +330,9 @@ subroutine fetchit(reset,e2,ntau,i1,i2)
   integer*1 e2(ntau)
   logical reset
   common/boxes/indexes,fp,np
+  !$omp threadprivate(/boxes/)
   save lastpat,inext
+  !$omp threadprivate(lastpat,inext)
 
   if(reset) then
     lastpat=-1
@@ -34,7 +34,11 @@
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
+#include <sys/stat.h>
 #include <fftw3.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "fano.h"
 #include "jelinek.h"
@@ -107,6 +111,12 @@ unsigned long readc2file(char *ptr_to_infile, float *idat, float *qdat,
 //***************************************************************************
 unsigned long readwavfile(char *ptr_to_infile, int ntrmin, float *idat, float *qdat )
 {
+    // PLAN1 and PLAN2 and their buffers are kept for the next file,
+    // PLAN1 is made again only if the mode changes
+    static int nfft1_planned=0;
+    static float *realin;
+    static fftwf_complex *fftin, *fftout1, *fftout;
+    
     size_t i, j, npoints, nr;
     int nfft1, nfft2, nh2, i0;
     double df;
@@ -129,9 +139,6 @@ unsigned long readwavfile(char *ptr_to_infile, int ntrmin, float *idat, float *q
         return 1;
     }
     
-    float *realin;
-    fftwf_complex *fftin, *fftout;
-    
     FILE *fp;
     short int *buf2;
     
@@ -151,9 +158,21 @@ unsigned long readwavfile(char *ptr_to_infile, int ntrmin, float *idat, float *q
         return 1;
     }	
     
-    realin=(float*) fftwf_malloc(sizeof(float)*nfft1);
-    fftout=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*(nfft1/2+1));
-    PLAN1 = fftwf_plan_dft_r2c_1d(nfft1, realin, fftout, PATIENCE);
+    if( nfft1 != nfft1_planned ) {
+        if( nfft1_planned ) {
+            fftwf_destroy_plan(PLAN1);
+            fftwf_free(realin);
+            fftwf_free(fftout1);
+        } else {
+            fftin=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*nfft2);
+            fftout=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*nfft2);
+            PLAN2 = fftwf_plan_dft_1d(nfft2, fftin, fftout, FFTW_BACKWARD, PATIENCE);
+        }
+        realin=(float*) fftwf_malloc(sizeof(float)*nfft1);
+        fftout1=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*(nfft1/2+1));
+        PLAN1 = fftwf_plan_dft_r2c_1d(nfft1, realin, fftout1, PATIENCE);
+        nfft1_planned=nfft1;
+    }
     
     for (i=0; i<npoints; i++) {
         realin[i]=buf2[i]/32768.0;
@@ -165,20 +184,14 @@ unsigned long readwavfile(char *ptr_to_infile, int ntrmin, float *idat, float *q
     free(buf2);
     
     fftwf_execute(PLAN1);
-    fftwf_free(realin);
-    
-    fftin=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*nfft2);
     
     for (i=0; i<(size_t)nfft2; i++) {
         j=i0+i;
         if( i>(size_t)nh2 ) j=j-nfft2;
-        fftin[i][0]=fftout[j][0];
-        fftin[i][1]=fftout[j][1];
+        fftin[i][0]=fftout1[j][0];
+        fftin[i][1]=fftout1[j][1];
     }
     
-    fftwf_free(fftout);
-    fftout=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*nfft2);
-    PLAN2 = fftwf_plan_dft_1d(nfft2, fftin, fftout, FFTW_BACKWARD, PATIENCE);
     fftwf_execute(PLAN2);
     
     for (i=0; i<(size_t)nfft2; i++) {
@@ -186,8 +199,6 @@ unsigned long readwavfile(char *ptr_to_infile, int ntrmin, float *idat, float *q
         qdat[i]=fftout[i][1]/1000.0;
     }
     
-    fftwf_free(fftin);
-    fftwf_free(fftout);
     return nfft2;
 }
 
@@ -204,7 +215,7 @@ void sync_and_demodulate(float *id, float *qd, long np,
      *           symbols using passed frequency and shift.                  *
      ************************************************************************/
     
-    static float fplast=-10000.0;
+    float fplast=-10000.0;
     static float dt=1.0/375.0, df=375.0/256.0;
     static float pi=3.14159265358979323846;
     float twopidt, df15=df*1.5, df05=df*0.5;
@@ -351,7 +362,7 @@ void noncoherent_sequence_detection(float *id, float *qd, long np,
      *  nblock=1 corresponds to noncoherent detection of individual symbols *
      *     like the original wsprd symbol demodulator.                      *
      ************************************************************************/
-    static float fplast=-10000.0;
+    float fplast=-10000.0;
     static float dt=1.0/375.0, df=375.0/256.0;
     static float pi=3.14159265358979323846;
     float twopidt, df15=df*1.5, df05=df*0.5;
@@ -703,10 +714,207 @@ unsigned int count_hard_errors( unsigned char *symbols, unsigned char *channel_s
     return nerrors;
 }
 
+//***************************************************************************
+struct cand { float freq; float snr; int shift; float drift; float sync; };
+
+struct result { char date[7]; char time[5]; float sync; float snr;
+    float dt; double freq; char message[23]; float drift;
+    unsigned int cycles; int jitter; int blocksize; unsigned int metric;
+    int nhardmin; int ipass; int decodetype;};
+
+// Settings and data shared by every candidate of a decoding pass
+struct decoder {
+    float *idat, *qdat;
+    long npoints;
+    int nblocksize, iifac, symfac, quickmode, ndepth, delta, stackdecoder;
+    float minrms;
+    unsigned int nbits, maxcycles, stacksize;
+    int (*mettab)[256];
+    char *hashtab, *loctab;
+};
+
+// Outcome of trying to decode one candidate
+struct trial {
+    unsigned char symbols[162], decdata[11];
+    int not_decoded, osd_decode, hash_miss;
+    int jitter, blocksize, bitmetric, nhardmin;
+    unsigned int cycles, metric;
+    float tsync2, tfano, tosd;
+};
+
+// strongest first, then by frequency
+int candcomp(const void* elem1, const void* elem2)
+{
+    struct cand const *c1=elem1, *c2=elem2;
+    if( c1->snr != c2->snr ) return c1->snr < c2->snr ? 1 : -1;
+    return (c1->freq > c2->freq) - (c1->freq < c2->freq);
+}
+
+// lowest frequency first, then by message
+int resultcomp(const void* elem1, const void* elem2)
+{
+    struct result const *r1=elem1, *r2=elem2;
+    if( r1->freq != r2->freq ) return r1->freq > r2->freq ? 1 : -1;
+    return strcmp(r1->message,r2->message);
+}
+
+// Seconds for the timer file. With OpenMP these are wall clock seconds
+// summed over the threads that ran each code segment.
+double seconds(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock()/CLOCKS_PER_SEC;
+#endif
+}
+
+/***************************************************************************
+ Try to decode one candidate at each block size and shift jitter in turn,
+ touching nothing but *t, so that candidates may be tried concurrently.
+ stack is the stack decoder's workspace, one per thread.
+ ****************************************************************************/
+void decode_candidate(struct decoder const *d, struct cand const *c,
+                      struct snode *stack, struct trial *t)
+{
+    int i, ib, idt, ii=0, jittered_shift, blocksize=1, bitmetric=0;
+    int n1, n2, n3, nadd, nu, ntype, ihash;
+    unsigned int maxnp;
+    unsigned char apmask[162], cw[162];
+    unsigned char *symbols=t->symbols, *decdata=t->decdata;
+    signed char message[11];
+    char callsign[13], grid[5];
+    float f1=c->freq, drift1=c->drift, fsymbs[162], y, sq, rms, dmin;
+    int shift1=c->shift;
+    double t0;
+
+    memset(t,0,sizeof(struct trial));
+    memset(apmask,0,sizeof(apmask));
+    memset(callsign,0,sizeof(callsign));
+    memset(grid,0,sizeof(grid));
+    t->not_decoded=1;
+
+    ib=1;
+    while( ib <= d->nblocksize && t->not_decoded ) {
+        if (ib < 4) { blocksize=ib; bitmetric=0; }
+        if (ib == 4) { blocksize=1; bitmetric=1; }
+
+        idt=0; ii=0;
+        while ( t->not_decoded && idt<=(128/d->iifac)) {
+            ii=(idt+1)/2;
+            if( idt%2 == 1 ) ii=-ii;
+            ii=d->iifac*ii;
+            jittered_shift=shift1+ii;
+            t->nhardmin=0; dmin=0.0;
+
+            // Get soft-decision symbols
+            t0 = seconds();
+            noncoherent_sequence_detection(d->idat, d->qdat, d->npoints, symbols, &f1,
+                                           &jittered_shift, &drift1, d->symfac, &blocksize, &bitmetric);
+            t->tsync2 += seconds()-t0;
+
+            sq=0.0;
+            for(i=0; i<162; i++) {
+                y=(float)symbols[i] - 128.0;
+                sq += y*y;
+            }
+            rms=sqrt(sq/162.0);
+
+            if(rms > d->minrms) {
+                deinterleave(symbols);
+                t0 = seconds();
+
+                if ( d->stackdecoder ) {
+                    t->not_decoded = jelinek(&t->metric, &t->cycles, decdata, symbols, d->nbits,
+                                             d->stacksize, stack, d->mettab, d->maxcycles);
+                } else {
+                    t->not_decoded = fano(&t->metric, &t->cycles, &maxnp, decdata, symbols, d->nbits,
+                                          d->mettab, d->delta, d->maxcycles);
+                }
+
+                t->tfano += seconds()-t0;
+
+                if( (d->ndepth >= 0) && t->not_decoded ) {
+                    int ndepth=d->ndepth;
+                    for(i=0; i<162; i++) {
+                        fsymbs[i]=symbols[i]-128.0;
+                    }
+                    t0 = seconds();
+                    osdwspr_(fsymbs,apmask,&ndepth,cw,&t->nhardmin,&dmin);
+                    t->tosd += seconds()-t0;
+
+                    for(i=0; i<162; i++) {
+                        symbols[i]=255*cw[i];
+                    }
+                    fano(&t->metric,&t->cycles,&maxnp,decdata,symbols,d->nbits,
+                         d->mettab,d->delta,d->maxcycles);
+                    for(i=0; i<11; i++) {
+                        if( decdata[i]>127 ) {
+                            message[i]=decdata[i]-256;
+                        } else {
+                            message[i]=decdata[i];
+                        }
+                    }
+                    unpack50(message,&n1,&n2);
+                    if( !unpackcall(n1,callsign) ) break;
+                    callsign[12]=0;
+                    if( !unpackgrid(n2, grid) ) break;
+                    grid[4]=0;
+                    ntype = (n2&127) - 64;
+                    int itype;
+                    if( (ntype >= 0) && (ntype <= 62) ) {
+                        nu = ntype%10;
+                        itype=1;
+                        if( !(nu == 0 || nu == 3 || nu == 7) ) {
+                            nadd=nu;
+                            if( nu > 3 ) nadd=nu-3;
+                            if( nu > 7 ) nadd=nu-7;
+                            n3=n2/128+32768*(nadd-1);
+                            if( !unpackpfx(n3,callsign) ) {
+                                break;
+                            }
+                            itype=2;
+                        }
+                        ihash=nhash(callsign,strlen(callsign),(uint32_t)146);
+                        if(strncmp(d->hashtab+ihash*13,callsign,13)==0) {
+                            if( (itype==1 && strncmp(d->loctab+ihash*5,grid,5)==0) ||
+                                (itype==2) ) {
+                               t->not_decoded=0;
+                               t->osd_decode =1;
+                            } else {
+                               t->hash_miss=1;
+                            }
+                        } else {
+                            t->hash_miss=1;
+                        }
+                    }
+                }
+
+            }
+            idt++;
+            if( d->quickmode ) break;
+        }
+        ib++;
+    }
+    t->jitter=ii;
+    t->blocksize=blocksize;
+    t->bitmetric=bitmetric;
+}
+
+// Whether subtracting a signal can change what is demodulated at
+// another: the four tones of both, their drift and a tone spacing either
+// side for the skirts of the subtraction filter
+int overlapping(float f0, float drift0, float f1, float drift1)
+{
+    float df=375.0/256.0;
+    return fabsf(f0-f1) < 5*df + (fabsf(drift0)+fabsf(drift1))/2;
+}
+
 //***************************************************************************
 void usage(void)
 {
     printf("Usage: wsprd [options...] infile\n");
+    printf("       wsprd --serve\n");
     printf("       infile must have suffix .wav or .c2\n");
     printf("\n");
     printf("Options:\n");
@@ -723,22 +931,132 @@ void usage(void)
     printf("       -o n (0<=n<=5), decoding depth for OSD, default is disabled\n");
     printf("       -q quick mode - doesn't dig deep for weak signals\n");
     printf("       -s single pass mode, no subtraction (same as original wsprd)\n");
+    printf("       -T n (n is the number of decoding threads, default all cores)\n");
     printf("       -v verbose mode (shows dupes)\n");
     printf("       -w wideband mode - decode signals within +/- 150 Hz of center\n");
     printf("       -z x (x is fano metric table bias, default is 0.45)\n");
+    printf("\n");
+    printf("--serve reads jobs from standard input until end of file. A job is the\n");
+    printf("options and infile as above, one per line, followed by an empty line.\n");
+    printf("Each job's output ends with <DecodeFinished>.\n");
 }
 
-//***************************************************************************
-int main(int argc, char *argv[])
+/***************************************************************************
+ What is kept from one decode to the next by wsprd --serve: the files of
+ the data directory as loaded, the Fano metric table and the buffers for
+ the input. FFTW plans are kept as PLAN1, PLAN2 and PLAN3.
+ ****************************************************************************/
+// hashtable.txt as it was when last read or written
+struct file_state { int exists; time_t mtime; long long size; };
+
+struct resident {
+    char data_dir[200];              // the data directory files were loaded from
+    char *hashtab, *loctab;          // callsign hash table
+    struct file_state hash_file;     // hashtable.txt as the table stands
+    float timers[8];                 // accumulated wspr_timer.out figures
+    float bias;                      // Fano metric bias mettab was made with
+    int mettab[2][256];
+    float *idat, *qdat;
+    fftwf_complex *fftin, *fftout;   // PLAN3 buffers, NULL until planned
+    int max_threads;                 // decoding threads unless told otherwise
+};
+
+void make_mettab(float bias, int mettab[2][256])
+{
+#include "./metric_tables.c"
+    int i;
+
+    for(i=0; i<256; i++) {
+        mettab[0][i]=round( 10*(metric_tables[2][i]-bias) );
+        mettab[1][i]=round( 10*(metric_tables[2][255-i]-bias) );
+    }
+}
+
+void get_file_state(char const *fname, struct file_state *s)
+{
+    struct stat st;
+
+    memset(s,0,sizeof *s);
+    if( !stat(fname,&st) ) {
+        s->exists=1;
+        s->mtime=st.st_mtime;
+        s->size=st.st_size;
+    }
+}
+
+int same_file_state(struct file_state const *s1, struct file_state const *s2)
+{
+    return s1->exists == s2->exists && s1->mtime == s2->mtime && s1->size == s2->size;
+}
+
+/***************************************************************************
+ Load FFTW wisdom, the hash table and the timer figures from data_dir
+ unless they were loaded from there already. The hash table is loaded
+ again if hashtable.txt has changed since it was last read or written,
+ for example erased by the user.
+ ****************************************************************************/
+void load_data_dir(struct resident *r, char const *data_dir)
+{
+    char wisdom_fname[200],timer_fname[200],hash_fname[200];
+    char line[80], hcall[13], hgrid[5];
+    FILE *fp_fftwf_wisdom_file, *fhash, *ftimer;
+    struct file_state hash_file;
+    int nh;
+
+    snprintf(hash_fname,sizeof hash_fname,"%s/hashtable.txt",data_dir);
+    get_file_state(hash_fname,&hash_file);
+
+    if( strcmp(r->data_dir,data_dir) ) {
+        strncpy(r->data_dir,data_dir,sizeof r->data_dir - 1);
+
+        snprintf(wisdom_fname,sizeof wisdom_fname,"%s/wspr_wisdom.dat",data_dir);
+        snprintf(timer_fname,sizeof timer_fname,"%s/wspr_timer.out",data_dir);
+
+        if ((fp_fftwf_wisdom_file = fopen(wisdom_fname, "r"))) {  //Open FFTW wisdom
+            fftwf_import_wisdom_from_file(fp_fftwf_wisdom_file);
+            fclose(fp_fftwf_wisdom_file);
+        }
+
+        memset(r->timers,0,sizeof r->timers);
+        if((ftimer=fopen(timer_fname,"r"))) {
+            //Accumulate timing data
+            float *t=r->timers;
+            int nr=fscanf(ftimer,"%f %f %f %f %f %f %f %f",
+                   &t[0],&t[1],&t[2],&t[3],&t[4],&t[5],&t[6],&t[7]);
+            fclose(ftimer);
+            if(nr == 0) fprintf(stderr, "Empty timer file: '%s'\n", timer_fname);
+        }
+    } else if( same_file_state(&hash_file,&r->hash_file) ) {
+        return;
+    }
+
+    r->hash_file=hash_file;
+    memset(r->hashtab,0,sizeof(char)*32768*13);
+    memset(r->loctab,0,sizeof(char)*32768*5);
+    if( (fhash=fopen(hash_fname,"r")) ) {
+        while (fgets(line, sizeof(line), fhash) != NULL) {
+            hgrid[0]='\0';
+            sscanf(line,"%d %s %s",&nh,hcall,hgrid);
+            strcpy(r->hashtab+nh*13,hcall);
+            if(strlen(hgrid)>0) strcpy(r->loctab+nh*5,hgrid);
+        }
+        fclose(fhash);
+    }
+}
+
+/***************************************************************************
+ Decode one file as given by the command line arguments
+ ****************************************************************************/
+int wsprd(int argc, char *argv[], struct resident *r)
 {
     char cr[] = "(C) 2018, Steven Franke - K9AN";
     (void)cr;
     extern char *optarg;
     extern int optind;
     int i,j,k;
-    unsigned char *symbols, *decdata, *channel_symbols, *apmask, *cw;
+    unsigned char channel_symbols[162];
     signed char message[]={-9,13,-35,123,57,-39,64,0,0,0,0};
-    char *callsign, *grid,  *call_loc_pow;
+    char callsign[13], call_loc_pow[23];
     char *ptr_to_infile,*ptr_to_infile_suffix;
     char *data_dir=".";
     char wisdom_fname[200],all_fname[200],spots_fname[200];
@@ -746,48 +1064,28 @@ int main(int argc, char *argv[])
     char uttime[5],date[7];
     int c,delta,maxpts=65536,verbose=0,quickmode=0,more_candidates=0, stackdecoder=0;
     int usehashtable=1,wspr_type=2, ipass, nblocksize;
-    int nhardmin,ihash;
+    int nthreads=0;
     int writec2=0,maxdrift;
-    int shift1, lagmin, lagmax, lagstep, ifmin, ifmax, not_decoded;
     unsigned int nbits=81, stacksize=200000;
     struct snode * stack=NULL;
-    unsigned int npoints, cycles, maxnp, metric;
+    unsigned int npoints;
     float df=375.0/256.0/2;
-    float fsymbs[162];
     float dt=1.0/375.0, dt_print;
     double dialfreq_cmdline=0.0, dialfreq, freq_print;
     double dialfreq_error=0.0;
     float fmin=-110, fmax=110;
-    float f1, fstep, sync1, drift1;
-    float dmin;
     float psavg[512];
-    float *idat, *qdat;
-    clock_t t0,t00;
-    float tfano=0.0,treadwav=0.0,tcandidates=0.0,tsync0=0.0;
-    float tsync1=0.0,tsync2=0.0,tosd=0.0,ttotal=0.0;
+    float *idat=r->idat, *qdat=r->qdat;
+    double t0,t00;
+    float *timers=r->timers;
+    float tsync0=0.0,tsync1=0.0;
     
-    struct cand { float freq; float snr; int shift; float drift; float sync; };
     struct cand candidates[200];
-    
-    struct result { char date[7]; char time[5]; float sync; float snr;
-        float dt; double freq; char message[23]; float drift;
-        unsigned int cycles; int jitter; int blocksize; unsigned int metric;
-        int nhardmin; int ipass; int decodetype;};
+    struct trial trials[200];
     struct result decodes[50];
     
-    char *hashtab;
-    hashtab=calloc(32768*13,sizeof(char));
-    char *loctab;
-    loctab=calloc(32768*5,sizeof(char));
-    int nh;
-    symbols=calloc(nbits*2,sizeof(unsigned char));
-    apmask=calloc(162,sizeof(unsigned char));
-    cw=calloc(162,sizeof(unsigned char));
-    decdata=calloc(11,sizeof(unsigned char));
-    channel_symbols=calloc(nbits*2,sizeof(unsigned char));
-    callsign=calloc(13,sizeof(char));
-    grid=calloc(5,sizeof(char));
-    call_loc_pow=calloc(23,sizeof(char));
+    char *hashtab=r->hashtab;
+    char *loctab=r->loctab;
     float allfreqs[100];
     char allcalls[100][13];
     for (i=0; i<100; i++) allfreqs[i]=0.0;
@@ -809,16 +1107,12 @@ int main(int argc, char *argv[])
     delta=60;                                //Fano threshold step
     float bias=0.45;                        //Fano metric bias (used for both Fano and stack algorithms)
     
-    t00=clock();
-    fftwf_complex *fftin, *fftout;
-#include "./metric_tables.c"
+    t00=seconds();
     
-    int mettab[2][256];
-    
-    idat=calloc(maxpts,sizeof(float));
-    qdat=calloc(maxpts,sizeof(float));
+    memset(idat,0,sizeof(float)*maxpts);
+    memset(qdat,0,sizeof(float)*maxpts);
     
-    while ( (c = getopt(argc, argv, "a:BcC:de:f:HJmo:qstwvz:")) !=-1 ) {
+    while ( (c = getopt(argc, argv, "a:BcC:de:f:HJmo:qstT:wvz:")) !=-1 ) {
         switch (c) {
             case 'a':
                 data_dir = optarg;
@@ -861,6 +1155,9 @@ int main(int argc, char *argv[])
                 subtraction = 0;
                 npasses = 1;
                 break;
+            case 'T':  //decoding threads
+                nthreads=(int) strtol(optarg,NULL,10);
+                break;
             case 'v':
                 verbose = 1;
                 break;
@@ -890,61 +1187,46 @@ int main(int argc, char *argv[])
         ptr_to_infile=argv[optind];
     }
     
-    if( stackdecoder ) {
-        stack=calloc(stacksize,sizeof(struct snode));
-    }
+#ifdef _OPENMP
+    omp_set_num_threads(nthreads > 0 ? nthreads : r->max_threads);
+#else
+    (void)nthreads;
+#endif
 
     // setup metric table
-    for(i=0; i<256; i++) {
-        mettab[0][i]=round( 10*(metric_tables[2][i]-bias) );
-        mettab[1][i]=round( 10*(metric_tables[2][255-i]-bias) );
+    if( bias != r->bias ) {
+        make_mettab(bias, r->mettab);
+        r->bias=bias;
     }
-    
-    FILE *fp_fftwf_wisdom_file, *fall_wspr, *fwsprd, *fhash, *ftimer;
-    strcpy(wisdom_fname,".");
-    strcpy(all_fname,".");
-    strcpy(spots_fname,".");
-    strcpy(timer_fname,".");
-    strcpy(hash_fname,".");
-    if(data_dir != NULL) {
-      strncpy(wisdom_fname,data_dir, sizeof wisdom_fname);
-      strncpy(all_fname,data_dir, sizeof all_fname);
-      strncpy(spots_fname,data_dir, sizeof spots_fname);
-      strncpy(timer_fname,data_dir, sizeof timer_fname);
-      strncpy(hash_fname,data_dir, sizeof hash_fname);
+
+    load_data_dir(r, data_dir);
+    if( !r->fftin ) {
+        r->fftin=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*512);
+        r->fftout=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*512);
+        PLAN3 = fftwf_plan_dft_1d(512, r->fftin, r->fftout, FFTW_FORWARD, PATIENCE);
     }
-    strncat(wisdom_fname,"/wspr_wisdom.dat",20);
-    strncat(all_fname,"/ALL_WSPR.TXT",20);
-    strncat(spots_fname,"/wspr_spots.txt",20);
-    strncat(timer_fname,"/wspr_timer.out",20);
-    strncat(hash_fname,"/hashtable.txt",20);
-    if ((fp_fftwf_wisdom_file = fopen(wisdom_fname, "r"))) {  //Open FFTW wisdom
-        fftwf_import_wisdom_from_file(fp_fftwf_wisdom_file);
-        fclose(fp_fftwf_wisdom_file);
+    if( !usehashtable ) {
+        // a table of this decode's calls alone, the resident one is left as is
+        hashtab=calloc(32768*13,sizeof(char));
+        loctab=calloc(32768*5,sizeof(char));
     }
     
-    fall_wspr=fopen(all_fname,"a");
-    fwsprd=fopen(spots_fname,"w");
-    //  FILE *fdiag;
-    //  fdiag=fopen("wsprd_diag","a");
-    
-    if((ftimer=fopen(timer_fname,"r"))) {
-        //Accumulate timing data
-        int nr=fscanf(ftimer,"%f %f %f %f %f %f %f %f",
-               &treadwav,&tcandidates,&tsync0,&tsync1,&tsync2,&tfano,&tosd,&ttotal);
-        fclose(ftimer);
-        if(nr == 0) fprintf(stderr, "Empty timer file: '%s'\n", timer_fname);
-    }
-    ftimer=fopen(timer_fname,"w");
+    FILE *fp_fftwf_wisdom_file, *fall_wspr, *fwsprd, *fhash, *ftimer;
+    snprintf(wisdom_fname,sizeof wisdom_fname,"%s/wspr_wisdom.dat",data_dir);
+    snprintf(all_fname,sizeof all_fname,"%s/ALL_WSPR.TXT",data_dir);
+    snprintf(spots_fname,sizeof spots_fname,"%s/wspr_spots.txt",data_dir);
+    snprintf(timer_fname,sizeof timer_fname,"%s/wspr_timer.out",data_dir);
+    snprintf(hash_fname,sizeof hash_fname,"%s/hashtable.txt",data_dir);
     
     if( strstr(ptr_to_infile,".wav") ) {
         ptr_to_infile_suffix=strstr(ptr_to_infile,".wav");
         
-        t0 = clock();
+        t0 = seconds();
         npoints=readwavfile(ptr_to_infile, wspr_type, idat, qdat);
-        treadwav += (float)(clock()-t0)/CLOCKS_PER_SEC;
+        timers[0] += seconds()-t0;
         
         if( npoints == 1 ) {
+            if( !usehashtable ) { free(hashtab); free(loctab); }
             return 1;
         }
         dialfreq=dialfreq_cmdline - (dialfreq_error*1.0e-06);
@@ -952,15 +1234,26 @@ int main(int argc, char *argv[])
         ptr_to_infile_suffix=strstr(ptr_to_infile,".c2");
         npoints=readc2file(ptr_to_infile, idat, qdat, &dialfreq, &wspr_type);
         if( npoints == 1 ) {
+            if( !usehashtable ) { free(hashtab); free(loctab); }
             return 1;
         }
         dialfreq -= (dialfreq_error*1.0e-06);
     } else {
         printf("Error: Failed to open %s\n",ptr_to_infile);
         printf("WSPR file must have suffix .wav or .c2\n");
+        if( !usehashtable ) { free(hashtab); free(loctab); }
         return 1;
     }
     
+    if( stackdecoder ) {
+        stack=calloc(stacksize,sizeof(struct snode));
+    }
+
+    fall_wspr=fopen(all_fname,"a");
+    fwsprd=fopen(spots_fname,"w");
+    //  FILE *fdiag;
+    //  fdiag=fopen("wsprd_diag","a");
+
     // Parse date and time from given filename
     strncpy(date,ptr_to_infile_suffix-11,6);
     strncpy(uttime,ptr_to_infile_suffix-4,4);
@@ -969,9 +1262,7 @@ int main(int argc, char *argv[])
     
     // Do windowed ffts over 2 symbols, stepped by half symbols
     int nffts=4*floor(npoints/512)-1;
-    fftin=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*512);
-    fftout=(fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex)*512);
-    PLAN3 = fftwf_plan_dft_1d(512, fftin, fftout, FFTW_FORWARD, PATIENCE);
+    fftwf_complex *fftin=r->fftin, *fftout=r->fftout;
     
     float ps[512][nffts];
     float w[512];
@@ -979,20 +1270,8 @@ int main(int argc, char *argv[])
         w[i]=sin(0.006147931*i);
     }
     
-    if( usehashtable ) {
-        char line[80], hcall[13], hgrid[5];
-        if( (fhash=fopen(hash_fname,"r+")) ) {
-            while (fgets(line, sizeof(line), fhash) != NULL) {
-                hgrid[0]='\0';
-                sscanf(line,"%d %s %s",&nh,hcall,hgrid);
-                strcpy(hashtab+nh*13,hcall);
-                if(strlen(hgrid)>0) strcpy(loctab+nh*5,hgrid);
-            }
-        } else {
-            fhash=fopen(hash_fname,"w+");
-        }
-        fclose(fhash);
-    }
+    struct decoder dec = {idat, qdat, npoints, 0, iifac, symfac, quickmode, ndepth, delta,
+        stackdecoder, minrms, nbits, maxcycles, stacksize, r->mettab, hashtab, loctab};
     
     //*************** main loop starts here *****************
     for (ipass=0; ipass<npasses; ipass++) {
@@ -1117,20 +1396,11 @@ int main(int argc, char *argv[])
         }
         npk=i;
         
-        // bubble sort on snr
-        int pass;
-        struct cand tmp;
-        for (pass = 1; pass <= npk - 1; pass++) {
-            for (k = 0; k < npk - pass ; k++) {
-                if (candidates[k].snr < candidates[k+1].snr) {
-                    tmp = candidates[k];
-                    candidates[k]=candidates[k+1];
-                    candidates[k+1] = tmp;
-                }
-            }
-        }
+        // sort on snr, strongest first, equal snrs by frequency so the
+        // order doesn't depend on qsort
+        qsort(candidates, npk, sizeof(struct cand), candcomp);
         
-        t0=clock();
+        t0=seconds();
         
         /* Make coarse estimates of shift (DT), freq, and drift
          
@@ -1150,12 +1420,16 @@ int main(int argc, char *argv[])
          * The frequency drift model is linear, deviation of +/- drift/2 over the
          span of 162 symbols, with deviation equal to 0 at the center of the
          signal vector.
+
+         * Candidates are independent of one another here and in the refinement
+         below so each is searched by whichever thread is free.
          */
         
-        int idrift,ifr,if0,ifd,k0;
-        int kindex;
-        float smax,ss,pow,p0,p1,p2,p3;
+#pragma omp parallel for schedule(dynamic)
         for(j=0; j<npk; j++) {                              //For each candidate...
+            int idrift,ifr,if0,ifd,k0,k;
+            int kindex;
+            float smax,ss,pow,p0,p1,p2,p3,sync1;
             smax=-1e30;
             if0=candidates[j].freq/df+256;
             for (ifr=if0-2; ifr<=if0+2; ifr++) {                      //Freq search
@@ -1193,7 +1467,7 @@ int main(int argc, char *argv[])
                 }
             }
         }
-        tcandidates += (float)(clock()-t0)/CLOCKS_PER_SEC;
+        timers[1] += seconds()-t0;
         
         /*
          Refine the estimates of freq, shift using sync as a metric.
@@ -1207,11 +1481,13 @@ int main(int argc, char *argv[])
          1 = no time lag or drift search. find best frequency.
          2 = no frequency or time lag search. Calculate soft-decision
          symbols using passed frequency and shift.
-         
-         NB: best possibility for OpenMP may be here: several worker threads
-         could each work on one candidate at a time.
          */
+#pragma omp parallel for schedule(dynamic) reduction(+:tsync0,tsync1)
         for (j=0; j<npk; j++) {
+            unsigned char symbols[162];
+            int shift1, lagmin, lagmax, lagstep, ifmin, ifmax;
+            float f1, fstep, sync1, drift1;
+            double t0;
             
             f1=candidates[j].freq;
             drift1=candidates[j].drift;
@@ -1223,13 +1499,13 @@ int main(int argc, char *argv[])
             lagmin=shift1-128;
             lagmax=shift1+128;
             lagstep=64;
-            t0 = clock();
+            t0 = seconds();
             sync_and_demodulate(idat, qdat, npoints, symbols, &f1, ifmin, ifmax, fstep, &shift1,
                                 lagmin, lagmax, lagstep, &drift1, symfac, &sync1, 0);
-            tsync0 += (float)(clock()-t0)/CLOCKS_PER_SEC;
+            tsync0 += seconds()-t0;
             
             fstep=0.25; ifmin=-2; ifmax=2;
-            t0 = clock();
+            t0 = seconds();
             sync_and_demodulate(idat, qdat, npoints, symbols, &f1, ifmin, ifmax, fstep, &shift1,
                                 lagmin, lagmax, lagstep, &drift1, symfac, &sync1, 1);
             
@@ -1253,23 +1529,23 @@ int main(int argc, char *argv[])
                     sync1=syncm;
                 }
             }
-            tsync1 += (float)(clock()-t0)/CLOCKS_PER_SEC;
+            tsync1 += seconds()-t0;
             
             // fine-grid lag and freq search
             if( sync1 > minsync1 ) {
                 
                 lagmin=shift1-32; lagmax=shift1+32; lagstep=16;
-                t0 = clock();
+                t0 = seconds();
                 sync_and_demodulate(idat, qdat, npoints, symbols, &f1, ifmin, ifmax, fstep, &shift1,
                                     lagmin, lagmax, lagstep, &drift1, symfac, &sync1, 0);
-                tsync0 += (float)(clock()-t0)/CLOCKS_PER_SEC;
+                tsync0 += seconds()-t0;
                 
                 // fine search over frequency
                 fstep=0.05; ifmin=-2; ifmax=2;
-                t0 = clock();
+                t0 = seconds();
                 sync_and_demodulate(idat, qdat, npoints, symbols, &f1, ifmin, ifmax, fstep, &shift1,
                                     lagmin, lagmax, lagstep, &drift1, symfac, &sync1, 1);
-                tsync1 += (float)(clock()-t0)/CLOCKS_PER_SEC;
+                tsync1 += seconds()-t0;
                 
                 candidates[j].freq=f1;
                 candidates[j].shift=shift1;
@@ -1297,133 +1573,64 @@ int main(int argc, char *argv[])
             }
         }
         
-        int idt, ii, jittered_shift;
-        float y,sq,rms;
-        int ib, blocksize, bitmetric;
-        int n1,n2,n3,nadd,nu,ntype;
-        int osd_decode;
+        /*
+         Try every candidate against the data as it is at the start of the
+         pass, concurrently. Decodes are then taken in candidate order as
+         before: a candidate is tried again on the data as it is by then if
+         an earlier decode of this pass was subtracted on top of it, or if an
+         earlier decode may have put the call its OSD decode lacked in the
+         hash table. Results are the same for any number of threads.
+         */
+        dec.nblocksize=nblocksize;
+#pragma omp parallel
+        {
+            struct snode *tstack=NULL;
+            if( stackdecoder ) tstack=calloc(stacksize,sizeof(struct snode));
+#pragma omp for schedule(dynamic)
+            for (j=0; j<nwat; j++) {
+                decode_candidate(&dec, &candidates[j], tstack, &trials[j]);
+            }
+            free(tstack);
+        }
+
+        float f1, drift1;
+        int shift1, nsubtracted=0;
+        float subtracted_freq[200], subtracted_drift[200];
         for (j=0; j<nwat; j++) {
-            memset(symbols,0,sizeof(char)*nbits*2);
+            struct trial *t=&trials[j];
             memset(callsign,0,sizeof(char)*13);
-            memset(grid,0,sizeof(char)*5);
             memset(call_loc_pow,0,sizeof(char)*23);
             f1=candidates[j].freq;
             shift1=candidates[j].shift;
             drift1=candidates[j].drift;
-            not_decoded=1;
-            osd_decode=0;
             
-            ib=1;
-            while( ib <= nblocksize && not_decoded ) {
-                if (ib < 4) { blocksize=ib; bitmetric=0; }
-                if (ib == 4) { blocksize=1; bitmetric=1; }
-                
-                idt=0; ii=0;
-                while ( not_decoded && idt<=(128/iifac)) {
-                    ii=(idt+1)/2;
-                    if( idt%2 == 1 ) ii=-ii;
-                    ii=iifac*ii;
-                    jittered_shift=shift1+ii;
-                    nhardmin=0; dmin=0.0;
-                    
-                    // Get soft-decision symbols
-                    t0 = clock();
-                    noncoherent_sequence_detection(idat, qdat, npoints, symbols, &f1,
-                                                   &jittered_shift, &drift1, symfac, &blocksize, &bitmetric);
-                    tsync2 += (float)(clock()-t0)/CLOCKS_PER_SEC;
-                    
-                    sq=0.0;
-                    for(i=0; i<162; i++) {
-                        y=(float)symbols[i] - 128.0;
-                        sq += y*y;
-                    }
-                    rms=sqrt(sq/162.0);
-                    
-                    if(rms > minrms) {
-                        deinterleave(symbols);
-                        t0 = clock();
-                        
-                        if ( stack ) {
-                            not_decoded = jelinek(&metric, &cycles, decdata, symbols, nbits,
-                                                  stacksize, stack, mettab,maxcycles);
-                        } else {
-                            not_decoded = fano(&metric,&cycles,&maxnp,decdata,symbols,nbits,
-                                               mettab,delta,maxcycles);
-                        }
-                        
-                        tfano += (float)(clock()-t0)/CLOCKS_PER_SEC;
-                        
-                        if( (ndepth >= 0) && not_decoded ) {
-                            for(i=0; i<162; i++) {
-                                fsymbs[i]=symbols[i]-128.0;
-                            }
-                            t0 = clock();
-                            osdwspr_(fsymbs,apmask,&ndepth,cw,&nhardmin,&dmin);
-                            tosd += (float)(clock()-t0)/CLOCKS_PER_SEC;
-                            
-                            for(i=0; i<162; i++) {
-                                symbols[i]=255*cw[i];
-                            }
-                            fano(&metric,&cycles,&maxnp,decdata,symbols,nbits,
-                                 mettab,delta,maxcycles);
-                            for(i=0; i<11; i++) {
-                                if( decdata[i]>127 ) {
-                                    message[i]=decdata[i]-256;
-                                } else {
-                                    message[i]=decdata[i];
-                                }
-                            }
-                            unpack50(message,&n1,&n2);
-                            if( !unpackcall(n1,callsign) ) break;
-                            callsign[12]=0;
-                            if( !unpackgrid(n2, grid) ) break;
-                            grid[4]=0;
-                            ntype = (n2&127) - 64;
-                            int itype;
-                            if( (ntype >= 0) && (ntype <= 62) ) {
-                                nu = ntype%10;
-                                itype=1;
-                                if( !(nu == 0 || nu == 3 || nu == 7) ) {
-                                    nadd=nu;
-                                    if( nu > 3 ) nadd=nu-3;
-                                    if( nu > 7 ) nadd=nu-7;
-                                    n3=n2/128+32768*(nadd-1);
-                                    if( !unpackpfx(n3,callsign) ) {
-                                        break;
-                                    }
-                                    itype=2;
-                                }
-                                ihash=nhash(callsign,strlen(callsign),(uint32_t)146);
-                                if(strncmp(hashtab+ihash*13,callsign,13)==0) {
-                                    if( (itype==1 && strncmp(loctab+ihash*5,grid,5)==0) ||
-                                        (itype==2) ) {
-                                       not_decoded=0;
-                                       osd_decode =1;
-                                    } 
-                                }
-                            }
-                        }
-                        
-                    }
-                    idt++;
-                    if( quickmode ) break;
-                }
-                ib++;
+            int retry=t->hash_miss && ndecodes_pass > 0;
+            for (i=0; i<nsubtracted && !retry; i++) {
+                retry=overlapping(f1,drift1,subtracted_freq[i],subtracted_drift[i]);
+            }
+            timers[4] += t->tsync2;
+            timers[5] += t->tfano;
+            timers[6] += t->tosd;
+            if( retry ) {
+                decode_candidate(&dec, &candidates[j], stack, t);
+                timers[4] += t->tsync2;
+                timers[5] += t->tfano;
+                timers[6] += t->tosd;
             }
-            
-            if( !not_decoded ) {
-                ndecodes_pass++;
                 
+            if( !t->not_decoded ) {
+                ndecodes_pass++;
+                    
                 for(i=0; i<11; i++) {
                     
-                    if( decdata[i]>127 ) {
-                        message[i]=decdata[i]-256;
+                    if( t->decdata[i]>127 ) {
+                        message[i]=t->decdata[i]-256;
                     } else {
-                        message[i]=decdata[i];
+                        message[i]=t->decdata[i];
                     }
                     
                 }
-                
+            
                 // Unpack the decoded message, update the hashtable, apply
                 // sanity checks on grid and power, and return
                 // call_loc_pow string and also callsign (for de-duping).
@@ -1431,7 +1638,10 @@ int main(int argc, char *argv[])
                 if( subtraction && !noprint ) {
                     if( get_wspr_channel_symbols(call_loc_pow, hashtab, loctab, channel_symbols) ) {
                         subtract_signal2(idat, qdat, npoints, f1, shift1, drift1, channel_symbols);
-                        if(!osd_decode) nhardmin=count_hard_errors(symbols,channel_symbols);
+                        subtracted_freq[nsubtracted]=f1;
+                        subtracted_drift[nsubtracted]=drift1;
+                        nsubtracted++;
+                        if(!t->osd_decode) t->nhardmin=count_hard_errors(t->symbols,channel_symbols);
                     } else {
                         break;
                     }
@@ -1467,13 +1677,13 @@ int main(int argc, char *argv[])
                     decodes[uniques-1].freq=freq_print;
                     strcpy(decodes[uniques-1].message,call_loc_pow);
                     decodes[uniques-1].drift=drift1;
-                    decodes[uniques-1].cycles=cycles;
-                    decodes[uniques-1].jitter=ii;
-                    decodes[uniques-1].blocksize=blocksize+3*bitmetric;
-                    decodes[uniques-1].metric=metric;
-                    decodes[uniques-1].nhardmin=nhardmin;
+                    decodes[uniques-1].cycles=t->cycles;
+                    decodes[uniques-1].jitter=t->jitter;
+                    decodes[uniques-1].blocksize=t->blocksize+3*t->bitmetric;
+                    decodes[uniques-1].metric=t->metric;
+                    decodes[uniques-1].nhardmin=t->nhardmin;
                     decodes[uniques-1].ipass=ipass;
-                    decodes[uniques-1].decodetype=osd_decode;
+                    decodes[uniques-1].decodetype=t->osd_decode;
                 }
             }
         }
@@ -1487,18 +1697,11 @@ int main(int argc, char *argv[])
             writec2file(c2filename, wsprtype, carrierfreq, idat, qdat);
         }
     }
+    timers[2] += tsync0;
+    timers[3] += tsync1;
     
     // sort the result in order of increasing frequency
-    struct result temp;
-    for (j = 1; j <= uniques - 1; j++) {
-        for (k = 0; k < uniques - j ; k++) {
-            if (decodes[k].freq > decodes[k+1].freq) {
-                temp = decodes[k];
-                decodes[k]=decodes[k+1];;
-                decodes[k+1] = temp;
-            }
-        }
-    }
+    qsort(decodes, uniques, sizeof(struct result), resultcomp);
     
     for (i=0; i<uniques; i++) {
         printf("%4s %3.0f %4.1f %10.6f %2d  %-s \n",
@@ -1520,62 +1723,124 @@ int main(int argc, char *argv[])
                 decodes[i].jitter);
         
     }
-    printf("<DecodeFinished>\n");
-    
-    fftwf_free(fftin);
-    fftwf_free(fftout);
+    fclose(fall_wspr);
+    fclose(fwsprd);
+    //  fclose(fdiag);
     
     if ((fp_fftwf_wisdom_file = fopen(wisdom_fname, "w"))) {
         fftwf_export_wisdom_to_file(fp_fftwf_wisdom_file);
         fclose(fp_fftwf_wisdom_file);
     }
     
-    ttotal += (float)(clock()-t00)/CLOCKS_PER_SEC;
-    
-    fprintf(ftimer,"%7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f\n\n",
-            treadwav,tcandidates,tsync0,tsync1,tsync2,tfano,tosd,ttotal);
-    
-    fprintf(ftimer,"Code segment        Seconds   Frac\n");
-    fprintf(ftimer,"-----------------------------------\n");
-    fprintf(ftimer,"readwavfile        %7.2f %7.2f\n",treadwav,treadwav/ttotal);
-    fprintf(ftimer,"Coarse DT f0 f1    %7.2f %7.2f\n",tcandidates,
-            tcandidates/ttotal);
-    fprintf(ftimer,"sync_and_demod(0)  %7.2f %7.2f\n",tsync0,tsync0/ttotal);
-    fprintf(ftimer,"sync_and_demod(1)  %7.2f %7.2f\n",tsync1,tsync1/ttotal);
-    fprintf(ftimer,"sync_and_demod(2)  %7.2f %7.2f\n",tsync2,tsync2/ttotal);
-    fprintf(ftimer,"Stack/Fano decoder %7.2f %7.2f\n",tfano,tfano/ttotal);
-    fprintf(ftimer,"OSD        decoder %7.2f %7.2f\n",tosd,tosd/ttotal);
-    fprintf(ftimer,"-----------------------------------\n");
-    fprintf(ftimer,"Total              %7.2f %7.2f\n",ttotal,1.0);
-    
-    fclose(fall_wspr);
-    fclose(fwsprd);
-    //  fclose(fdiag);
-    fclose(ftimer);
-    fftwf_destroy_plan(PLAN1);
-    fftwf_destroy_plan(PLAN2);
-    fftwf_destroy_plan(PLAN3);
+    timers[7] += seconds()-t00;
+    float treadwav=timers[0],tcandidates=timers[1],tsync2=timers[4];
+    float tfano=timers[5],tosd=timers[6],ttotal=timers[7];
+    tsync0=timers[2]; tsync1=timers[3];
+    
+    if((ftimer=fopen(timer_fname,"w"))) {
+        fprintf(ftimer,"%7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f\n\n",
+                treadwav,tcandidates,tsync0,tsync1,tsync2,tfano,tosd,ttotal);
+    
+        fprintf(ftimer,"Code segment        Seconds   Frac\n");
+        fprintf(ftimer,"-----------------------------------\n");
+        fprintf(ftimer,"readwavfile        %7.2f %7.2f\n",treadwav,treadwav/ttotal);
+        fprintf(ftimer,"Coarse DT f0 f1    %7.2f %7.2f\n",tcandidates,
+                tcandidates/ttotal);
+        fprintf(ftimer,"sync_and_demod(0)  %7.2f %7.2f\n",tsync0,tsync0/ttotal);
+        fprintf(ftimer,"sync_and_demod(1)  %7.2f %7.2f\n",tsync1,tsync1/ttotal);
+        fprintf(ftimer,"sync_and_demod(2)  %7.2f %7.2f\n",tsync2,tsync2/ttotal);
+        fprintf(ftimer,"Stack/Fano decoder %7.2f %7.2f\n",tfano,tfano/ttotal);
+        fprintf(ftimer,"OSD        decoder %7.2f %7.2f\n",tosd,tosd/ttotal);
+        fprintf(ftimer,"-----------------------------------\n");
+        fprintf(ftimer,"Total              %7.2f %7.2f\n",ttotal,1.0);
+        fclose(ftimer);
+    }
     
     if( usehashtable ) {
-        fhash=fopen(hash_fname,"w");
-        for (i=0; i<32768; i++) {
-            if( strncmp(hashtab+i*13,"\0",1) != 0 ) {
-                fprintf(fhash,"%5d %s %s\n",i,hashtab+i*13,loctab+i*5);
+        if( (fhash=fopen(hash_fname,"w")) ) {
+            for (i=0; i<32768; i++) {
+                if( strncmp(hashtab+i*13,"\0",1) != 0 ) {
+                    fprintf(fhash,"%5d %s %s\n",i,hashtab+i*13,loctab+i*5);
+                }
             }
+            fclose(fhash);
+            get_file_state(hash_fname,&r->hash_file);
         }
-        fclose(fhash);
+    } else {
+        free(hashtab);
+        free(loctab);
     }
     
-    free(hashtab);
-    free(loctab);
-    free(symbols);
-    free(decdata);
-    free(channel_symbols);
-    free(callsign);
-    free(call_loc_pow);
-    free(idat);
-    free(qdat);
     free(stack);
     
+    printf("<DecodeFinished>\n");
     return 0;
 }
+
+/***************************************************************************
+ wsprd --serve: decode jobs from standard input, keeping FFTW plans, the
+ metric table and the hash table between them
+ ****************************************************************************/
+int serve(struct resident *r)
+{
+    char line[1024], *args[64];
+    int nargs=1, status;
+
+    args[0]="wsprd";
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        line[strcspn(line,"\r\n")]='\0';
+        if( strlen(line) > 0 ) {
+            if( nargs < 63 ) args[nargs++]=strdup(line);
+            continue;
+        }
+        if( nargs == 1 ) continue;
+
+        args[nargs]=NULL;
+        // start getopt afresh, it may still point into the last job's arguments
+#ifdef __APPLE__
+        optreset=1;
+        optind=1;
+#else
+        optind=0;
+#endif
+        status=wsprd(nargs, args, r);
+        if( status != 0 ) printf("<DecodeFinished>\n");
+        fflush(stdout);
+        while( nargs > 1 ) free(args[--nargs]);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct resident r;
+    int status;
+
+    memset(&r,0,sizeof(r));
+    r.bias=-1.0;
+    r.hashtab=calloc(32768*13,sizeof(char));
+    r.loctab=calloc(32768*5,sizeof(char));
+    r.idat=calloc(65536,sizeof(float));
+    r.qdat=calloc(65536,sizeof(float));
+#ifdef _OPENMP
+    r.max_threads=omp_get_max_threads();
+#endif
+
+    if( argc == 2 && !strcmp(argv[1],"--serve") ) {
+        status=serve(&r);
+    } else {
+        status=wsprd(argc, argv, &r);
+    }
+
+    if( r.fftin ) {
+        fftwf_destroy_plan(PLAN3);
+        fftwf_free(r.fftin);
+        fftwf_free(r.fftout);
+    }
+    free(r.hashtab);
+    free(r.loctab);
+    free(r.idat);
+    free(r.qdat);
+
+    return status;
+}
@@ -3,9 +3,13 @@
 #include <string>
 #include <stdexcept>
 #include <algorithm>
+#include <vector>
+#include <map>
+#include <memory>
+#include <utility>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/key_extractors.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/lexical_cast.hpp>
@@ -17,6 +21,7 @@
 #include <QDebug>
 #include <QDebugStateSaver>
 #include <QRegularExpression>
+#include <QMutex>
 #include "Configuration.hpp"
 #include "Radio.hpp"
 #include "pimpl_impl.hpp"
@@ -146,28 +151,145 @@ QDebug operator << (QDebug dbg, prefix const& p)
 }
 #endif
 
-// set with ordered unique index that allow for efficient
-// determination of entity and entity overrides for a call or call
-// prefix
-typedef multi_index_container<
-  prefix,
-  indexed_by<
-    ordered_unique<const_mem_fun<prefix, QString, &prefix::prefix_key> > >
-  > prefixes_type;
+//
+// prefix_trie - longest prefix match over the cty.dat prefixes
+//
+//  Nodes are held in one vector with the children of each node
+//  contiguous and in character order, so matching a call is one walk
+//  from the root with no allocation. A node that completes a prefix
+//  refers to it by its index, the first one loaded wins when a prefix
+//  is repeated.
+//
+class prefix_trie final
+{
+public:
+  static int const none {-1};
 
-class AD1CCty::impl final
+  void build (std::vector<prefix> const&);
+
+  static int const root {0};
+
+  // a node's child for the next character, or none
+  int child (int node, QChar) const;
+
+  // the node s leads to, or none
+  int find (QString const& s) const;
+
+  // index of the prefix completed at a node, or none
+  int prefix_at (int node) const {return nodes_[node].prefix_;}
+
+private:
+  struct node
+  {
+    ushort char_;
+    quint16 children_count_;
+    qint32 children_;
+    qint32 prefix_;
+  };
+
+  std::vector<node> nodes_;
+};
+
+int const prefix_trie::none;
+int const prefix_trie::root;
+
+void prefix_trie::build (std::vector<prefix> const& prefixes)
+{
+  // build with maps, then lay the nodes out breadth first
+  struct builder_node
+  {
+    std::map<ushort, int> children_;
+    int prefix_;
+  };
+  std::vector<builder_node> builder (1, builder_node {{}, none});
+  for (std::size_t i = 0; i < prefixes.size (); ++i)
+    {
+      int n {0};
+      for (auto c : prefixes[i].prefix_key ())
+        {
+          auto child = builder[n].children_.find (c.unicode ());
+          if (child == builder[n].children_.end ())
+            {
+              builder.push_back (builder_node {{}, none});
+              child = builder[n].children_.emplace (c.unicode (), int (builder.size () - 1)).first;
+            }
+          n = child->second;
+        }
+      if (none == builder[n].prefix_) builder[n].prefix_ = int (i);
+    }
+
+  nodes_.clear ();
+  nodes_.reserve (builder.size ());
+  nodes_.push_back (node {0, 0, 0, none});
+  std::vector<int> order (1, 0);  // builder node of each node
+  for (std::size_t i = 0; i < order.size (); ++i)
+    {
+      auto const& children = builder[order[i]].children_;
+      nodes_[i].children_ = qint32 (nodes_.size ());
+      nodes_[i].children_count_ = quint16 (children.size ());
+      for (auto const& child : children)
+        {
+          nodes_.push_back (node {child.first, 0, 0, builder[child.second].prefix_});
+          order.push_back (child.second);
+        }
+    }
+}
+
+int prefix_trie::child (int n, QChar c) const
+{
+  if (nodes_.empty ()) return none;
+  auto begin = nodes_.begin () + nodes_[n].children_;
+  auto end = begin + nodes_[n].children_count_;
+  auto child = std::lower_bound (begin, end, c.unicode (), [] (node const& lhs, ushort rhs) {
+      return lhs.char_ < rhs;
+    });
+  return child != end && child->char_ == c.unicode () ? int (child - nodes_.begin ()) : none;
+}
+
+int prefix_trie::find (QString const& s) const
+{
+  int n {root};
+  for (int i = 0; i < s.size () && none != n; ++i)
+    {
+      n = child (n, s[i]);
+    }
+  return n;
+}
+
+//
+// cty_table - one load of cty.dat
+//
+//  Never changed once built, a reload builds a new one, so any number
+//  of threads may look up calls in it concurrently. The memo of recent
+//  lookups in front of it is the only mutable part; a thread that finds
+//  it busy looks the call up directly rather than wait for it.
+//
+class cty_table final
 {
 public:
+  using Record = AD1CCty::Record;
   using entity_by_id = entities_type::index<id>::type;
 
-  explicit impl (Configuration const * configuration)
-    : configuration_ {configuration}
+  explicit cty_table (entities_type&& entities, std::vector<prefix>&& prefixes, QString const& version_date)
+    : entities_ (std::move (entities))
+    , prefixes_ (std::move (prefixes))
+    , version_date_ {version_date}
   {
+    trie_.build (prefixes_);
   }
 
-  QString get_cty_path(const Configuration *configuration);
-  void load_cty(QFile &file);
+  cty_table ()
+  {
+  }
+
+  Record lookup (QString const& call) const;
 
+  bool recall (QString const& call, Record& record) const;
+  void remember (QString const& call, Record const& record) const;
+
+  QString const& version_date () const {return version_date_;}
+
+private:
   entity_by_id::iterator lookup_entity (QString call, prefix const& p) const
   {
     call = call.toUpper ();
@@ -211,7 +333,7 @@ public:
         result.latitude = fix[0].toFloat (&ok3);
         result.longtitude = fix[1].toFloat (&ok4);
       }
-    if (override_value (p.prefix_, '{', '}', value)) result.continent = continent (value);
+    if (override_value (p.prefix_, '{', '}', value)) result.continent = AD1CCty::continent (value);
     if (override_value (p.prefix_, '~', '~', value)) result.UTC_offset = static_cast<int> (value.toFloat (&ok5) * 60 * 60);
     if (!(ok1 && ok2 && ok3 && ok4 && ok5))
       {
@@ -231,13 +353,123 @@ public:
     return false;
   }
 
+  entities_type entities_;
+  std::vector<prefix> prefixes_;
+  prefix_trie trie_;
+  QString version_date_;
+
+  // recent lookups, most recent first
+  struct recent
+  {
+    QString call_;
+    Record record_;
+  };
+  typedef multi_index_container<
+    recent,
+    indexed_by<
+      sequenced<>,
+      hashed_unique<member<recent, QString, &recent::call_>, hash_QString> >
+    > recent_type;
+  static std::size_t const recent_capacity {1024};
+
+  mutable QMutex recent_mutex_;
+  mutable recent_type recent_;
+};
+
+std::size_t const cty_table::recent_capacity;
+
+auto cty_table::lookup (QString const& call) const -> Record
+{
+  auto const& exact_search = call.toUpper ();
+  if (!(exact_search.endsWith ("/MM") || exact_search.endsWith ("/AM")))
+    {
+      auto search_prefix = Radio::effective_prefix (exact_search);
+      if (search_prefix != exact_search)
+        {
+          auto n = trie_.find (exact_search);
+          if (prefix_trie::none != n && prefix_trie::none != trie_.prefix_at (n))
+            {
+              auto const& p = prefixes_[trie_.prefix_at (n)];
+              if (p.exact_)
+                {
+                  return fixup (p, *lookup_entity (call, p));
+                }
+            }
+        }
+
+      // the longest prefix of the search prefix that is not an exact
+      // match only entry, unless it is the whole call
+      int match {prefix_trie::none};
+      int n {prefix_trie::root};
+      for (int length = 1; length <= search_prefix.size (); ++length)
+        {
+          n = trie_.child (n, search_prefix[length - 1]);
+          if (prefix_trie::none == n) break;
+          auto i = trie_.prefix_at (n);
+          if (prefix_trie::none != i && (!prefixes_[i].exact_ || call.size () == length))
+            {
+              match = i;
+            }
+        }
+      if (prefix_trie::none != match)
+        {
+          auto const& p = prefixes_[match];
+          // always lookup WAE entities, we substitute them later in displaytext.cpp if "Include extra WAE entites" is not selected
+          return fixup (p, *lookup_entity (call, p));
+        }
+    }
+  return Record {};
+}
+
+bool cty_table::recall (QString const& call, Record& record) const
+{
+  if (!recent_mutex_.tryLock ()) return false;
+  auto const& index = recent_.get<1> ();
+  auto r = index.find (call);
+  bool found {r != index.end ()};
+  if (found)
+    {
+      recent_.relocate (recent_.begin (), recent_.project<0> (r));
+      record = r->record_;
+    }
+  recent_mutex_.unlock ();
+  return found;
+}
+
+void cty_table::remember (QString const& call, Record const& record) const
+{
+  if (!recent_mutex_.tryLock ()) return;
+  if (recent_.push_front (recent {call, record}).second && recent_.size () > recent_capacity)
+    {
+      recent_.pop_back ();
+    }
+  recent_mutex_.unlock ();
+}
+
+class AD1CCty::impl final
+{
+public:
+  explicit impl (Configuration const * configuration)
+    : configuration_ {configuration}
+    , table_ {std::make_shared<cty_table> ()}
+  {
+  }
+
+  QString get_cty_path(const Configuration *configuration);
+  void load_cty(QFile &file);
+
+  // the current table, readers keep the one they got for as long as
+  // they use it
+  std::shared_ptr<cty_table const> table () const
+  {
+    return std::atomic_load (&table_);
+  }
+
   Configuration const * configuration_;
   QString path_;
   QString cty_version_;
-  QString cty_version_date_;
 
-  entities_type entities_;
-  prefixes_type prefixes_;
+  std::shared_ptr<cty_table const> table_;
 };
 
 AD1CCty::Record::Record ()
@@ -337,10 +569,9 @@ void AD1CCty::impl::load_cty(QFile &file)
   int entity_id = 0;
   int line_number{0};
 
-  entities_.clear();
-  prefixes_.clear();
-  cty_version_ = QString{};
-  cty_version_date_ = QString{};
+  entities_type entities;
+  std::vector<prefix> prefixes;
+  QString version_date;
 
   QTextStream in{&file};
   while (!in.atEnd())
@@ -360,7 +591,7 @@ void AD1CCty::impl::load_cty(QFile &file)
           WAE_only = true;
         }
         bool ok1, ok2, ok3, ok4, ok5;
-        entities_.emplace(++entity_id, entity_parts[0].trimmed(), WAE_only, entity_parts[1].trimmed().toInt(&ok1),
+        entities.emplace(++entity_id, entity_parts[0].trimmed(), WAE_only, entity_parts[1].trimmed().toInt(&ok1),
                           entity_parts[2].trimmed().toInt(&ok2), continent(entity_parts[3].trimmed()),
                           entity_parts[4].trimmed().toFloat(&ok3), entity_parts[5].trimmed().toFloat(&ok4),
                           static_cast<int> (entity_parts[6].trimmed().toFloat(&ok5) * 60 * 60), primary_prefix);
@@ -386,14 +617,16 @@ void AD1CCty::impl::load_cty(QFile &file)
             // match version pattern to prefix
             if (version_pattern.match(prefix).hasMatch())
             {
-              cty_version_date_ = prefix;
+              version_date = prefix;
             }
           }
-          prefixes_.emplace(prefix, exact, entity_id);
+          prefixes.emplace_back(prefix, exact, entity_id);
         }
       }
     }
   }
+  std::atomic_store (&table_, std::shared_ptr<cty_table const> {
+      std::make_shared<cty_table> (std::move (entities), std::move (prefixes), version_date)});
 }
 
 AD1CCty::AD1CCty (Configuration const * configuration)
@@ -418,7 +651,7 @@ void AD1CCty::reload(Configuration const * configuration)
     m_->impl::load_cty(file);
     m_->cty_version_ = AD1CCty::lookup("VERSION").entity_name;
     Q_EMIT cty_loaded(m_->cty_version_);
-    LOG_INFO(QString{"Loaded CTY.DAT version %1, %2"}.arg (m_->cty_version_date_).arg (m_->cty_version_));
+    LOG_INFO(QString{"Loaded CTY.DAT version %1, %2"}.arg (version ()).arg (m_->cty_version_));
   }
 }
 
@@ -428,36 +661,17 @@ AD1CCty::~AD1CCty ()
 
 auto AD1CCty::lookup (QString const& call) const -> Record
 {
-  auto const& exact_search = call.toUpper ();
-  if (!(exact_search.endsWith ("/MM") || exact_search.endsWith ("/AM")))
+  auto table = m_->table ();
+  Record result;
+  if (!table->recall (call, result))
     {
-      auto search_prefix = Radio::effective_prefix (exact_search);
-      if (search_prefix != exact_search)
-        {
-          auto p = m_->prefixes_.find (exact_search);
-          if (p != m_->prefixes_.end () && p->exact_)
-            {
-              return m_->fixup (*p, *m_->lookup_entity (call, *p));
-            }
-        }
-      while (search_prefix.size ())
-        {
-          auto p = m_->prefixes_.find (search_prefix);
-          if (p != m_->prefixes_.end ())
-            {
-              impl::entity_by_id::iterator e = m_->lookup_entity (call, *p);
-              // always lookup WAE entities, we substitute them later in displaytext.cpp if "Include extra WAE entites" is not selected
-              if (!p->exact_ || call.size () == search_prefix.size ())
-                {
-                  return m_->fixup (*p, *e);
-                }
-            }
-          search_prefix = search_prefix.left (search_prefix.size () - 1);
-        }
+      result = table->lookup (call);
+      table->remember (call, result);
     }
-  return Record {};
+  return result;
 }
+
 auto AD1CCty::version () const -> QString
 {
-  return m_->cty_version_date_;
+  return m_->table ()->version_date ();
 }
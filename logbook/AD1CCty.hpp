@@ -11,6 +11,9 @@ class Configuration;
 //
 // AD1CCty  - Fast  access database  of Jim  Reisert, AD1C's,  cty.dat
 // 						entity and entity override information file.
+//
+//  lookup() and version() may be called from any thread, including
+//  while reload() is replacing the database.
 // 
 class AD1CCty final
   : public QObject
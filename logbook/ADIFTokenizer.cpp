@@ -0,0 +1,63 @@
+#include "ADIFTokenizer.hpp"
+
+#include <cstring>
+
+#include <QByteArray>
+
+ADIFTokenizer::ADIFTokenizer (char const * begin, char const * end)
+  : begin_ {begin}
+  , end_ {end}
+  , pos_ {begin}
+  , name_ {nullptr}
+  , name_length_ {0}
+  , value_ {nullptr}
+  , value_length_ {0}
+  , valid_ {false}
+{
+}
+
+bool ADIFTokenizer::is (char const * name) const
+{
+  return int (qstrlen (name)) == name_length_ && !qstrnicmp (name_, name, name_length_);
+}
+
+auto ADIFTokenizer::next () -> Token
+{
+  auto tag = static_cast<char const *> (std::memchr (pos_, '<', end_ - pos_));
+  auto close = tag ? static_cast<char const *> (std::memchr (tag, '>', end_ - tag)) : nullptr;
+  if (!close)
+    {
+      pos_ = end_;
+      return Token::end;
+    }
+  name_ = tag + 1;
+  auto colon = static_cast<char const *> (std::memchr (name_, ':', close - name_));
+  name_length_ = int ((colon ? colon : close) - name_);
+  value_ = close + 1;
+  value_length_ = 0;
+  if (!colon)
+    {
+      pos_ = close + 1;
+      if (is ("EOR")) return Token::end_of_record;
+      if (is ("EOH")) return Token::end_of_header;
+      valid_ = false;
+      return Token::field;
+    }
+
+  // <name:length> or <name:length:type>
+  qint64 length {0};
+  auto p = colon + 1;
+  for (; p != close && *p >= '0' && *p <= '9' && length <= end_ - value_; ++p)
+    {
+      length = 10 * length + (*p - '0');
+    }
+  valid_ = p != colon + 1 && (p == close || ':' == *p);
+  if (length > end_ - value_)
+    {
+      pos_ = end_;
+      return Token::end;
+    }
+  value_length_ = int (length);
+  pos_ = value_ + value_length_;
+  return Token::field;
+}
@@ -0,0 +1,54 @@
+#ifndef ADIF_TOKENIZER_HPP_
+#define ADIF_TOKENIZER_HPP_
+
+#include <QtGlobal>
+
+//
+// ADIFTokenizer - split ADIF text into its data specifiers in one pass
+//
+//  Works on text in memory, a memory mapped log for example, and
+//  copies nothing; names and values point into the text, which must
+//  outlive the tokenizer. Values are skipped by their specified length
+//  so they may contain anything, including '<'. Text between data
+//  specifiers, such as a header's free text, is ignored.
+//
+//  A data specifier or value cut short by the end of the text ends the
+//  tokens, as a record still being written has no <EOR> yet.
+//
+class ADIFTokenizer final
+{
+public:
+  enum class Token {field, end_of_header, end_of_record, end};
+
+  ADIFTokenizer (char const * begin, char const * end);
+
+  Token next ();
+
+  // the current field's name and value
+  bool is (char const * name) const; // case insensitive
+  char const * name () const {return name_;}
+  int name_length () const {return name_length_;}
+  char const * value () const {return value_;}
+  int value_length () const {return value_length_;}
+
+  // false if the field had no length or an unreadable one
+  bool valid () const {return valid_;}
+
+  // true if the field had a length, readable or not
+  bool sized () const {return name_ + name_length_ != value_ - 1;}
+
+  // offset of the text after the last token
+  qint64 position () const {return pos_ - begin_;}
+
+private:
+  char const * begin_;
+  char const * end_;
+  char const * pos_;
+  char const * name_;
+  int name_length_;
+  char const * value_;
+  int value_length_;
+  bool valid_;
+};
+
+#endif
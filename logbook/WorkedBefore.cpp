@@ -1,13 +1,7 @@
 #include "WorkedBefore.hpp"
 
-#include <functional>
+#include <utility>
 #include <stdexcept>
-#include <boost/functional/hash.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/key_extractors.hpp>
-#include <boost/range/iterator_range.hpp>
 #include <QCoreApplication>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QFuture>
@@ -19,209 +13,22 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
+#include <QDataStream>
+#include <QCryptographicHash>
 #include <QDateTime>
+#include <QSharedPointer>
 #include "Configuration.hpp"
 #include "revision_utils.hpp"
 #include "Logger.hpp"
 #include "qt_helpers.hpp"
 #include "pimpl_impl.hpp"
+#include "ADIFTokenizer.hpp"
+#include "WorkedBeforeDatabase.hpp"
 
 #include "moc_WorkedBefore.cpp"
 
-using namespace boost::multi_index;
-
-// hash function for QString members in hashed indexes
-inline
-std::size_t hash_value (QString const& s)
-{
-  return std::hash<QString> {} (s);
-}
-
-//
-// worked before set element
-//
-struct worked_entry
-{
-  explicit worked_entry (QString const& call, QString const& grid, QString const& band
-                         , QString const& mode, QString const& country, AD1CCty::Continent continent
-                         , int CQ_zone, int ITU_zone)
-    : call_ {call}
-    , grid_ {grid}
-    , band_ {band}
-    , mode_ {mode}
-    , country_ {country}
-    , continent_ {continent}
-    , CQ_zone_ {CQ_zone}
-    , ITU_zone_ {ITU_zone}
-  {
-  }
-
-  QString call_;
-  QString grid_;
-  QString band_;
-  QString mode_;
-  QString country_;
-  AD1CCty::Continent continent_;
-  int CQ_zone_;
-  int ITU_zone_;
-};
-
-bool operator == (worked_entry const& lhs, worked_entry const& rhs)
-{
-  return
-    lhs.continent_ == rhs.continent_  // check 1st as it is fast
-    && lhs.CQ_zone_ == rhs.CQ_zone_   // ditto
-    && lhs.ITU_zone_ == rhs.ITU_zone_ // ditto
-    && lhs.call_ == rhs.call_         // check the rest in decreasing
-    && lhs.grid_ == rhs.grid_         // domain size order to shortcut
-    && lhs.country_ == rhs.country_   // differences as quickly as possible
-    && lhs.band_ == rhs.band_
-    && lhs.mode_ == rhs.mode_;
-}
-
-std::size_t hash_value (worked_entry const& we)
-{
-  std::size_t seed {0};
-  boost::hash_combine (seed, we.call_);
-  boost::hash_combine (seed, we.grid_);
-  boost::hash_combine (seed, we.band_);
-  boost::hash_combine (seed, we.mode_);
-  boost::hash_combine (seed, we.country_);
-  boost::hash_combine (seed, we.continent_);
-  boost::hash_combine (seed, we.CQ_zone_);
-  boost::hash_combine (seed, we.ITU_zone_);
-  return seed;
-}
-
-#if !defined (QT_NO_DEBUG_STREAM)
-QDebug operator << (QDebug dbg, worked_entry const& e)
-{
-  QDebugStateSaver saver {dbg};
-  dbg.nospace () << "worked_entry("
-                 << e.call_ << ", "
-                 << e.grid_ << ", "
-                 << e.band_ << ", "
-                 << e.mode_ << ", "
-                 << e.country_ << ", "
-                 << e.continent_ << ", "
-                 << e.CQ_zone_ << ", "
-                 << e.ITU_zone_ << ')';
-  return dbg;
-}
-#endif
-
-// less then predidate for the Continent enum class, needed for
-// ordered indexes
-struct Continent_less
-{
-  bool operator () (AD1CCty::Continent lhs, AD1CCty::Continent rhs) const
-  {
-    return static_cast<int> (lhs) < static_cast<int> (rhs);
-  }
-};
-
-// index tags
-struct call_mode_band {};
-struct call_band {};
-struct grid_mode_band {};
-struct grid_band {};
-struct entity_mode_band {};
-struct entity_band {};
-struct continent_mode_band {};
-struct continent_band {};
-struct CQ_zone_mode_band {};
-struct CQ_zone_band {};
-struct ITU_zone_mode_band {};
-struct ITU_zone_band {};
-
-// set with multiple ordered unique indexes that allow for optimally
-// efficient determination of various categories of worked before
-// status
-typedef multi_index_container<
-  worked_entry,
-  indexed_by<
-    // basic unordered set constraint - we don't need duplicate worked entries
-    hashed_unique<identity<worked_entry>>,
-
-    //
-    // The following indexes are used to discover worked before stuff.
-    //
-    // They are ordered so as to support partial lookups and
-    // non-unique because container inserts must be valid for all
-    // indexes.
-    //
-
-    // call+mode+band
-    ordered_non_unique<tag<call_mode_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, QString, &worked_entry::call_>,
-                                     member<worked_entry, QString, &worked_entry::mode_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // call+band
-    ordered_non_unique<tag<call_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, QString, &worked_entry::call_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // grid+mode+band
-    ordered_non_unique<tag<grid_mode_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, QString, &worked_entry::grid_>,
-                                     member<worked_entry, QString, &worked_entry::mode_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // grid+band
-    ordered_non_unique<tag<grid_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, QString, &worked_entry::grid_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // country+mode+band
-    ordered_non_unique<tag<entity_mode_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, QString, &worked_entry::country_>,
-                                     member<worked_entry, QString, &worked_entry::mode_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // country+band
-    ordered_non_unique<tag<entity_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, QString, &worked_entry::country_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // continent+mode+band
-    ordered_non_unique<tag<continent_mode_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, AD1CCty::Continent, &worked_entry::continent_>,
-                                     member<worked_entry, QString, &worked_entry::mode_>,
-                                     member<worked_entry, QString, &worked_entry::band_> >,
-                       composite_key_compare<Continent_less, std::less<QString>, std::less<QString> > >,
-    // continent+band
-    ordered_non_unique<tag<continent_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, AD1CCty::Continent, &worked_entry::continent_>,
-                                     member<worked_entry, QString, &worked_entry::band_> >,
-                       composite_key_compare<Continent_less, std::less<QString> > >,
-    // CQ-zone+mode+band
-    ordered_non_unique<tag<CQ_zone_mode_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, int, &worked_entry::CQ_zone_>,
-                                     member<worked_entry, QString, &worked_entry::mode_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // CQ-zone+band
-    ordered_non_unique<tag<CQ_zone_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, int, &worked_entry::CQ_zone_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // ITU-zone+mode+band
-    ordered_non_unique<tag<ITU_zone_mode_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, int, &worked_entry::ITU_zone_>,
-                                     member<worked_entry, QString, &worked_entry::mode_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > >,
-    // ITU-zone+band
-    ordered_non_unique<tag<ITU_zone_band>,
-                       composite_key<worked_entry,
-                                     member<worked_entry, int, &worked_entry::ITU_zone_>,
-                                     member<worked_entry, QString, &worked_entry::band_> > > >
-  > worked_before_database_type;
-
 namespace
 {
   auto const logFileName = "wsjtx_log.adi";
@@ -240,118 +47,223 @@ namespace
     QString error_;
   };
 
-  QString extractField (QString const& record, QString const& fieldName)
+  // A snapshot of the worked before set as loaded from the log, so
+  // that the next load need only parse records appended since. The
+  // symbols are stored in order followed by the entries.
+  auto const snapshotFileName = "wsjtx_log.worked";
+  quint32 const snapshot_magic {0x57424653}; // "WBFS"
+  qint32 const snapshot_version {3};
+
+  struct Snapshot
+  {
+    QString cty_version;
+    qint64 log_size {0};
+    qint64 log_modified {0};
+    qint64 parsed {0};          // offset after the last record in the snapshot
+    QByteArray check;           // SHA-1 of the log before parsed
+  };
+
+  QByteArray log_check (char const * data, qint64 parsed)
+  {
+    QCryptographicHash hash {QCryptographicHash::Sha1};
+    hash.addData (data, static_cast<int> (parsed));
+    return hash.result ();
+  }
+
+  // Load the snapshot into data if it was made from the log as it
+  // still is up to the snapshot's end, returns the offset to parse from
+  qint64 read_snapshot (QString const& path, Snapshot const& log, char const * data
+                        , WorkedBeforeDatabase& database)
   {
-    int fieldNameIndex = record.indexOf ('<' + fieldName + ':', 0, Qt::CaseInsensitive);
-    if (fieldNameIndex >=0)
+    QFile file {path};
+    if (!file.open (QFile::ReadOnly)) return 0;
+    QDataStream in {&file};
+    in.setVersion (QDataStream::Qt_5_0);
+    quint32 magic {0};
+    qint32 version {0};
+    Snapshot snapshot;
+    in >> magic >> version;
+    if (snapshot_magic != magic || snapshot_version != version) return 0;
+    in >> snapshot.cty_version >> snapshot.log_size >> snapshot.log_modified >> snapshot.parsed >> snapshot.check;
+    if (in.status () != QDataStream::Ok
+        || snapshot.cty_version != log.cty_version
+        || snapshot.parsed > log.log_size)
       {
-        int closingBracketIndex = record.indexOf('>',fieldNameIndex);
-        int fieldLengthIndex = record.indexOf(':',fieldNameIndex);  // find the size delimiter
-        int dataTypeIndex = -1;
-        if (fieldLengthIndex >= 0)
+        return 0;
+      }
+    if ((snapshot.log_size != log.log_size || snapshot.log_modified != log.log_modified)
+        && snapshot.check != log_check (data, snapshot.parsed))
+      {
+        return 0;               // not just appended to
+      }
+
+    // the symbols in order so they get the same IDs
+    quint32 n;
+    in >> n;
+    for (quint32 i = 0; i < n && in.status () == QDataStream::Ok; ++i)
+      {
+        QString s;
+        in >> s;
+        if (database.symbols.intern (s) != i) in.setStatus (QDataStream::ReadCorruptData);
+      }
+    in >> n;
+    auto const size = static_cast<quint32> (database.symbols.size ());
+    for (quint32 i = 0; i < n && in.status () == QDataStream::Ok; ++i)
+      {
+        quint32 call, grid, field, band, mode, country;
+        qint8 continent, CQ_zone, ITU_zone;
+        in >> call >> grid >> field >> band >> mode >> country >> continent >> CQ_zone >> ITU_zone;
+        if (call >= size || grid >= size || field >= size || band >= size || mode >= size || country >= size)
           {
-            dataTypeIndex = record.indexOf(':',fieldLengthIndex+1);  // check for a second : indicating there is a data type
-            if (dataTypeIndex > closingBracketIndex)
-              dataTypeIndex = -1; // second : was found but it was beyond the closing >
+            in.setStatus (QDataStream::ReadCorruptData);
+            break;
           }
-        else
+        database.worked.emplace (call, grid, field, band, mode, country
+                                 , static_cast<AD1CCty::Continent> (continent), CQ_zone, ITU_zone);
+      }
+    if (in.status () != QDataStream::Ok)
+      {
+        database = WorkedBeforeDatabase {};
+        return 0;
+      }
+    return snapshot.parsed;
+  }
+
+  void write_snapshot (QString const& path, Snapshot const& snapshot
+                       , WorkedBeforeDatabase const& database)
+  {
+    QSaveFile file {path};
+    if (!file.open (QSaveFile::WriteOnly)) return;
+    QDataStream out {&file};
+    out.setVersion (QDataStream::Qt_5_0);
+    out << snapshot_magic << snapshot_version
+        << snapshot.cty_version << snapshot.log_size << snapshot.log_modified << snapshot.parsed << snapshot.check;
+    out << static_cast<quint32> (database.symbols.size ());
+    for (int i = 0; i < database.symbols.size (); ++i) out << database.symbols.string (i);
+    out << static_cast<quint32> (database.worked.size ());
+    for (auto const& entry : database.worked)
+      {
+        out << entry.call_ << entry.grid_ << entry.field_ << entry.band_ << entry.mode_ << entry.country_
+            << entry.continent_ << entry.CQ_zone_ << entry.ITU_zone_;
+      }
+    if (out.status () == QDataStream::Ok) file.commit ();
+  }
+
+  // Parse the records in data from offset, which is the start of the
+  // log or just after a record. Returns the offset after the last
+  // complete record.
+  qint64 parse_log (char const * data, qint64 size, qint64 offset
+                    , WorkedBeforeDatabase& database, AD1CCty const * prefixes)
+  {
+    using Token = ADIFTokenizer::Token;
+    ADIFTokenizer tokens {data + offset, data + size};
+    if (!offset && size && '<' != *data) // skip header
+      {
+        Token token;
+        while (Token::end != (token = tokens.next ()) && Token::end_of_header != token) {}
+        if (Token::end_of_header != token)
           {
-            throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Invalid ADIF field %0: %1").arg (fieldName).arg (record).toLocal8Bit ()});
+            throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Invalid ADIF header").toLocal8Bit ()});
           }
+      }
 
-        if (closingBracketIndex > fieldNameIndex && fieldLengthIndex > fieldNameIndex && fieldLengthIndex < closingBracketIndex)
+    struct Value
+    {
+      char const * data;
+      int size;
+      QString string () const {return QString::fromUtf8 (data, size);}
+    };
+    Value call {nullptr, 0}, grid {nullptr, 0}, band {nullptr, 0}, mode {nullptr, 0}, submode {nullptr, 0};
+    auto parsed = offset;
+    auto record = tokens.position ();
+    while (true)
+      {
+        switch (tokens.next ())
           {
-            int fieldLengthCharCount = closingBracketIndex - fieldLengthIndex -1;
-            if (dataTypeIndex >= 0)
-              fieldLengthCharCount -= 2; // data type indicator is always a colon followed by a single character
-            QString fieldLengthString = record.mid(fieldLengthIndex+1,fieldLengthCharCount);
-            int fieldLength = fieldLengthString.toInt();
-            if (fieldLength > 0)
+          case Token::field:
+            {
+              for (auto const& wanted : {std::make_pair ("CALL", &call), std::make_pair ("GRIDSQUARE", &grid)
+                    , std::make_pair ("BAND", &band), std::make_pair ("MODE", &mode)
+                    , std::make_pair ("SUBMODE", &submode)})
+                {
+                  if (tokens.is (wanted.first))
+                    {
+                      if (!tokens.valid ())
+                        {
+                          auto text = QString::fromUtf8 (data + offset + record, tokens.position () - record).trimmed ();
+                          if (!tokens.sized ())
+                            {
+                              throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Invalid ADIF field %0: %1").arg (wanted.first).arg (text).toLocal8Bit ()});
+                            }
+                          throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Malformed ADIF field %0: %1").arg (wanted.first).arg (text).toLocal8Bit ()});
+                        }
+                      *wanted.second = Value {tokens.value (), tokens.value_length ()};
+                      break;
+                    }
+                }
+            }
+            break;
+
+          case Token::end_of_record:
+            if (call.size)    // require CALL field before we will
+                              // parse a record
               {
-                return record.mid(closingBracketIndex+1,fieldLength);
+                auto const& entity = prefixes->lookup (call.string ());
+                auto mode_name = mode.string ().toUpper ();
+                if (!mode_name.size () || "MFSK" == mode_name)
+                  {
+                    mode_name = submode.string ().toUpper ();
+                  }
+                database.add (call.string (), grid.string (), band.string (), mode_name, entity);
               }
-          }
-        else
-          {
-            throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Malformed ADIF field %0: %1").arg (fieldName).arg (record).toLocal8Bit ()});
+            call = grid = band = mode = submode = Value {nullptr, 0};
+            record = tokens.position ();
+            parsed = offset + record;
+            break;
+
+          case Token::end_of_header:
+            record = tokens.position ();
+            break;
+
+          case Token::end:
+            return parsed;
           }
       }
-    return QString {};
   }
 
-  worked_before_database_type loader (QString const& path, AD1CCty const * prefixes)
+  QSharedPointer<WorkedBeforeDatabase> loader (QString const& path, AD1CCty const * prefixes)
   {
-    worked_before_database_type worked;
+    auto database = QSharedPointer<WorkedBeforeDatabase>::create ();
     QFile inputFile {path};
     if (inputFile.exists ())
       {
         if (inputFile.open (QFile::ReadOnly))
           {
-            QTextStream in {&inputFile};
-            QString buffer;
-            bool pre_read {false};
-            int end_position {-1};
-
-            // skip optional header record
-            do
+            Snapshot log;
+            log.cty_version = prefixes->version ();
+            log.log_size = inputFile.size ();
+            log.log_modified = QFileInfo {inputFile}.lastModified ().toMSecsSinceEpoch ();
+
+            // parse the log in place
+            QByteArray contents;
+            char const * data = reinterpret_cast<char const *> (log.log_size ? inputFile.map (0, log.log_size) : nullptr);
+            if (!data)
               {
-                buffer += in.readLine () + '\n';
-                if (buffer.startsWith (QChar {'<'})) // denotes no header
-                  {
-                    pre_read = true;
-                  }
-                else
-                  {
-                    end_position = buffer.indexOf ("<EOH>", 0, Qt::CaseInsensitive);
-                  }
+                contents = inputFile.readAll ();
+                data = contents.constData ();
+                log.log_size = contents.size ();
               }
-            while (!in.atEnd () && !pre_read && end_position < 0);
-            if (!pre_read)            // found header
+
+            auto snapshot_path = QFileInfo {path}.absoluteDir ().absoluteFilePath (snapshotFileName);
+            auto offset = read_snapshot (snapshot_path, log, data, *database);
+            auto snapshot_size = database->worked.size ();
+            log.parsed = parse_log (data, log.log_size, offset, *database, prefixes);
+            LOG_DEBUG ("WorkedBefore: " << snapshot_size << " entries from the snapshot, "
+                       << log.log_size - offset << " bytes of the log parsed");
+            if (!offset || log.parsed != offset)
               {
-                if (end_position < 0)
-                  {
-                    throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Invalid ADIF header").toLocal8Bit ()});
-                  }
-                buffer.remove (0, end_position + 5);
-              }
-            while (!in.atEnd ())
-              {
-                end_position = buffer.indexOf ("<EOR>", 0, Qt::CaseInsensitive);
-                do
-                  {
-                    if (!in.atEnd () && end_position < 0)
-                      {
-                        buffer += in.readLine () + '\n';
-                      }
-                  }
-                while ((end_position = buffer.indexOf ("<EOR>", 0, Qt::CaseInsensitive)) < 0 && !in.atEnd ());
-                if (end_position >= 0) // require valid ADIF record
-                                       // with terminator
-                  {
-                    auto record = buffer.left (end_position + 5).trimmed ();
-                    auto next_record = buffer.indexOf (QChar {'<'}, end_position + 5);
-                    buffer.remove (0, next_record >=0 ? next_record : buffer.size ());
-                    record = record.mid (record.indexOf (QChar {'<'}));
-                    auto call = extractField (record, "CALL");
-                    if (call.size ()) // require CALL field before we
-                                      // will parse a record
-                      {
-                        auto const& entity = prefixes->lookup (call);
-                        auto mode = extractField (record, "MODE").toUpper ();
-                        if (!mode.size () || "MFSK" == mode)
-                          {
-                            mode = extractField (record, "SUBMODE").toUpper ();
-                          }
-                        worked.emplace (call.toUpper ()
-                                        , extractField (record, "GRIDSQUARE").left (4).toUpper () // not interested in 6-digit grids
-                                        , extractField (record, "BAND").toUpper ()
-                                        , mode
-                                        , entity.entity_name
-                                        , entity.continent
-                                        , entity.CQ_zone
-                                        , entity.ITU_zone);
-                      }
-                  }
+                log.check = log_check (data, log.parsed);
+                write_snapshot (snapshot_path, log, *database);
               }
           }
         else
@@ -359,7 +271,7 @@ namespace
             throw LoaderException (std::runtime_error {QCoreApplication::translate ("WorkedBefore", "Error opening ADIF log file for read: %0").arg (inputFile.errorString ()).toLocal8Bit ()});
           }
       }
-    return worked;
+    return database;
   }
 }
 
@@ -370,6 +282,7 @@ public:
     : configuration_ {configuration}
     , path_ {QDir {QStandardPaths::writableLocation (QStandardPaths::DataLocation)}.absoluteFilePath (logFileName)}
     , prefixes_ {configuration}
+    , database_ {QSharedPointer<WorkedBeforeDatabase>::create ()}
   {
   }
 
@@ -383,22 +296,22 @@ public:
   Configuration const * configuration_;
   QString path_;
   AD1CCty prefixes_;
-  QFutureWatcher<worked_before_database_type> loader_watcher_;
-  QFuture<worked_before_database_type> async_loader_;
-  worked_before_database_type worked_;
+  QFutureWatcher<QSharedPointer<WorkedBeforeDatabase>> loader_watcher_;
+  QFuture<QSharedPointer<WorkedBeforeDatabase>> async_loader_;
+  QSharedPointer<WorkedBeforeDatabase> database_;
 };
 
 WorkedBefore::WorkedBefore (Configuration const * configuration)
   : m_ {configuration}
 {
   Q_ASSERT (configuration);
-  connect (&m_->loader_watcher_, &QFutureWatcher<worked_before_database_type>::finished, [this] () {
+  connect (&m_->loader_watcher_, &QFutureWatcher<QSharedPointer<WorkedBeforeDatabase>>::finished, [this] () {
       QString error;
       size_t n {0};
       try
         {
-          m_->worked_ = m_->loader_watcher_.result ();
-          n = m_->worked_.size ();
+          m_->database_ = m_->loader_watcher_.result ();
+          n = m_->database_->worked.size ();
         }
       catch (LoaderException const& e)
         {
@@ -481,233 +394,41 @@ bool WorkedBefore::add (QString const& call
 #endif
                  ;
         }
-      m_->worked_.emplace (call.toUpper (), grid.left (4).toUpper (), band.toUpper (), mode.toUpper ()
-                           , entity.entity_name, entity.continent, entity.CQ_zone, entity.ITU_zone);
+      m_->database_->add (call, grid, band, mode, entity);
     }
   return true;
 }
 
 bool WorkedBefore::country_worked (QString const& country, QString const& mode, QString const& band) const
 {
-  if (mode.size ())
-    {
-      if (band.size ())
-        {
-          return
-            country.size ()
-            && m_->worked_.get<entity_mode_band> ().end ()
-            != m_->worked_.get<entity_mode_band> ().find (std::make_tuple (country, mode.toUpper (), band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return
-            country.size ()
-            && m_->worked_.get<entity_mode_band> ().end ()
-            != m_->worked_.get<entity_mode_band> ().find (std::make_tuple (country, mode.toUpper ()));
-        }
-    }
-  else
-    {
-      if (band.size ())
-        {
-          return
-            country.size ()
-            && m_->worked_.get<entity_band> ().end ()
-            != m_->worked_.get<entity_band> ().find (std::make_tuple (country, band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return
-            country.size ()
-            && m_->worked_.get<entity_band> ().end ()
-            != m_->worked_.get<entity_band> ().find (country);
-        }
-    }
+  return m_->database_->country_worked (country, mode, band);
 }
 
 bool WorkedBefore::grid_worked (QString const& grid, QString const& mode, QString const& band) const
 {
-  auto gridsquare = grid.left (4).toUpper ();
   if (m_->configuration_->highlight_only_fields ())
     {
-      // can't use a direct set find operation or a set operation with
-      // a (CompatibleKey, CompatibleCompare) concept so we must
-      // partially scan the index
-      auto range = boost::make_iterator_range (
-                                               m_->worked_.get<grid_mode_band> ().lower_bound (gridsquare.left (2))
-                                               , m_->worked_.get<grid_mode_band> ().upper_bound (gridsquare.left (2) + "99"));
-      for (worked_entry const& worked : range)
-        {
-          if ((!mode.size () || mode.toUpper () == worked.mode_)
-              && (!band.size () || worked.band_ == band.toUpper ()))
-            {
-              return true;
-            }
-        }
+      return m_->database_->field_worked (grid, mode, band);
     }
-  else
-    {
-      if (mode.size ())
-        {
-          if (band.size ())
-            {
-              return m_->worked_.get<grid_mode_band> ().end ()
-                != m_->worked_.get<grid_mode_band> ().find (std::make_tuple (gridsquare, mode.toUpper (), band.toUpper ()));
-            }
-          else
-            {
-              // partial key lookup
-              return m_->worked_.get<grid_mode_band> ().end ()
-                != m_->worked_.get<grid_mode_band> ().find (std::make_tuple (gridsquare, mode.toUpper ()));
-            }
-        }
-      else
-        {
-          if (band.size ())
-            {
-              return m_->worked_.get<grid_band> ().end ()
-                != m_->worked_.get<grid_band> ().find (std::make_tuple (gridsquare, band.toUpper ()));
-            }
-          else
-            {
-              // partial key lookup
-              return m_->worked_.get<grid_band> ().end ()
-                != m_->worked_.get<grid_band> ().find (gridsquare);
-            }
-        }
-    }
-  return false;
+  return m_->database_->grid_worked (grid, mode, band);
 }
 
 bool WorkedBefore::call_worked (QString const& call, QString const& mode, QString const& band) const
 {
-  if (mode.size ())
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<call_mode_band> ().end ()
-            != m_->worked_.get<call_mode_band> ().find (std::make_tuple (call.toUpper (), mode.toUpper (), band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<call_mode_band> ().end ()
-            != m_->worked_.get<call_mode_band> ().find (std::make_tuple (call.toUpper (), mode.toUpper ()));
-        }
-    }
-  else
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<call_band> ().end ()
-            != m_->worked_.get<call_band> ().find (std::make_tuple (call.toUpper (), band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<call_band> ().end ()
-            != m_->worked_.get<call_band> ().find (std::make_tuple (call.toUpper ()));
-        }
-    }
+  return m_->database_->call_worked (call, mode, band);
 }
 
 bool WorkedBefore::continent_worked (Continent continent, QString const& mode, QString const& band) const
 {
-  if (mode.size ())
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<continent_mode_band> ().end ()
-            != m_->worked_.get<continent_mode_band> ().find (std::make_tuple (continent, mode.toUpper (), band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<continent_mode_band> ().end ()
-            != m_->worked_.get<continent_mode_band> ().find (std::make_tuple (continent, mode.toUpper ()));
-        }
-    }
-  else
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<continent_band> ().end ()
-            != m_->worked_.get<continent_band> ().find (std::make_tuple (continent, band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<continent_band> ().end ()
-            != m_->worked_.get<continent_band> ().find (continent);
-        }
-    }
+  return m_->database_->continent_worked (continent, mode, band);
 }
 
 bool WorkedBefore::CQ_zone_worked (int CQ_zone, QString const& mode, QString const& band) const
 {
-  if (mode.size ())
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<CQ_zone_mode_band> ().end ()
-            != m_->worked_.get<CQ_zone_mode_band> ().find (std::make_tuple (CQ_zone, mode.toUpper (), band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<CQ_zone_mode_band> ().end ()
-            != m_->worked_.get<CQ_zone_mode_band> ().find (std::make_tuple (CQ_zone, mode.toUpper ()));
-        }
-    }
-  else
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<CQ_zone_band> ().end ()
-            != m_->worked_.get<CQ_zone_band> ().find (std::make_tuple (CQ_zone, band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<CQ_zone_band> ().end ()
-            != m_->worked_.get<CQ_zone_band> ().find (CQ_zone);
-        }
-    }
+  return m_->database_->CQ_zone_worked (CQ_zone, mode, band);
 }
 
-
 bool WorkedBefore::ITU_zone_worked (int ITU_zone, QString const& mode, QString const& band) const
 {
-  if (mode.size ())
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<ITU_zone_mode_band> ().end ()
-            != m_->worked_.get<ITU_zone_mode_band> ().find (std::make_tuple (ITU_zone, mode.toUpper (), band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<ITU_zone_mode_band> ().end ()
-            != m_->worked_.get<ITU_zone_mode_band> ().find (std::make_tuple (ITU_zone, mode.toUpper ()));
-        }
-    }
-  else
-    {
-      if (band.size ())
-        {
-          return m_->worked_.get<ITU_zone_band> ().end ()
-            != m_->worked_.get<ITU_zone_band> ().find (std::make_tuple (ITU_zone, band.toUpper ()));
-        }
-      else
-        {
-          // partial key lookup
-          return m_->worked_.get<ITU_zone_band> ().end ()
-            != m_->worked_.get<ITU_zone_band> ().find (ITU_zone);
-        }
-    }
+  return m_->database_->ITU_zone_worked (ITU_zone, mode, band);
 }
-
-
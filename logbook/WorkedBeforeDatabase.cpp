@@ -0,0 +1,127 @@
+#include "WorkedBeforeDatabase.hpp"
+
+#include <tuple>
+#include <boost/functional/hash.hpp>
+
+auto WorkedSymbols::intern (QString const& s) -> id_type
+{
+  auto i = ids_.constFind (s);
+  if (i != ids_.constEnd ()) return *i;
+  strings_ << s;
+  return *ids_.insert (s, static_cast<id_type> (strings_.size () - 1));
+}
+
+bool WorkedSymbols::find (QString const& s, id_type& id) const
+{
+  auto i = ids_.constFind (s);
+  if (i == ids_.constEnd ())
+    {
+      auto upper = s.toUpper ();
+      if (upper == s) return false;
+      i = ids_.constFind (upper);
+      if (i == ids_.constEnd ()) return false;
+    }
+  id = *i;
+  return true;
+}
+
+bool operator == (worked_entry const& lhs, worked_entry const& rhs)
+{
+  return
+    lhs.call_ == rhs.call_
+    && lhs.grid_ == rhs.grid_
+    && lhs.band_ == rhs.band_
+    && lhs.mode_ == rhs.mode_
+    && lhs.country_ == rhs.country_
+    && lhs.continent_ == rhs.continent_
+    && lhs.CQ_zone_ == rhs.CQ_zone_
+    && lhs.ITU_zone_ == rhs.ITU_zone_;
+}
+
+std::size_t hash_value (worked_entry const& we)
+{
+  std::size_t seed {0};
+  boost::hash_combine (seed, we.call_);
+  boost::hash_combine (seed, we.grid_);
+  boost::hash_combine (seed, we.band_);
+  boost::hash_combine (seed, we.mode_);
+  boost::hash_combine (seed, we.country_);
+  boost::hash_combine (seed, we.continent_);
+  boost::hash_combine (seed, we.CQ_zone_);
+  boost::hash_combine (seed, we.ITU_zone_);
+  return seed;
+}
+
+void WorkedBeforeDatabase::add (QString const& call, QString const& grid, QString const& band
+                                , QString const& mode, AD1CCty::Record const& entity)
+{
+  auto gridsquare = grid.left (4).toUpper (); // not interested in 6-digit grids
+  worked.emplace (symbols.intern (call.toUpper ())
+                  , symbols.intern (gridsquare)
+                  , symbols.intern (gridsquare.left (2))
+                  , symbols.intern (band.toUpper ())
+                  , symbols.intern (mode.toUpper ())
+                  , symbols.intern (entity.entity_name)
+                  , entity.continent
+                  , entity.CQ_zone
+                  , entity.ITU_zone);
+}
+
+template<typename ModeBandTag, typename BandTag, typename Key>
+bool WorkedBeforeDatabase::worked_before (Key key, QString const& mode, QString const& band) const
+{
+  WorkedSymbols::id_type mode_id {0}, band_id {0};
+  if (band.size () && !symbols.find (band, band_id)) return false;
+  if (mode.size ())
+    {
+      if (!symbols.find (mode, mode_id)) return false;
+      auto const& index = worked.get<ModeBandTag> ();
+      return band.size ()
+        ? index.end () != index.find (std::make_tuple (key, mode_id, band_id))
+        : index.end () != index.find (std::make_tuple (key, mode_id)); // partial key lookup
+    }
+  auto const& index = worked.get<BandTag> ();
+  return band.size ()
+    ? index.end () != index.find (std::make_tuple (key, band_id))
+    : index.end () != index.find (std::make_tuple (key)); // partial key lookup
+}
+
+bool WorkedBeforeDatabase::call_worked (QString const& call, QString const& mode, QString const& band) const
+{
+  WorkedSymbols::id_type id;
+  return symbols.find (call, id) && worked_before<call_mode_band, call_band> (id, mode, band);
+}
+
+bool WorkedBeforeDatabase::grid_worked (QString const& grid, QString const& mode, QString const& band) const
+{
+  WorkedSymbols::id_type id;
+  return symbols.find (grid.left (4), id) && worked_before<grid_mode_band, grid_band> (id, mode, band);
+}
+
+bool WorkedBeforeDatabase::field_worked (QString const& grid, QString const& mode, QString const& band) const
+{
+  WorkedSymbols::id_type id;
+  return symbols.find (grid.left (2), id) && worked_before<field_mode_band, field_band> (id, mode, band);
+}
+
+bool WorkedBeforeDatabase::country_worked (QString const& country, QString const& mode, QString const& band) const
+{
+  WorkedSymbols::id_type id;
+  return country.size () && symbols.find (country, id)
+    && worked_before<entity_mode_band, entity_band> (id, mode, band);
+}
+
+bool WorkedBeforeDatabase::continent_worked (AD1CCty::Continent continent, QString const& mode, QString const& band) const
+{
+  return worked_before<continent_mode_band, continent_band> (static_cast<qint8> (continent), mode, band);
+}
+
+bool WorkedBeforeDatabase::CQ_zone_worked (int CQ_zone, QString const& mode, QString const& band) const
+{
+  return worked_before<CQ_zone_mode_band, CQ_zone_band> (static_cast<qint8> (CQ_zone), mode, band);
+}
+
+bool WorkedBeforeDatabase::ITU_zone_worked (int ITU_zone, QString const& mode, QString const& band) const
+{
+  return worked_before<ITU_zone_mode_band, ITU_zone_band> (static_cast<qint8> (ITU_zone), mode, band);
+}
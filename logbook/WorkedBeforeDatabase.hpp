@@ -0,0 +1,171 @@
+#ifndef WORKED_BEFORE_DATABASE_HPP_
+#define WORKED_BEFORE_DATABASE_HPP_
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/key_extractors.hpp>
+#include <QtGlobal>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include "AD1CCty.hpp"
+
+//
+// WorkedSymbols - the strings of the worked before set, each once
+//
+//  Strings are interned in upper case and numbered from zero in the
+//  order they are first seen. A query string is looked up as given,
+//  then in upper case. Lookups change nothing so any number of threads
+//  may make them while none is interning.
+//
+class WorkedSymbols final
+{
+public:
+  using id_type = quint32;
+
+  id_type intern (QString const&);
+  bool find (QString const&, id_type&) const;
+  QString const& string (id_type id) const {return strings_[id];}
+  int size () const {return strings_.size ();}
+
+private:
+  QHash<QString, id_type> ids_;
+  QVector<QString> strings_;
+};
+
+//
+// worked before set element, every string as its symbol
+//
+struct worked_entry
+{
+  using id_type = WorkedSymbols::id_type;
+
+  explicit worked_entry (id_type call, id_type grid, id_type field, id_type band
+                         , id_type mode, id_type country, AD1CCty::Continent continent
+                         , int CQ_zone, int ITU_zone)
+    : call_ {call}
+    , grid_ {grid}
+    , field_ {field}
+    , band_ {band}
+    , mode_ {mode}
+    , country_ {country}
+    , continent_ {static_cast<qint8> (continent)}
+    , CQ_zone_ {static_cast<qint8> (CQ_zone)}
+    , ITU_zone_ {static_cast<qint8> (ITU_zone)}
+  {
+  }
+
+  id_type call_;
+  id_type grid_;                // four characters
+  id_type field_;               // the grid's first two
+  id_type band_;
+  id_type mode_;
+  id_type country_;
+  qint8 continent_;
+  qint8 CQ_zone_;
+  qint8 ITU_zone_;
+};
+
+bool operator == (worked_entry const&, worked_entry const&);
+std::size_t hash_value (worked_entry const&);
+
+// index tags
+struct call_mode_band {};
+struct call_band {};
+struct grid_mode_band {};
+struct grid_band {};
+struct field_mode_band {};
+struct field_band {};
+struct entity_mode_band {};
+struct entity_band {};
+struct continent_mode_band {};
+struct continent_band {};
+struct CQ_zone_mode_band {};
+struct CQ_zone_band {};
+struct ITU_zone_mode_band {};
+struct ITU_zone_band {};
+
+namespace worked_before_detail
+{
+  using namespace boost::multi_index;
+
+  using id_type = worked_entry::id_type;
+
+  // X+mode+band for full and X+mode and X partial lookups, X+band for
+  // the rest
+  template<typename ModeBandTag, typename BandTag, typename T, T worked_entry::* X>
+  struct indexes
+  {
+    using mode_band = ordered_non_unique<tag<ModeBandTag>,
+                                         composite_key<worked_entry,
+                                                       member<worked_entry, T, X>,
+                                                       member<worked_entry, id_type, &worked_entry::mode_>,
+                                                       member<worked_entry, id_type, &worked_entry::band_> > >;
+    using band = ordered_non_unique<tag<BandTag>,
+                                    composite_key<worked_entry,
+                                                  member<worked_entry, T, X>,
+                                                  member<worked_entry, id_type, &worked_entry::band_> > >;
+  };
+
+  using call_indexes = indexes<call_mode_band, call_band, id_type, &worked_entry::call_>;
+  using grid_indexes = indexes<grid_mode_band, grid_band, id_type, &worked_entry::grid_>;
+  using field_indexes = indexes<field_mode_band, field_band, id_type, &worked_entry::field_>;
+  using entity_indexes = indexes<entity_mode_band, entity_band, id_type, &worked_entry::country_>;
+  using continent_indexes = indexes<continent_mode_band, continent_band, qint8, &worked_entry::continent_>;
+  using CQ_zone_indexes = indexes<CQ_zone_mode_band, CQ_zone_band, qint8, &worked_entry::CQ_zone_>;
+  using ITU_zone_indexes = indexes<ITU_zone_mode_band, ITU_zone_band, qint8, &worked_entry::ITU_zone_>;
+}
+
+// set with multiple ordered indexes that allow for optimally efficient
+// determination of various categories of worked before status, all
+// keyed on integers
+typedef boost::multi_index::multi_index_container<
+  worked_entry,
+  boost::multi_index::indexed_by<
+    // basic unordered set constraint - we don't need duplicate worked entries
+    boost::multi_index::hashed_unique<boost::multi_index::identity<worked_entry>>,
+    worked_before_detail::call_indexes::mode_band,
+    worked_before_detail::call_indexes::band,
+    worked_before_detail::grid_indexes::mode_band,
+    worked_before_detail::grid_indexes::band,
+    worked_before_detail::field_indexes::mode_band,
+    worked_before_detail::field_indexes::band,
+    worked_before_detail::entity_indexes::mode_band,
+    worked_before_detail::entity_indexes::band,
+    worked_before_detail::continent_indexes::mode_band,
+    worked_before_detail::continent_indexes::band,
+    worked_before_detail::CQ_zone_indexes::mode_band,
+    worked_before_detail::CQ_zone_indexes::band,
+    worked_before_detail::ITU_zone_indexes::mode_band,
+    worked_before_detail::ITU_zone_indexes::band>
+  > worked_before_database_type;
+
+//
+// WorkedBeforeDatabase - the worked before set and its symbols
+//
+//  An empty mode or band in a query matches any.
+//
+class WorkedBeforeDatabase final
+{
+public:
+  void add (QString const& call, QString const& grid, QString const& band
+            , QString const& mode, AD1CCty::Record const& entity);
+
+  bool call_worked (QString const& call, QString const& mode, QString const& band) const;
+  bool grid_worked (QString const& grid, QString const& mode, QString const& band) const;
+  bool field_worked (QString const& grid, QString const& mode, QString const& band) const;
+  bool country_worked (QString const& country, QString const& mode, QString const& band) const;
+  bool continent_worked (AD1CCty::Continent, QString const& mode, QString const& band) const;
+  bool CQ_zone_worked (int CQ_zone, QString const& mode, QString const& band) const;
+  bool ITU_zone_worked (int ITU_zone, QString const& mode, QString const& band) const;
+
+  WorkedSymbols symbols;
+  worked_before_database_type worked;
+
+private:
+  template<typename ModeBandTag, typename BandTag, typename Key>
+  bool worked_before (Key, QString const& mode, QString const& band) const;
+};
+
+#endif
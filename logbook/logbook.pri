@@ -2,12 +2,16 @@ SOURCES += \
   logbook/countriesworked.cpp \
   logbook/logbook.cpp \
   logbook/AD1CCty.cpp \
+  logbook/ADIFTokenizer.cpp \
+  logbook/WorkedBeforeDatabase.cpp \
   logbook/WorkedBefore.cpp \
   logbook/Multiplier.cpp
 
 HEADERS  += \
+  logbook/WorkedBeforeDatabase.hpp \
   logbook/WorkedBefore.hpp \
   logbook/logbook.h \
   logbook/countriesworked.h \
   logbook/AD1CCty.hpp \
+  logbook/ADIFTokenizer.hpp \
   logbook/Multiplier.hpp
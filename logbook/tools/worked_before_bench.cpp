@@ -0,0 +1,262 @@
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+
+#include <boost/functional/hash.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/key_extractors.hpp>
+
+#include <QString>
+#include <QHash>
+
+#include "logbook/WorkedBeforeDatabase.hpp"
+
+//
+// Time what LogBook::match asks of the worked before set for each
+// decode, twice over for any band and the current band, against a
+// synthetic log. The interned database WorkedBefore uses is compared
+// with the QString keyed container it replaced, reproduced below with
+// the lookups it did.
+//
+//  usage: worked_before_bench [QSOs [decodes]]
+//
+namespace
+{
+  using clock_type = std::chrono::steady_clock;
+
+  double elapsed (clock_type::time_point start)
+  {
+    return std::chrono::duration<double> (clock_type::now () - start).count ();
+  }
+
+  // the previous representation, five strings per entry
+  struct legacy_entry
+  {
+    QString call_;
+    QString grid_;
+    QString band_;
+    QString mode_;
+    QString country_;
+    AD1CCty::Continent continent_;
+    int CQ_zone_;
+    int ITU_zone_;
+  };
+
+  bool operator == (legacy_entry const& lhs, legacy_entry const& rhs)
+  {
+    return lhs.continent_ == rhs.continent_ && lhs.CQ_zone_ == rhs.CQ_zone_ && lhs.ITU_zone_ == rhs.ITU_zone_
+      && lhs.call_ == rhs.call_ && lhs.grid_ == rhs.grid_ && lhs.country_ == rhs.country_
+      && lhs.band_ == rhs.band_ && lhs.mode_ == rhs.mode_;
+  }
+
+  std::size_t hash_value (legacy_entry const& e)
+  {
+    std::size_t seed {0};
+    for (auto const * s : {&e.call_, &e.grid_, &e.band_, &e.mode_, &e.country_})
+      {
+        boost::hash_combine (seed, qHash (*s));
+      }
+    boost::hash_combine (seed, static_cast<int> (e.continent_));
+    boost::hash_combine (seed, e.CQ_zone_);
+    boost::hash_combine (seed, e.ITU_zone_);
+    return seed;
+  }
+
+  struct Continent_less
+  {
+    bool operator () (AD1CCty::Continent lhs, AD1CCty::Continent rhs) const
+    {
+      return static_cast<int> (lhs) < static_cast<int> (rhs);
+    }
+  };
+
+  namespace legacy
+  {
+    using namespace boost::multi_index;
+
+    template<typename T, T legacy_entry::* X, typename Compare = std::less<T>>
+    struct indexes
+    {
+      using mode_band = ordered_non_unique<composite_key<legacy_entry,
+                                                         member<legacy_entry, T, X>,
+                                                         member<legacy_entry, QString, &legacy_entry::mode_>,
+                                                         member<legacy_entry, QString, &legacy_entry::band_> >,
+                                           composite_key_compare<Compare, std::less<QString>, std::less<QString> > >;
+      using band = ordered_non_unique<composite_key<legacy_entry,
+                                                    member<legacy_entry, T, X>,
+                                                    member<legacy_entry, QString, &legacy_entry::band_> >,
+                                      composite_key_compare<Compare, std::less<QString> > >;
+    };
+
+    using call = indexes<QString, &legacy_entry::call_>;
+    using grid = indexes<QString, &legacy_entry::grid_>;
+    using entity = indexes<QString, &legacy_entry::country_>;
+    using continent = indexes<AD1CCty::Continent, &legacy_entry::continent_, Continent_less>;
+    using CQ_zone = indexes<int, &legacy_entry::CQ_zone_>;
+    using ITU_zone = indexes<int, &legacy_entry::ITU_zone_>;
+
+    typedef multi_index_container<
+      legacy_entry,
+      indexed_by<hashed_unique<identity<legacy_entry>>,
+                 call::mode_band, call::band, grid::mode_band, grid::band,
+                 entity::mode_band, entity::band, continent::mode_band, continent::band,
+                 CQ_zone::mode_band, CQ_zone::band, ITU_zone::mode_band, ITU_zone::band>
+      > database;
+
+    // as the old WorkedBefore queries did, upper casing every argument
+    template<int N, typename Key>
+    bool worked (database const& db, Key const& key, QString const& mode, QString const& band)
+    {
+      if (mode.size ())
+        {
+          auto const& index = db.get<N> ();
+          return band.size ()
+            ? index.end () != index.find (std::make_tuple (key, mode.toUpper (), band.toUpper ()))
+            : index.end () != index.find (std::make_tuple (key, mode.toUpper ()));
+        }
+      auto const& index = db.get<N + 1> ();
+      return band.size ()
+        ? index.end () != index.find (std::make_tuple (key, band.toUpper ()))
+        : index.end () != index.find (std::make_tuple (key));
+    }
+  }
+
+  struct QSO
+  {
+    QString call;
+    QString grid;
+    QString band;
+    QString mode;
+    AD1CCty::Record entity;
+  };
+
+  std::vector<QSO> synthesize (int count, std::mt19937& rng)
+  {
+    static char const * const bands[] {"160m", "80m", "40m", "30m", "20m", "17m", "15m", "12m", "10m", "6m"};
+    static char const * const modes[] {"FT8", "FT4", "JT65", "JT9", "MSK144", "Q65", "FST4", "WSPR"};
+    std::vector<AD1CCty::Record> entities (340);
+    for (std::size_t i = 0; i < entities.size (); ++i)
+      {
+        entities[i].entity_name = QString {"Entity %1"}.arg (i);
+        entities[i].continent = static_cast<AD1CCty::Continent> (1 + i % 7);
+        entities[i].CQ_zone = 1 + i % 40;
+        entities[i].ITU_zone = 1 + i % 90;
+      }
+    std::uniform_int_distribution<int> station (0, count / 4);
+    std::uniform_int_distribution<int> letter (0, 17);
+    std::uniform_int_distribution<int> digit (0, 9);
+    std::vector<QSO> qsos;
+    qsos.reserve (count);
+    for (int i = 0; i < count; ++i)
+      {
+        auto n = station (rng);
+        QSO qso;
+        qso.call = QString {"%1%2%3"}.arg (QChar {'A' + n % 26}).arg (n % 10).arg (n / 10, 3, 36, QChar {'0'}).toUpper ();
+        qso.grid = QString {"%1%2%3%4"}.arg (QChar {'A' + letter (rng)}).arg (QChar {'A' + letter (rng)})
+          .arg (digit (rng)).arg (digit (rng));
+        qso.band = bands[rng () % 10];
+        qso.mode = modes[rng () % 8];
+        qso.entity = entities[n % entities.size ()];
+        qsos.push_back (qso);
+      }
+    return qsos;
+  }
+
+  void report (char const * name, double load_seconds, double match_seconds, int matches, int hits)
+  {
+    std::cout << std::left << std::setw (10) << name << std::right << std::fixed
+              << std::setprecision (0) << std::setw (8) << load_seconds * 1e3 << " ms to load"
+              << std::setw (10) << matches / match_seconds << " matches/s"
+              << std::setprecision (2) << std::setw (10) << match_seconds * 1e9 / matches << " ns/match"
+              << std::setw (8) << hits << " worked\n";
+  }
+}
+
+int main (int argc, char * argv[])
+{
+  try
+    {
+      int qso_count {400000};
+      int decodes {200000};
+      if (argc > 1) qso_count = std::stoi (argv[1]);
+      if (argc > 2) decodes = std::stoi (argv[2]);
+      if (qso_count <= 0 || decodes <= 0) throw std::invalid_argument {"arguments must be positive"};
+
+      std::mt19937 rng {1};
+      auto log = synthesize (qso_count, rng);
+      // decodes are of stations worked and not, mode and band are as
+      // the GUI passes them
+      auto heard = synthesize (decodes, rng);
+      for (std::size_t i = 0; i < heard.size (); i += 2) heard[i] = log[rng () % log.size ()];
+      QString const mode {"FT8"};
+      QString const band {"20m"};
+      std::cout << log.size () << " QSOs, " << heard.size () << " decodes, two matches each\n";
+
+      {
+        auto start = clock_type::now ();
+        legacy::database db;
+        for (auto const& q : log)
+          {
+            db.insert (legacy_entry {q.call.toUpper (), q.grid.left (4).toUpper (), q.band.toUpper ()
+                  , q.mode.toUpper (), q.entity.entity_name, q.entity.continent
+                  , q.entity.CQ_zone, q.entity.ITU_zone});
+          }
+        auto load = elapsed (start);
+        int hits {0};
+        start = clock_type::now ();
+        for (auto const& d : heard)
+          {
+            for (auto const& b : {QString {}, band})
+              {
+                hits += legacy::worked<1> (db, d.call.toUpper (), mode, b);
+                hits += legacy::worked<3> (db, d.grid.left (4).toUpper (), mode, b);
+                hits += legacy::worked<5> (db, d.entity.entity_name, mode, b);
+                hits += legacy::worked<7> (db, d.entity.continent, mode, b);
+                hits += legacy::worked<9> (db, d.entity.CQ_zone, mode, b);
+                hits += legacy::worked<11> (db, d.entity.ITU_zone, mode, b);
+              }
+          }
+        report ("QString", load, elapsed (start), 2 * decodes, hits);
+      }
+
+      {
+        auto start = clock_type::now ();
+        WorkedBeforeDatabase db;
+        for (auto const& q : log) db.add (q.call, q.grid, q.band, q.mode, q.entity);
+        auto load = elapsed (start);
+        int hits {0};
+        start = clock_type::now ();
+        for (auto const& d : heard)
+          {
+            for (auto const& b : {QString {}, band})
+              {
+                hits += db.call_worked (d.call, mode, b);
+                hits += db.grid_worked (d.grid, mode, b);
+                hits += db.country_worked (d.entity.entity_name, mode, b);
+                hits += db.continent_worked (d.entity.continent, mode, b);
+                hits += db.CQ_zone_worked (d.entity.CQ_zone, mode, b);
+                hits += db.ITU_zone_worked (d.entity.ITU_zone, mode, b);
+              }
+          }
+        report ("interned", load, elapsed (start), 2 * decodes, hits);
+        std::cout << db.symbols.size () << " symbols, " << db.worked.size () << " entries of "
+                  << sizeof (worked_entry) << " bytes, was " << sizeof (legacy_entry) << " plus five strings\n";
+      }
+    }
+  catch (std::exception const& e)
+    {
+      std::cerr << "Error: " << e.what () << '\n';
+      return -1;
+    }
+  return 0;
+}
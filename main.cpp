@@ -9,6 +9,7 @@
 #include <fftw3.h>
 
 #include <QSharedMemory>
+#include <QSystemSemaphore>
 #include <QProcessEnvironment>
 #include <QTemporaryFile>
 #include <QDateTime>
@@ -47,6 +48,7 @@
 #include "widgets/mainwindow.h"
 #include "commons.h"
 #include "lib/init_random_seed.h"
+#include "lib/shmem_events.h"
 #include "Radio.hpp"
 #include "models/FrequencyList.hpp"
 #include "widgets/SplashScreen.hpp"
@@ -382,6 +384,9 @@ int main(int argc, char *argv[])
                   mem_jt9.lock ();
                   dd->ipc[1] = 999; // tell jt9 to shut down
                   mem_jt9.unlock ();
+                  // wake it in case it is blocked on events rather than polling
+                  QSystemSemaphore {decode_start_event_key (mem_jt9.key ()), 0, QSystemSemaphore::Open}.release ();
+                  QSystemSemaphore {decode_ack_event_key (mem_jt9.key ()), 0, QSystemSemaphore::Open}.release ();
                   mem_jt9.detach (); // start again
                 }
               else
@@ -392,7 +397,8 @@ int main(int argc, char *argv[])
             }
           if (!mem_jt9.attach ())
             {
-              if (!mem_jt9.create (sizeof (dec_data)))
+              // room for the decode record ring after the shared decoder data
+              if (!mem_jt9.create (sizeof (dec_data) + sizeof (decode_records_t)))
               {
                 splash.hide ();
                 MessageBox::critical_message (nullptr, a.translate ("main", "Shared memory error"),
@@ -409,7 +415,7 @@ int main(int argc, char *argv[])
               throw std::runtime_error {"Sub-process error"};
             }
           mem_jt9.lock ();
-          memset(mem_jt9.data(),0,sizeof(struct dec_data)); //Zero all decoding params in shared memory
+          memset(mem_jt9.data(),0,mem_jt9.size()); //Zero all decoding params and records in shared memory
           mem_jt9.unlock ();
 
           unsigned downSampleFactor;
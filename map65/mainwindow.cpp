@@ -376,6 +376,7 @@ void MainWindow::writeSettings()
   settings.setValue("IQxt",m_bIQxt);
   settings.setValue("InitIQplus",m_initIQplus);
   settings.setValue("UDPport",m_udpPort);
+  settings.setValue("UDPBufferSize",m_udpBufferSize);
   settings.setValue("PaletteCuteSDR",ui->actionCuteSDR->isChecked());
   settings.setValue("PaletteLinrad",ui->actionLinrad->isChecked());
   settings.setValue("PaletteAFMHot",ui->actionAFMHot->isChecked());
@@ -451,9 +452,11 @@ void MainWindow::readSettings()
   m_initIQplus = settings.value("InitIQplus",false).toBool();
   m_bIQxt = settings.value("IQxt",false).toBool();
   m_udpPort = settings.value("UDPport",50004).toInt();
+  m_udpBufferSize = settings.value("UDPBufferSize",4*1024*1024).toInt();
   soundInThread.setSwapIQ(m_IQswap);
   soundInThread.setScale(m_dB);
   soundInThread.setPort(m_udpPort);
+  soundInThread.setUdpBufferSize(m_udpBufferSize);
   ui->actionCuteSDR->setChecked(settings.value(
                                   "PaletteCuteSDR",true).toBool());
   ui->actionLinrad->setChecked(settings.value(
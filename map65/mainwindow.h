@@ -181,6 +181,7 @@ private:
   qint32  m_paInDevice;
   qint32  m_paOutDevice;
   qint32  m_udpPort;
+  qint32  m_udpBufferSize;
   qint32  m_NBslider;
   qint32  m_adjustIQ;
   qint32  m_applyIQcal;
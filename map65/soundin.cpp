@@ -1,5 +1,8 @@
 #include "soundin.h"
 #include <math.h>
+#include <vector>
+
+#include "Network/LinradReceiver.hpp"
 
 #ifdef Q_OS_WIN32
 #include <windows.h>
@@ -297,6 +300,12 @@ void SoundInThread::setInputDevice(int n)                  //setInputDevice()
   this->m_nDevIn=n;
 }
 
+void SoundInThread::setUdpBufferSize(int n)
+{
+  if (isRunning()) return;
+  m_udpBufferSize=n;
+}
+
 void SoundInThread::setRate(double rate)                         //setRate()
 {
   if (isRunning()) return;
@@ -364,27 +373,15 @@ void SoundInThread::setPeriod(int n)
 //--------------------------------------------------------------- inputUDP()
 void SoundInThread::inputUDP()
 {
-  udpSocket = new QUdpSocket();
-  if(!udpSocket->bind(m_udpPort,QUdpSocket::ShareAddress) )
-  {
-    emit error(tr("UDP Socket bind failed."));
-    return;
-  }
-
-  // Set this socket's total buffer space for received UDP packets
-  udpSocket->setSocketOption (QUdpSocket::ReceiveBufferSizeSocketOption, 141600);
+  // Datagrams are received on their own thread so that none are lost
+  // while this one is busy or the GUI stalls
+  LinradReceiver receiver;
+  connect(&receiver, &LinradReceiver::error, this, &SoundInThread::error);
+  receiver.configure(m_udpPort, m_udpBufferSize);
+  receiver.start(QThread::TimeCriticalPriority);
 
-  bool qe = quitExecution;
-  struct linradBuffer {
-    double cfreq;
-    int msec;
-    float userfreq;
-    int iptr;
-    quint16 iblk;
-    qint8 nrx;
-    char iusb;
-    double d8[174];
-  } b;
+  std::vector<LinradPacket> packets(64);
+  quint64 nlost0=0;
 
   int ntr0=99;
   int k=0;
@@ -395,14 +392,10 @@ void SoundInThread::inputUDP()
   int nBusy=0;
 
   // Main loop for input of UDP packets over the network:
-  while (!qe) {
-    qe = quitExecution;
-    if (qe) break;
-    if (!udpSocket->hasPendingDatagrams()) {
-      msleep(2);                  // Sleep if no packet available
-    } else {
-      int nBytesRead = udpSocket->readDatagram((char *)&b,1416);
-      if (nBytesRead != 1416) qDebug() << "UDP Read Error:" << nBytesRead;
+  while (!quitExecution and !receiver.isFinished()) {
+    int npkt=receiver.read(packets.data(), packets.size(), 100);
+    for(int i=0; i<npkt; i++) {
+      LinradPacket& b=packets[i];
 
       qint64 ms = QDateTime::currentMSecsSinceEpoch() % 86400000;
       nsec = ms/1000;             // Time according to this computer
@@ -413,6 +406,11 @@ void SoundInThread::inputUDP()
         k=0;
         nhsym0=0;
         m_TRperiod0=m_TRperiod;
+        quint64 nlost=receiver.lost() + receiver.overruns();
+        if(nlost != nlost0) {
+          emit status(tr("UDP packets lost: %1").arg(nlost));
+          nlost0=nlost;
+        }
       }
       ntr0=ntr;
 
@@ -447,5 +445,6 @@ void SoundInThread::inputUDP()
       }
     }
   }
-  delete udpSocket;
+  receiver.stop();
+  receiver.wait();
 }
@@ -3,6 +3,8 @@
 #include <stdexcept>
 #include <utility>
 #include <QString>
+#include <QHash>
+#include <QVector>
 #include <QDateTime>
 #include <QSqlDatabase>
 #include <QSqlTableModel>
@@ -68,26 +70,49 @@ public:
 
   QString cabrillo_frequency_string (Radio::Frequency frequency) const;
   void create_table ();
+  void load_cache () const;
+  void add_to_cache (Radio::Frequency, QString const& call) const;
 
   CabrilloLog * self_;
   Configuration const * configuration_;
-  QSqlQuery mutable dupe_query_;
   QSqlQuery mutable export_query_;
-  QSqlQuery mutable qso_count_query_;
+  QSqlQuery mutable cache_query_;
   bool adding_row_;
-  int n_qso();
+
+  // The bands each call is worked on and the QSO count of the whole
+  // log. Inserts are added as they are written, any other change
+  // invalidates and the next use reloads.
+  bool mutable cache_valid_;
+  int mutable qso_count_;
+  QHash<QString, QSet<QString>> mutable bands_worked_;
+
+  // DXCC entities worked by band, only band+call pairs new since the
+  // last unique_DXCC_entities () are looked up
+  AD1CCty const mutable * entities_countries_;
+  worked_set mutable entities_;
+  QVector<worked_item> mutable entities_pending_;
 };
 
 CabrilloLog::impl::impl (CabrilloLog * self, Configuration const * configuration)
   : self_ {self}
   , configuration_ {configuration}
   , adding_row_ {false}
+  , cache_valid_ {false}
+  , qso_count_ {0}
+  , entities_countries_ {nullptr}
 {
   if (!database ().tables ().contains ("cabrillo_log_v2"))
     {
       create_table ();
     }
 
+  {
+    // for ordering by time, added to existing logs too
+    QSqlQuery query;
+    SQL_error_check (query, static_cast<bool (QSqlQuery::*) (QString const&)> (&QSqlQuery::exec),
+                     "CREATE INDEX IF NOT EXISTS cabrillo_log_v2_when ON cabrillo_log_v2 (\"when\")");
+  }
+
   setEditStrategy (QSqlTableModel::OnFieldChange);
   setTable ("cabrillo_log_v2");
   setHeaderData (fieldIndex ("frequency"), Qt::Horizontal, tr ("Freq(MHz)"));
@@ -114,16 +139,30 @@ CabrilloLog::impl::impl (CabrilloLog * self, Configuration const * configuration
       Q_EMIT self_->qso_count_changed(self_->n_qso());
     });
 
+  // keep the cache in step with the table, add_QSO () inserts while
+  // edits and deletes from the log window are rare
+  connect (this, &QSqlTableModel::beforeInsert, [this] (QSqlRecord& record) {
+      if (cache_valid_)
+        {
+          add_to_cache (record.value ("frequency").value<Radio::Frequency> (), record.value ("call").toString ());
+        }
+    });
+  connect (this, &QSqlTableModel::beforeUpdate, [this] (int, QSqlRecord&) {
+      cache_valid_ = false;
+    });
+  connect (this, &QSqlTableModel::beforeDelete, [this] (int) {
+      cache_valid_ = false;
+    });
+
   SQL_error_check (*this, &QSqlTableModel::select);
 
-  SQL_error_check (dupe_query_, &QSqlQuery::prepare,
+  SQL_error_check (cache_query_, &QSqlQuery::prepare,
                    "SELECT "
-                   "    frequency "
+                   "    frequency"
+                   "    , call"
                    "  FROM "
-                   "    cabrillo_log_v2 "
-                   "  WHERE "
-                   "    call = :call ");
-  
+                   "    cabrillo_log_v2");
+
   SQL_error_check (export_query_, &QSqlQuery::prepare,
                    "SELECT "
                    "    frequency"
@@ -136,9 +175,6 @@ CabrilloLog::impl::impl (CabrilloLog * self, Configuration const * configuration
                    "  ORDER BY "
                    "    \"when\"");
 
-  SQL_error_check (qso_count_query_, &QSqlQuery::prepare,
-                   "SELECT COUNT(*) FROM cabrillo_log_v2");
-
 }
 
 void CabrilloLog::impl::create_table ()
@@ -156,6 +192,34 @@ void CabrilloLog::impl::create_table ()
                    ")");
 }
 
+void CabrilloLog::impl::load_cache () const
+{
+  if (cache_valid_) return;
+  qso_count_ = 0;
+  bands_worked_.clear ();
+  entities_.clear ();
+  entities_pending_.clear ();
+  SQL_error_check (cache_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
+  while (cache_query_.next ())
+    {
+      add_to_cache (cache_query_.value (0).value<Radio::Frequency> (), cache_query_.value (1).toString ());
+    }
+  cache_query_.finish ();
+  cache_valid_ = true;
+}
+
+void CabrilloLog::impl::add_to_cache (Radio::Frequency frequency, QString const& call) const
+{
+  ++qso_count_;
+  auto band = configuration_->bands ()->find (frequency);
+  auto& bands = bands_worked_[call];
+  if (!bands.contains (band))
+    {
+      bands << band;
+      entities_pending_ << worked_item {band, call};
+    }
+}
+
 // frequency here is in kHz
 QString CabrilloLog::impl::cabrillo_frequency_string (Radio::Frequency frequency) const
 {
@@ -240,7 +304,15 @@ bool CabrilloLog::add_QSO (Frequency frequency, QString const& mode, QDateTime c
   ConditionalTransaction transaction {*m_};
   m_->adding_row_ = true;
   auto ok = m_->insertRecord (-1, record);
-  transaction.submit ();
+  try
+    {
+      transaction.submit ();
+    }
+  catch (...)
+    {
+      m_->cache_valid_ = false; // may hold the failed insert
+      throw;
+    }
 
   m_->adding_row_ = false;
   m_->setEditStrategy (QSqlTableModel::OnFieldChange);
@@ -250,26 +322,16 @@ bool CabrilloLog::add_QSO (Frequency frequency, QString const& mode, QDateTime c
 
 bool CabrilloLog::dupe (Frequency frequency, QString const& call) const
 {
-  m_->dupe_query_.bindValue (":call", call);
-  SQL_error_check (m_->dupe_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
-  auto record = m_->dupe_query_.record ();
-  auto frequency_index = record.indexOf ("frequency");
-  while (m_->dupe_query_.next ())
-    {
-      if (m_->configuration_->bands ()->find (m_->dupe_query_.value (frequency_index).toULongLong ())
-          == m_->configuration_->bands ()->find (frequency))
-        {
-          return true;
-        }
-    }
-  return false;
+  m_->load_cache ();
+  auto bands = m_->bands_worked_.constFind (call);
+  return bands != m_->bands_worked_.constEnd ()
+    && bands->contains (m_->configuration_->bands ()->find (frequency));
 }
 
 int CabrilloLog::n_qso()
 {
-  SQL_error_check (m_->qso_count_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
-  m_->qso_count_query_.first();
-  return m_->qso_count_query_.value(0).toInt();
+  m_->load_cache ();
+  return m_->qso_count_;
 }
 
 void CabrilloLog::reset ()
@@ -313,14 +375,25 @@ void CabrilloLog::export_qsos (QTextStream& stream) const
 
 auto CabrilloLog::unique_DXCC_entities (AD1CCty const * countries) const -> worked_set
 {
-  QSqlQuery q {"SELECT DISTINCT BAND, CALL FROM cabrillo_log_v2"};
-  auto band_index = q.record ().indexOf ("band");
-  auto call_index = q.record ().indexOf ("call");
-  worked_set entities;
-  while (q.next ())
+  m_->load_cache ();
+  if (countries != m_->entities_countries_)
+    {
+      // look up every band+call pair again
+      m_->entities_.clear ();
+      m_->entities_pending_.clear ();
+      for (auto bands = m_->bands_worked_.constBegin (); bands != m_->bands_worked_.constEnd (); ++bands)
+        {
+          for (auto const& band : *bands)
+            {
+              m_->entities_pending_ << worked_item {band, bands.key ()};
+            }
+        }
+      m_->entities_countries_ = countries;
+    }
+  for (auto const& item : m_->entities_pending_)
     {
-      entities << worked_item {q.value (band_index).toString ()
-          , countries->lookup (q.value (call_index).toString ()).primary_prefix};
+      m_->entities_ << worked_item {item.first, countries->lookup (item.second).primary_prefix};
     }
-  return entities;
+  m_->entities_pending_.clear ();
+  return m_->entities_;
 }
@@ -2,7 +2,11 @@
 
 #include <stdexcept>
 #include <utility>
+#include <vector>
+#include <algorithm>
 #include <QString>
+#include <QSet>
+#include <QPair>
 #include <QDateTime>
 #include <QSqlDatabase>
 #include <QSqlTableModel>
@@ -11,7 +15,6 @@
 #include <QSqlQuery>
 #include <QTextStream>
 #include <QDebug>
-#include "Logger.hpp"
 #include "Configuration.hpp"
 #include "qt_db_helpers.hpp"
 #include "pimpl_impl.hpp"
@@ -35,13 +38,19 @@ public:
     return value;
   }
 
+  void load_cache () const;
+  void add_to_cache (QString const& call, QString const& band, qlonglong when) const;
+
   Configuration const * configuration_;
-  QSqlQuery mutable dupe_query_;
   QSqlQuery mutable export_query_;
-  // queries for rates
-  QSqlQuery mutable rate_n_query_;
-  QSqlQuery mutable rate60m_query_;
-  QString rate();
+  QSqlQuery mutable cache_query_;
+
+  // The call+band pairs and QSO times of the whole log for dupe checks
+  // and rates. Inserts are added as they are written, any other change
+  // invalidates and the next use reloads.
+  bool mutable cache_valid_;
+  QSet<QPair<QString, QString>> mutable worked_;
+  std::vector<qlonglong> mutable whens_; // ascending
 };
 
 #include "FoxLog.moc"
@@ -63,6 +72,7 @@ namespace
 
 FoxLog::impl::impl (Configuration const * configuration)
   : configuration_ {configuration}
+  , cache_valid_ {false}
 {
   if (!database ().tables ().contains ("fox_log"))
     {
@@ -73,12 +83,14 @@ FoxLog::impl::impl (Configuration const * configuration)
   else
     {
       QSqlQuery query;
-      // query to check if table has a unique constraint
+      // query to check if table has a unique constraint, the indexes
+      // created below are not unique
       SQL_error_check (query, static_cast<bool (QSqlQuery::*) (QString const&)> (&QSqlQuery::exec),
                        "SELECT COUNT(*)"
                        "       FROM sqlite_master"
                        "    WHERE"
-                       "       type = 'index' AND tbl_name = 'fox_log'");
+                       "       type = 'index' AND tbl_name = 'fox_log'"
+                       "       AND name LIKE 'sqlite_autoindex_%'");
       query.next ();
       if (query.value (0).toInt ())
         {
@@ -101,14 +113,15 @@ FoxLog::impl::impl (Configuration const * configuration)
         }
     }
 
-  SQL_error_check (dupe_query_, &QSqlQuery::prepare,
-                   "SELECT "
-                   "    COUNT(*) "
-                   "  FROM "
-                   "    fox_log "
-                   "  WHERE "
-                   "    call = :call "
-                   "    AND band = :band");
+  {
+    // indexes for dupe checks and for ordering by time, added to
+    // existing logs too
+    QSqlQuery query;
+    SQL_error_check (query, static_cast<bool (QSqlQuery::*) (QString const&)> (&QSqlQuery::exec),
+                     "CREATE INDEX IF NOT EXISTS fox_log_call_band ON fox_log (call, band)");
+    SQL_error_check (query, static_cast<bool (QSqlQuery::*) (QString const&)> (&QSqlQuery::exec),
+                     "CREATE INDEX IF NOT EXISTS fox_log_when ON fox_log (\"when\")");
+  }
 
   SQL_error_check (export_query_, &QSqlQuery::prepare,
                    "SELECT "
@@ -123,25 +136,32 @@ FoxLog::impl::impl (Configuration const * configuration)
                    "  ORDER BY "
                    "    \"when\"");
 
-  SQL_error_check (rate_n_query_, &QSqlQuery::prepare,
+  SQL_error_check (cache_query_, &QSqlQuery::prepare,
                    "SELECT "
-                   " \"when\""
+                   "    call"
+                   "    , band"
+                   "    , \"when\""
                    "  FROM "
                    "    fox_log "
                    "  ORDER BY "
-                   "    \"when\" DESC"
-                   "  LIMIT :limitn"
-  );
+                   "    \"when\"");
+
+  // keep the cache in step with the table, add_QSO () inserts while
+  // edits and deletes from the log window are rare
+  connect (this, &QSqlTableModel::beforeInsert, [this] (QSqlRecord& record) {
+      if (cache_valid_)
+        {
+          add_to_cache (record.value ("call").toString (), record.value ("band").toString ()
+                        , record.value ("when").toLongLong ());
+        }
+    });
+  connect (this, &QSqlTableModel::beforeUpdate, [this] (int, QSqlRecord&) {
+      cache_valid_ = false;
+    });
+  connect (this, &QSqlTableModel::beforeDelete, [this] (int) {
+      cache_valid_ = false;
+    });
 
-  SQL_error_check (rate60m_query_, &QSqlQuery::prepare,
-                   "SELECT "
-                   " COUNT() "
-                   "  FROM "
-                   "    fox_log "
-                   " where \"when\" > :one_hour_ago"
-                   "  ORDER BY "
-                   "    \"when\" DESC"
-  );
   setEditStrategy (QSqlTableModel::OnFieldChange);
   setTable ("fox_log");
   setHeaderData (fieldIndex ("when"), Qt::Horizontal, tr ("Date & Time(UTC)"));
@@ -159,6 +179,28 @@ FoxLog::impl::impl (Configuration const * configuration)
   SQL_error_check (*this, &QSqlTableModel::select);
 }
 
+void FoxLog::impl::load_cache () const
+{
+  if (cache_valid_) return;
+  worked_.clear ();
+  whens_.clear ();
+  SQL_error_check (cache_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
+  while (cache_query_.next ())
+    {
+      add_to_cache (cache_query_.value (0).toString (), cache_query_.value (1).toString ()
+                    , cache_query_.value (2).toLongLong ());
+    }
+  cache_query_.finish ();
+  cache_valid_ = true;
+}
+
+void FoxLog::impl::add_to_cache (QString const& call, QString const& band, qlonglong when) const
+{
+  worked_ << qMakePair (call, band);
+  // nearly always appends
+  whens_.insert (std::upper_bound (whens_.begin (), whens_.end (), when), when);
+}
+
 QString FoxLog::rate()
 {
   return QString("Last 10: %1, Last 100: %2, Last 60m: %3").arg(QString::number(this->rate_last_n(10),'f',0),
@@ -224,17 +266,18 @@ bool FoxLog::add_QSO (QDateTime const& when, QString const& call, QString const&
     {
       ok = transaction.submit (false);
     }
+  if (!ok)
+    {
+      m_->cache_valid_ = false; // may hold the failed insert
+    }
   m_->setEditStrategy (QSqlTableModel::OnFieldChange);
   return ok;
 }
 
 bool FoxLog::dupe (QString const& call, QString const& band) const
 {
-  m_->dupe_query_.bindValue (":call", call);
-  m_->dupe_query_.bindValue (":band", band);
-  SQL_error_check (m_->dupe_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
-  m_->dupe_query_.next ();
-  return m_->dupe_query_.value (0).toInt ();
+  m_->load_cache ();
+  return m_->worked_.contains (qMakePair (call, band));
 }
 
 void FoxLog::reset ()
@@ -254,42 +297,27 @@ void FoxLog::reset ()
 
 int FoxLog::rate_60m()
 {
-  int rate60m = 0;
   qlonglong const& one_hour_ago = QDateTime::currentDateTime().addSecs(-3600).toMSecsSinceEpoch () / 1000;
 
-  // query the 60m rate
-  m_->rate60m_query_.bindValue (":one_hour_ago", one_hour_ago);
-  SQL_error_check (m_->rate60m_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
-  m_->rate60m_query_.next ();
-  rate60m = m_->rate60m_query_.value (0).toLongLong();
-  return rate60m;
-  //
+  // QSOs later than an hour ago
+  m_->load_cache ();
+  auto const& whens = m_->whens_;
+  return static_cast<int> (whens.end () - std::upper_bound (whens.begin (), whens.end (), one_hour_ago));
 }
 
 double FoxLog::rate_last_n(int n)
 {
-  double rate_interval = 0;
-
   qlonglong const& secs_now = QDateTime::currentDateTime().toMSecsSinceEpoch () / 1000;
 
-  // get last n or up to n
-  m_->rate_n_query_.bindValue (":limitn", n);
-  SQL_error_check (m_->rate_n_query_, static_cast<bool (QSqlQuery::*) ()> (&QSqlQuery::exec));
+  // last n or up to n
+  m_->load_cache ();
+  auto const& whens = m_->whens_;
+  if (n <= 0 || whens.empty ()) return 0.0;
+  auto size = std::min (static_cast<std::size_t> (n), whens.size ());
 
-  m_->rate_n_query_.next();
-  if (!m_->rate_n_query_.isValid()) {
-    LOG_ERROR(QString("rate_n result is not valid. Last error %1").arg(m_->rate_n_query_.lastError().text()));
-    return 0.0;
-  }
   // size / (time_now - time_of_first)
-  m_->rate_n_query_.last();
-  rate_interval = secs_now - m_->rate_n_query_.value (0).toLongLong ();
+  double rate_interval = secs_now - whens[whens.size () - size];
   if (rate_interval == 0) return 0.0;
-
-  m_->rate_n_query_.first(); // count the records
-
-  int size = 1;
-  while (m_->rate_n_query_.next() && m_->rate_n_query_.isValid()) size++;
   return (size/rate_interval) * 3600;
 }
 
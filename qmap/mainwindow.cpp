@@ -218,6 +218,7 @@ void MainWindow::writeSettings()
   settings.setValue("paInDevice",m_paInDevice);
   settings.setValue("Scale_dB",m_dB);
   settings.setValue("UDPport",m_udpPort);
+  settings.setValue("UDPBufferSize",m_udpBufferSize);
   settings.setValue("PaletteCuteSDR",ui->actionCuteSDR->isChecked());
   settings.setValue("PaletteLinrad",ui->actionLinrad->isChecked());
   settings.setValue("PaletteAFMHot",ui->actionAFMHot->isChecked());
@@ -258,8 +259,10 @@ void MainWindow::readSettings()
   m_network = settings.value("NetworkInput",true).toBool();
   m_dB = settings.value("Scale_dB",0).toInt();
   m_udpPort = settings.value("UDPport",50004).toInt();
+  m_udpBufferSize = settings.value("UDPBufferSize",4*1024*1024).toInt();
   soundInThread.setScale(m_dB);
   soundInThread.setPort(m_udpPort);
+  soundInThread.setUdpBufferSize(m_udpBufferSize);
   ui->actionCuteSDR->setChecked(settings.value(
                                   "PaletteCuteSDR",true).toBool());
   ui->actionLinrad->setChecked(settings.value(
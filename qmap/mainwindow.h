@@ -108,6 +108,7 @@ private:
   qint32  m_hsym0;
   qint32  m_paInDevice;
   qint32  m_udpPort;
+  qint32  m_udpBufferSize;
   qint32  m_NBslider;
   qint32  m_TRperiod;
   qint32  m_modeQ65;
@@ -1,5 +1,8 @@
 #include "soundin.h"
 #include <math.h>
+#include <vector>
+
+#include "Network/LinradReceiver.hpp"
 
 #ifdef Q_OS_WIN32
 #include <windows.h>
@@ -95,6 +98,12 @@ void SoundInThread::setPort(int n)                              //setPort()
   this->m_udpPort=n;
 }
 
+void SoundInThread::setUdpBufferSize(int n)
+{
+  if (isRunning()) return;
+  m_udpBufferSize=n;
+}
+
 void SoundInThread::setRate(double rate)                         //setRate()
 {
   if (isRunning()) return;
@@ -151,27 +160,15 @@ void SoundInThread::setPeriod(int n)
 //--------------------------------------------------------------- inputUDP()
 void SoundInThread::inputUDP()
 {
-  udpSocket = new QUdpSocket();
-  if(!udpSocket->bind(m_udpPort,QUdpSocket::ShareAddress) )
-  {
-    emit error(tr("UDP Socket bind failed."));
-    return;
-  }
+  // Datagrams are received on their own thread so that none are lost
+  // while this one is busy or the GUI stalls
+  LinradReceiver receiver;
+  connect(&receiver, &LinradReceiver::error, this, &SoundInThread::error);
+  receiver.configure(m_udpPort, m_udpBufferSize);
+  receiver.start(QThread::TimeCriticalPriority);
 
-  // Set this socket's total buffer space for received UDP packets
-  udpSocket->setSocketOption (QUdpSocket::ReceiveBufferSizeSocketOption, 141600);
-
-  bool qe = quitExecution;
-  struct linradBuffer {
-    double cfreq;
-    int msec;
-    float userfreq;
-    int iptr;
-    quint16 iblk;
-    qint8 nrx;
-    char iusb;
-    double d8[174];
-  } b;
+  std::vector<LinradPacket> packets(64);
+  quint64 nlost0=0;
 
   int ntr0=99;
   int k=0;
@@ -181,15 +178,10 @@ void SoundInThread::inputUDP()
   int iz=174;
 
   // Main loop for input of UDP packets over the network:
-  while (!qe) {
-    qe = quitExecution;
-    if (qe) break;
-    if (!udpSocket->hasPendingDatagrams()) {
-//      msleep(2);                  // Sleep if no packet available
-      QObject().thread()->usleep(2000);
-    } else {
-      int nBytesRead = udpSocket->readDatagram((char *)&b,1416);
-      if (nBytesRead != 1416) qDebug() << "UDP Read Error:" << nBytesRead;
+  while (!quitExecution and !receiver.isFinished()) {
+    int npkt=receiver.read(packets.data(), packets.size(), 100);
+    for(int i=0; i<npkt; i++) {
+      LinradPacket& b=packets[i];
 
       qint64 ms = QDateTime::currentMSecsSinceEpoch() % 86400000;
       nsec = ms/1000;             // Time according to this computer
@@ -200,6 +192,11 @@ void SoundInThread::inputUDP()
         k=0;
         nhsym0=0;
         m_TRperiod0=m_TRperiod;
+        quint64 nlost=receiver.lost() + receiver.overruns();
+        if(nlost != nlost0) {
+          emit status(tr("UDP packets lost: %1").arg(nlost));
+          nlost0=nlost;
+        }
       }
 
       ntr0=ntr;
@@ -228,5 +225,6 @@ void SoundInThread::inputUDP()
       }
     }
   }
-  delete udpSocket;
+  receiver.stop();
+  receiver.wait();
 }
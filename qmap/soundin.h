@@ -2,7 +2,6 @@
 #define SOUNDIN_H
 
 #include <QtCore>
-#include <QtNetwork/QUdpSocket>
 #include <QDebug>
 #include <valarray>
 
@@ -25,12 +24,14 @@ public:
     quitExecution(false),
     m_rate(0),
     bufSize(0),
-    m_dataSinkBusy(false)
+    m_dataSinkBusy(false),
+    m_udpBufferSize(4*1024*1024)
   {
   }
 
   void setScale(qint32 n);
   void setPort(qint32 n);
+  void setUdpBufferSize(qint32 n);
   void setRate(double rate);
   void setBufSize(unsigned bufSize);
   void setNetwork(bool b);
@@ -59,11 +60,10 @@ private:
   qint32 m_nrx;
   qint32 m_hsym;
   qint32 m_udpPort;
+  qint32 m_udpBufferSize;
   qint32 m_TRperiod;
   qint32 m_TRperiod0;
   qint32 m_dB;
-
-  QUdpSocket *udpSocket;
 };
 
 extern "C" {
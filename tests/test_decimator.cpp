@@ -0,0 +1,157 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <QtTest>
+
+#include "Detector/Decimator.hpp"
+
+extern "C" {
+  void fil4_(std::int16_t *, int *, std::int16_t *, int *);
+}
+
+Q_DECLARE_METATYPE (Decimator::Kernel);
+
+namespace
+{
+  int const block {3456 * 4};   // input samples fil4 sees per call in FT8
+
+  // a tone in noise, interleaved left and right channels
+  std::vector<std::int16_t> test_signal (int frames)
+  {
+    std::vector<std::int16_t> stereo (2 * frames);
+    std::srand (1);
+    for (int i = 0; i < frames; ++i)
+      {
+        stereo[2 * i] = std::int16_t (3000. * std::sin (i * 0.13) + std::rand () % 4000 - 2000);
+        stereo[2 * i + 1] = std::int16_t (std::rand () % 2000 - 1000);
+      }
+    return stereo;
+  }
+
+  // fil4 output for one channel of frames, from a zero filter state
+  std::vector<std::int16_t> reference (std::vector<std::int16_t> const& stereo, int channel)
+  {
+    std::vector<std::int16_t> mono (stereo.size () / 2);
+    for (std::size_t i = 0; i < mono.size (); ++i) mono[i] = stereo[2 * i + channel];
+    std::vector<std::int16_t> out (mono.size () / block * block / Decimator::factor);
+    std::int16_t zeros[48] {};
+    std::int16_t discard[12];
+    int n1 {48}, n2;
+    fil4_(zeros, &n1, discard, &n2); // flush fil4's saved state
+    for (std::size_t pos = 0; pos < out.size () * Decimator::factor; pos += block)
+      {
+        n1 = block;
+        fil4_(&mono[pos], &n1, &out[pos / Decimator::factor], &n2);
+      }
+    return out;
+  }
+
+  // decimate in irregular pieces as audio buffers arrive
+  std::vector<std::int16_t> decimate (Decimator& d, std::vector<std::int16_t> const& stereo
+                                      , int channel, std::size_t frames)
+  {
+    std::vector<std::int16_t> out (frames / Decimator::factor + 1);
+    std::size_t written {0};
+    std::size_t step {37};
+    for (std::size_t pos = 0; pos < frames; )
+      {
+        auto n = qMin (step, frames - pos);
+        written += d.process (&stereo[2 * pos], n, 2, channel, &out[written]);
+        pos += n;
+        step = step * 7 % 2000 + 1;
+      }
+    out.resize (written);
+    return out;
+  }
+}
+
+class TestDecimator
+  : public QObject
+{
+  Q_OBJECT
+
+public:
+
+private:
+  Q_SLOT void matches_fil4_data ()
+  {
+    QTest::addColumn<Decimator::Kernel> ("kernel");
+    QTest::addColumn<int> ("tolerance");
+    QTest::addColumn<int> ("max_differences");
+    // the scalar sum is in fil4's order so should round identically
+    QTest::newRow ("scalar") << Decimator::Kernel::scalar << 0 << 0;
+    QTest::newRow ("SSE2") << Decimator::Kernel::sse2 << 1 << 50;
+    QTest::newRow ("AVX2") << Decimator::Kernel::avx2 << 1 << 50;
+    QTest::newRow ("NEON") << Decimator::Kernel::neon << 1 << 50;
+  }
+
+  Q_SLOT void matches_fil4 ()
+  {
+    QFETCH (Decimator::Kernel, kernel);
+    QFETCH (int, tolerance);
+    QFETCH (int, max_differences);
+    if (!Decimator::supported (kernel)) QSKIP ("not supported by this CPU");
+
+    auto stereo = test_signal (4 * block + 1000);
+    for (int channel = 0; channel < 2; ++channel)
+      {
+        auto expected = reference (stereo, channel);
+        Decimator d {kernel};
+        QCOMPARE (d.kernel (), kernel);
+        auto actual = decimate (d, stereo, channel, expected.size () * Decimator::factor);
+        QCOMPARE (actual.size (), expected.size ());
+        int differences {0};
+        for (std::size_t i = 0; i < actual.size (); ++i)
+          {
+            auto difference = std::abs (actual[i] - expected[i]);
+            QVERIFY2 (difference <= tolerance, qPrintable (QString {"sample %1: %2 != %3"}
+                                                           .arg (i).arg (actual[i]).arg (expected[i])));
+            if (difference) ++differences;
+          }
+        QVERIFY (differences <= max_differences);
+      }
+  }
+
+  Q_SLOT void response_data ()
+  {
+    QTest::addColumn<double> ("frequency");
+    QTest::addColumn<int> ("minimum");
+    QTest::addColumn<int> ("maximum");
+    // 1 dB pass band ripple and 40 dB stop band attenuation, 8 kHz
+    // would alias to 4 kHz
+    QTest::newRow ("1000 Hz") << 1000. << 8900 << 11300;
+    QTest::newRow ("4500 Hz") << 4500. << 8900 << 11300;
+    QTest::newRow ("8000 Hz") << 8000. << 0 << 200;
+    QTest::newRow ("16000 Hz") << 16000. << 0 << 200;
+  }
+
+  Q_SLOT void response ()
+  {
+    QFETCH (double, frequency);
+    QFETCH (int, minimum);
+    QFETCH (int, maximum);
+    int const frames {48000};
+    std::vector<std::int16_t> in (frames);
+    std::vector<std::int16_t> out (frames / Decimator::factor);
+    for (int i = 0; i < frames; ++i) in[i] = std::int16_t (10000. * std::sin (2. * M_PI * frequency * i / 48000.));
+    Decimator d;
+    QCOMPARE (d.process (in.data (), frames, 1, 0, out.data ()), out.size ());
+    int peak {0};
+    for (std::size_t i = 100; i < out.size (); ++i) peak = qMax (peak, std::abs (out[i]));
+    QVERIFY (peak >= minimum && peak <= maximum);
+  }
+
+  Q_SLOT void clamps ()
+  {
+    std::vector<std::int16_t> in (400, 32767);
+    std::vector<std::int16_t> out (100);
+    Decimator d;
+    d.process (in.data (), in.size (), 1, 0, out.data ());
+    QCOMPARE (out.back (), std::int16_t (32767));
+  }
+};
+
+QTEST_MAIN (TestDecimator);
+
+#include "test_decimator.moc"
@@ -0,0 +1,91 @@
+#include <vector>
+
+#include <QtTest>
+#include <QSharedPointer>
+
+#include "commons.h"
+#include "Audio/soundout.h"
+#include "Modulator/ChatWaveform.hpp"
+#include "Modulator/Modulator.hpp"
+#include "Modulator/TxSymbols.hpp"
+#include "getfile.h"
+
+// defined with the main window in the application
+int volatile itone[MAX_NUM_SYMBOLS];
+int volatile icw[NUM_CW_SYMBOLS];
+
+// defined in getfile.cpp in the application, only used when
+// transmitting noise
+float gran ()
+{
+  return 0.f;
+}
+
+namespace
+{
+  int const frames {4800};
+
+  // starts an FT8 transmission of the precomputed waveform, the way
+  // the main window does for FT8 and for chat, and reads the start of
+  // it
+  std::vector<qint16> transmit (Modulator& modulator, SoundOutput& output)
+  {
+    // fast mode so the samples come from the start of the waveform
+    // whatever the time
+    modulator.start ("FT8", 79, 1920., 1500., -3., &output, AudioDevice::Mono, false, true, 99., 15.);
+    std::vector<qint16> samples (frames);
+    auto bytes = modulator.read (reinterpret_cast<char *> (samples.data ()), frames * sizeof (qint16));
+    samples.resize (bytes / sizeof (qint16));
+    modulator.stop ();
+    return samples;
+  }
+
+  int peak (std::vector<qint16> const& samples)
+  {
+    int peak {0};
+    for (auto sample : samples) peak = qMax (peak, qAbs (int (sample)));
+    return peak;
+  }
+}
+
+class TestModulator
+  : public QObject
+{
+  Q_OBJECT
+
+public:
+
+private:
+  Q_SLOT void initTestCase ()
+  {
+    itone[0] = 0;
+    icw[0] = 0;                 // no CW ID
+    for (int i = 0; i < frames; ++i) foxcom_.wave[i] = .5f;
+  }
+
+  Q_SLOT void ft8 ()
+  {
+    Modulator modulator {48000, 15.};
+    SoundOutput output;
+    auto samples = transmit (modulator, output);
+    QCOMPARE (int (samples.size ()), frames);
+    QCOMPARE (peak (samples), 16384);
+  }
+
+  Q_SLOT void ft8_after_chat ()
+  {
+    Modulator modulator {48000, 15.};
+    SoundOutput output;
+    // a chat waveform with nothing ready sends silence
+    modulator.setChatWaveform (QSharedPointer<ChatWaveform>::create (QStringList {}, 1500));
+    QCOMPARE (peak (transmit (modulator, output)), 0);
+    // the next FT8 transmission must not send the chat waveform again
+    auto samples = transmit (modulator, output);
+    QCOMPARE (int (samples.size ()), frames);
+    QCOMPARE (peak (samples), 16384);
+  }
+};
+
+QTEST_GUILESS_MAIN (TestModulator);
+
+#include "test_modulator.moc"
@@ -0,0 +1,152 @@
+#include <hamlib/rig.h>
+
+#include <QtTest>
+#include <QStringList>
+
+#include "Transceiver/TransceiverBase.hpp"
+#include "Transceiver/TransceiverFactory.hpp"
+#include "Transceiver/HamlibTransceiver.hpp"
+
+namespace
+{
+  // records the CAT commands TransceiverBase makes
+  class FakeRig final
+    : public TransceiverBase
+  {
+  public:
+    explicit FakeRig (logger_type * logger)
+      : TransceiverBase {logger, nullptr}
+    {
+    }
+
+    QStringList commands;
+
+  private:
+    int do_start () override
+    {
+      update_rx_frequency (14074000);
+      update_mode (USB);
+      return 0;
+    }
+
+    void do_stop () override {}
+
+    void do_frequency (Frequency f, MODE m, bool) override
+    {
+      commands << QString {"frequency %1"}.arg (f);
+      update_rx_frequency (f);
+      if (m != UNK) update_mode (m);
+    }
+
+    void do_tx_frequency (Frequency f, MODE, bool) override
+    {
+      commands << QString {"tx frequency %1"}.arg (f);
+      update_split (f);
+      update_other_frequency (f);
+    }
+
+    void do_mode (MODE m) override
+    {
+      update_mode (m);
+    }
+
+    void do_ptt (bool on) override
+    {
+      commands << QString {"PTT %1"}.arg (on);
+      update_PTT (on);
+    }
+
+    int do_ptt_settle_time () const override {return 0;}
+  };
+}
+
+class TestTransceiver
+  : public QObject
+{
+  Q_OBJECT
+
+public:
+  TestTransceiver ()
+    : logger_ (boost::log::keywords::channel = "RIGCTRL")
+  {
+  }
+
+private:
+  Q_SLOT void coalesces_qsy ()
+  {
+    FakeRig rig {&logger_};
+    rig.start (1);
+    rig.commands.clear ();
+    unsigned last_sequence_number {0};
+    connect (&rig, &Transceiver::update, [&] (Transceiver::TransceiverState const&, unsigned n) {
+        last_sequence_number = n;
+      });
+    Transceiver::TransceiverState s;
+    s.online (true);
+    for (unsigned n = 2; n < 50; ++n)
+      {
+        s.frequency (14074000 + 100 * n);
+        rig.set (s, n);
+      }
+    QTRY_COMPARE (rig.commands, QStringList {"frequency 14078900"});
+    QCOMPARE (last_sequence_number, 49u);
+    QCOMPARE (rig.state ().frequency (), Transceiver::Frequency {14078900});
+  }
+
+  Q_SLOT void keeps_ptt_transitions ()
+  {
+    FakeRig rig {&logger_};
+    rig.start (1);
+    rig.commands.clear ();
+    Transceiver::TransceiverState s;
+    s.online (true);
+    s.frequency (7074000);
+    rig.set (s, 2);
+    s.ptt (true);
+    rig.set (s, 3);
+    s.frequency (7075000);
+    rig.set (s, 4);
+    s.ptt (false);
+    rig.set (s, 5);
+    s.frequency (7076000);
+    rig.set (s, 6);
+    // unkey before QSY, key after it
+    QTRY_COMPARE (rig.commands, (QStringList {"frequency 7074000", "frequency 7075000", "PTT 1"
+            , "PTT 0", "frequency 7076000"}));
+  }
+
+  Q_SLOT void hamlib_dummy_rig ()
+  {
+    TransceiverFactory::ParameterPack params {};
+    params.ptt_type = TransceiverFactory::PTT_method_CAT;
+    params.split_mode = TransceiverFactory::split_mode_none;
+    HamlibTransceiver rig {&logger_, RIG_MODEL_DUMMY, params};
+    Transceiver::TransceiverState last;
+    connect (&rig, &Transceiver::update, [&] (Transceiver::TransceiverState const& state, unsigned) {
+        last = state;
+      });
+    rig.start (1);
+    Transceiver::TransceiverState s;
+    s.online (true);
+    s.mode (Transceiver::USB);
+    for (unsigned n = 2; n < 20; ++n)
+      {
+        s.frequency (14074000 + 1000 * n);
+        rig.set (s, n);
+      }
+    QTRY_COMPARE (last.frequency (), Transceiver::Frequency {14093000});
+    s.ptt (true);
+    rig.set (s, 20);
+    QTRY_VERIFY (last.ptt ());
+    s.ptt (false);
+    rig.set (s, 21);
+    QTRY_VERIFY (!last.ptt ());
+    rig.stop ();
+  }
+
+  Transceiver::logger_type logger_;
+};
+
+QTEST_MAIN (TestTransceiver);
+
+#include "test_transceiver.moc"
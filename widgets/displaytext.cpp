@@ -13,6 +13,8 @@
 #include <QListIterator>
 #include <QRegularExpression>
 #include <QScrollBar>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include "Configuration.hpp"
 #include "Decoder/decodedtext.h"
@@ -30,6 +32,7 @@ DisplayText::DisplayText(QWidget *parent)
   , erase_action_ {new QAction {tr ("&Erase"), this}}
   , high_volume_ {false}
   , modified_vertical_scrollbar_max_ {-1}
+  , batch_depth_ {0}
 {
   setReadOnly (true);
   setUndoRedoEnabled (false);
@@ -50,6 +53,60 @@ DisplayText::DisplayText(QWidget *parent)
   connect (erase_action_, &QAction::triggered, this, &DisplayText::erase);
 }
 
+DisplayText::Batch::Batch (DisplayText * display)
+  : display_ {display}
+{
+  display_->begin_batch ();
+}
+
+DisplayText::Batch::~Batch ()
+{
+  display_->end_batch ();
+  if (!display_->batch_depth_)
+    {
+      display_->worked_b4_.clear ();
+    }
+}
+
+void DisplayText::begin_batch ()
+{
+  if (!batch_depth_++)
+    {
+      batch_edit_ = QTextCursor {document ()};
+      batch_edit_.beginEditBlock ();
+    }
+}
+
+void DisplayText::end_batch ()
+{
+  if (!--batch_depth_)
+    {
+      batch_edit_.endEditBlock ();
+      batch_edit_ = QTextCursor {};
+      if (!batch_scroll_.isNull ())
+        {
+          auto cursor = batch_scroll_;
+          batch_scroll_ = QTextCursor {};
+          scroll_to (cursor);
+        }
+    }
+}
+
+void DisplayText::scroll_to (QTextCursor const& cursor)
+{
+  if (batch_depth_)
+    {
+      batch_scroll_ = cursor;   // when the batch ends
+      return;
+    }
+  if (!high_volume_ || !m_config || !m_config->decodes_from_top ())
+    {
+      setTextCursor (cursor);
+      ensureCursorVisible ();
+    }
+  document ()->setMaximumBlockCount (document ()->maximumBlockCount ());
+}
+
 void DisplayText::erase ()
 {
   clear ();
@@ -203,12 +260,7 @@ void DisplayText::insertText(QString const& text, QColor bg, QColor fg
 
   // position so viewport scrolled to left
   cursor.movePosition (QTextCursor::StartOfLine);
-  if (!high_volume_ || !m_config || !m_config->decodes_from_top ())
-    {
-      setTextCursor (cursor);
-      ensureCursorVisible ();
-    }
-  document ()->setMaximumBlockCount (document ()->maximumBlockCount ());
+  scroll_to (cursor);
 }
 
 void DisplayText::extend_vertical_scrollbar (int min, int max)
@@ -246,6 +298,15 @@ void DisplayText::extend_vertical_scrollbar (int min, int max)
 
 void DisplayText::new_period ()
 {
+  if (batch_depth_)
+    {
+      // the scroll range must include what the batch has added so far
+      auto depth = batch_depth_;
+      batch_depth_ = 1;
+      end_batch ();
+      begin_batch ();
+      batch_depth_ = depth;
+    }
   extend_vertical_scrollbar (verticalScrollBar ()->minimum (), verticalScrollBar ()->maximum ());
   if (high_volume_ && m_config && m_config->decodes_from_top () && !vertical_scroll_connection_)
     {
@@ -257,83 +318,156 @@ void DisplayText::new_period ()
   verticalScrollBar ()->setSliderPosition (verticalScrollBar ()->maximum ());
 }
 
+namespace
+{
+  bool is_CQ (DecodedText const& decodedText)
+  {
+    return decodedText.string ().contains (" CQ ")
+      || decodedText.string ().contains (" CQDX ")
+      || decodedText.string ().contains (" QRZ ");
+  }
+
+  bool is_73 (DecodedText const& decodedText)
+  {
+    return decodedText.messageWords ().filter (QRegularExpression {"^(73|RR73)$"}).size ();
+  }
+
+  void dx_call_and_grid (DecodedText const& decodedText, QString& call, QString& grid)
+  {
+    decodedText.deCallAndGrid (/*out*/ call, grid);
+    QRegularExpression grid_regexp {"\\A(?![Rr]{2}73)[A-Ra-r]{2}[0-9]{2}([A-Xa-x]{2}){0,1}\\z"};
+    if(!grid.contains(grid_regexp)) grid="";
+  }
+
+  // the call a message's worked before status is about, empty if there
+  // is none worth looking up
+  QString worked_b4_call (QString const& message, QString call)
+  {
+    if(call.length()==2) {
+      int i0=message.indexOf("CQ "+call);
+      call=message.mid(i0+6,-1);
+      i0=call.indexOf(" ");
+      call=call.mid(0,i0);
+    }
+    if(call.length()<3) return QString {};
+    if(!call.contains(QRegExp("[0-9]|[A-Z]"))) return QString {};
+    return call;
+  }
+
+  QString worked_b4_key (QString const& call, QString const& grid, QString const& mode, QString const& band)
+  {
+    return call + ' ' + grid + ' ' + mode + ' ' + band;
+  }
+
+  DisplayText::WorkedB4 worked_b4 (QString const& call, QString const& grid, LogBook const& logBook
+                                   , QString const& mode, QString const& band)
+  {
+    DisplayText::WorkedB4 b4 {};
+    b4.looked_up = logBook.countries ()->lookup (call);
+    logBook.match (call, mode, grid, b4.looked_up, b4.call, b4.country, b4.grid, b4.continent
+                   , b4.CQ_zone, b4.ITU_zone);
+    logBook.match (call, mode, grid, b4.looked_up, b4.call_on_band, b4.country_on_band, b4.grid_on_band
+                   , b4.continent_on_band, b4.CQ_zone_on_band, b4.ITU_zone_on_band, band);
+    if(grid=="") {
+      b4.grid=true;
+      b4.grid_on_band=true;
+    }
+    return b4;
+  }
+}
+
+void DisplayText::prefetchWorkedB4 (QList<DecodedText> const& decodes, QString const& mode
+                                    , LogBook const& logBook, QString const& currentBand)
+{
+  struct subject
+  {
+    QString call;
+    QString grid;
+    WorkedB4 b4;
+  };
+  QVector<subject> subjects;
+  QHash<QString, int> keys;
+  for (auto const& decodedText : decodes)
+    {
+      if (!is_CQ (decodedText) && !(is_73 (decodedText) && m_config && m_config->highlight_73 ()))
+        {
+          continue;             // not shown with its worked before status
+        }
+      QString dxCall;
+      QString dxGrid;
+      dx_call_and_grid (decodedText, dxCall, dxGrid);
+      auto const& message = decodedText.string ();
+      dxCall = worked_b4_call (message.left (message.indexOf (QChar::Nbsp)), dxCall);
+      auto const& key = worked_b4_key (dxCall, dxGrid, mode, currentBand);
+      if (dxCall.size () && !worked_b4_.contains (key) && !keys.contains (key))
+        {
+          keys.insert (key, subjects.size ());
+          subjects.push_back (subject {dxCall, dxGrid, WorkedB4 {}});
+        }
+    }
+  QtConcurrent::blockingMap (subjects, [&] (subject& s) {
+      s.b4 = worked_b4 (s.call, s.grid, logBook, mode, currentBand);
+    });
+  for (auto k = keys.cbegin (); k != keys.cend (); ++k)
+    {
+      worked_b4_.insert (k.key (), subjects[k.value ()].b4);
+    }
+}
+
 QString DisplayText::appendWorkedB4 (QString message, QString call, QString const& grid,
                                      QColor * bg, QColor * fg, LogBook const& logBook,
                                      QString const& currentBand, QString const& currentMode,
                                      QString extra)
 {
-  QString countryName;
-  bool callB4;
-  bool callB4onBand;
-  bool countryB4;
-  bool countryB4onBand;
-  bool gridB4;
-  bool gridB4onBand;
-  bool continentB4;
-  bool continentB4onBand;
-  bool CQZoneB4;
-  bool CQZoneB4onBand;
-  bool ITUZoneB4;
-  bool ITUZoneB4onBand;
-
-  if(call.length()==2) {
-    int i0=message.indexOf("CQ "+call);
-    call=message.mid(i0+6,-1);
-    i0=call.indexOf(" ");
-    call=call.mid(0,i0);
-  }
-  if(call.length()<3) return message;
-  if(!call.contains(QRegExp("[0-9]|[A-Z]"))) return message;
-
-  auto const& looked_up = logBook.countries ()->lookup (call);
-  logBook.match (call, currentMode, grid, looked_up, callB4, countryB4, gridB4, continentB4, CQZoneB4, ITUZoneB4);
-  logBook.match (call, currentMode, grid, looked_up, callB4onBand, countryB4onBand, gridB4onBand,
-                 continentB4onBand, CQZoneB4onBand, ITUZoneB4onBand, currentBand);
-  if(grid=="") {
-    gridB4=true;
-    gridB4onBand=true;
-  }
+  call = worked_b4_call (message, call);
+  if (!call.size ()) return message;
 
-  if(callB4onBand) m_points=0;
+  auto prefetched = worked_b4_.constFind (worked_b4_key (call, grid, currentMode, currentBand));
+  auto const& b4 = prefetched != worked_b4_.constEnd ()
+    ? *prefetched
+    : worked_b4 (call, grid, logBook, currentMode, currentBand);
+  auto const& looked_up = b4.looked_up;
+
+  if(b4.call_on_band) m_points=0;
 
   message = message.trimmed ();
 
   highlight_types types;
   // no shortcuts here as some types may be disabled
-  if (!countryB4) {
+  if (!b4.country) {
     types.push_back (Highlight::DXCC);
   }
-  if(!countryB4onBand) {
+  if(!b4.country_on_band) {
     types.push_back (Highlight::DXCCBand);
   }
-  if(!gridB4) {
+  if(!b4.grid) {
     types.push_back (Highlight::Grid);
   }
-  if(!gridB4onBand) {
+  if(!b4.grid_on_band) {
     types.push_back (Highlight::GridBand);
   }
-  if (!callB4) {
+  if (!b4.call) {
     types.push_back (Highlight::Call);
   }
-  if(!callB4onBand) {
+  if(!b4.call_on_band) {
     types.push_back (Highlight::CallBand);
   }
-  if (!continentB4) {
+  if (!b4.continent) {
     types.push_back (Highlight::Continent);
   }
-  if(!continentB4onBand) {
+  if(!b4.continent_on_band) {
     types.push_back (Highlight::ContinentBand);
   }
-  if (!CQZoneB4) {
+  if (!b4.CQ_zone) {
     types.push_back (Highlight::CQZone);
   }
-  if(!CQZoneB4onBand) {
+  if(!b4.CQ_zone_on_band) {
     types.push_back (Highlight::CQZoneBand);
   }
-  if (!ITUZoneB4) {
+  if (!b4.ITU_zone) {
     types.push_back (Highlight::ITUZone);
   }
-  if(!ITUZoneB4onBand) {
+  if(!b4.ITU_zone_on_band) {
     types.push_back (Highlight::ITUZoneBand);
   }
   if (m_config && m_config->lotw_users ().user (call))
@@ -442,24 +576,12 @@ void DisplayText::displayDecodedText(DecodedText const& decodedText, QString con
   m_bPrincipalPrefix=ppfx;
   QColor bg;
   QColor fg;
-  bool CQcall = false;
-  auto is_73 = decodedText.messageWords().filter (QRegularExpression {"^(73|RR73)$"}).size();
-  if (decodedText.string ().contains (" CQ ")
-      || decodedText.string ().contains (" CQDX ")
-      || decodedText.string ().contains (" QRZ "))
-    {
-      CQcall = true;
-    }
-  else
-    {
-      if (bCQonly) return;
-    }
+  bool CQcall = is_CQ (decodedText);
+  if (!CQcall && bCQonly) return;
   auto message = decodedText.string();
   QString dxCall;
   QString dxGrid;
-  decodedText.deCallAndGrid (/*out*/ dxCall, dxGrid);
-  QRegularExpression grid_regexp {"\\A(?![Rr]{2}73)[A-Ra-r]{2}[0-9]{2}([A-Xa-x]{2}){0,1}\\z"};
-  if(!dxGrid.contains(grid_regexp)) dxGrid="";
+  dx_call_and_grid (decodedText, dxCall, dxGrid);
   message = message.left (message.indexOf (QChar::Nbsp)).trimmed (); // strip appended info
   QString extra;
   if (haveFSpread)
@@ -473,7 +595,7 @@ void DisplayText::displayDecodedText(DecodedText const& decodedText, QString con
       message = message.left (ap_pos).trimmed ();
     }
   m_CQPriority="";
-  if (CQcall || (is_73 && (m_config->highlight_73 ())))
+  if (CQcall || (is_73 (decodedText) && (m_config->highlight_73 ())))
     {
       if (displayDXCCEntity)
         {
@@ -3,11 +3,15 @@
 #define DISPLAYTEXT_H
 
 #include <QTextEdit>
+#include <QTextCursor>
 #include <QFont>
 #include <QHash>
 #include <QPair>
+#include <QList>
 #include <QString>
 
+#include "logbook/AD1CCty.hpp"
+
 class QAction;
 class Configuration;
 class LogBook;
@@ -18,6 +22,39 @@ class DisplayText
 {
   Q_OBJECT
 public:
+  //
+  // Batch - appends made while one is alive are a single edit of the
+  // document, laid out and scrolled once when the outermost one goes
+  //
+  class Batch final
+  {
+  public:
+    explicit Batch (DisplayText *);
+    ~Batch ();
+
+  private:
+    Q_DISABLE_COPY (Batch)
+    DisplayText * display_;
+  };
+
+  // worked before status of a call and grid for one mode and band
+  struct WorkedB4
+  {
+    AD1CCty::Record looked_up;
+    bool call;
+    bool call_on_band;
+    bool country;
+    bool country_on_band;
+    bool grid;
+    bool grid_on_band;
+    bool continent;
+    bool continent_on_band;
+    bool CQ_zone;
+    bool CQ_zone_on_band;
+    bool ITU_zone;
+    bool ITU_zone_on_band;
+  };
+
   explicit DisplayText(QWidget *parent = nullptr);
   void set_configuration (Configuration const * configuration, bool high_volume = false)
   {
@@ -35,6 +72,12 @@ public:
   void displayQSY(QString text);
   void displayHoundToBeCalled(QString t, bool bAtTop=false, QColor bg = QColor {}, QColor fg = QColor {});
   void new_period ();
+
+  // work out, across threads, the worked before status of decodes about
+  // to be displayed in the current batch, mode and band must be those
+  // displayDecodedText will be given
+  void prefetchWorkedB4 (QList<DecodedText> const&, QString const& mode, LogBook const&
+                         , QString const& currentBand);
   QString CQPriority(){return m_CQPriority;};
   qint32 m_points;
   bool m_bDisplayPoints;
@@ -52,6 +95,9 @@ private:
   void mouseDoubleClickEvent (QMouseEvent *) override;
 
   void extend_vertical_scrollbar (int min, int max);
+  void begin_batch ();
+  void end_batch ();
+  void scroll_to (QTextCursor const&);
 
   Configuration const * m_config;
   bool m_bPrincipalPrefix;
@@ -67,6 +113,11 @@ private:
   bool high_volume_;
   QMetaObject::Connection vertical_scroll_connection_;
   long long modified_vertical_scrollbar_max_;
+
+  int batch_depth_;
+  QTextCursor batch_edit_;      // holds the document's edit block open
+  QTextCursor batch_scroll_;    // where to scroll to when the batch ends
+  QHash<QString, WorkedB4> worked_b4_; // prefetched for this batch
 };
 
 #endif // DISPLAYTEXT_H
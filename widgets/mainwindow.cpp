@@ -17,6 +17,7 @@
 #include <QKeyEvent>
 #include <QProcessEnvironment>
 #include <QSharedMemory>
+#include <QSystemSemaphore>
 #include <QFileDialog>
 #include <QTextBlock>
 #include <QProgressBar>
@@ -66,6 +67,7 @@
 #include "colorhighlighting.h"
 #include "widegraph.h"
 #include "sleep.h"
+#include "lib/shmem_events.h"
 #include "logqso.h"
 #include "Decoder/decodedtext.h"
 #include "Radio.hpp"
@@ -100,10 +102,6 @@
 
 extern "C" {
   //----------------------------------------------------- C and Fortran routines
-  void symspec_(struct dec_data *, int* k, double* trperiod, int* nsps, int* ingain,
-                bool* bLowSidelobes, int* minw, float* px, float s[], float* df3,
-                int* nhsym, int* npts8, float *m_pxmax, int* npct);
-
   void hspec_(short int d2[], int* k, int* nutc0, int* ntrperiod, int* nrxfreq, int* ntol,
               bool* bmsk144, bool* btrain, double const pcoeffs[], int* ingain,
               char const * mycall, char const * hiscall, bool* bshmsg, bool* bswl,
@@ -154,8 +152,6 @@ extern "C" {
 
   void morse_(char* msg, int* icw, int* ncw, fortran_charlen_t);
 
-  void wspr_downsample_(short int d2[], int* k);
-
   int savec2_(char const * fname, int* TR_seconds, double* dial_freq, fortran_charlen_t);
 
   void save_echo_params_(int* ndoptotal, int* ndop, int* nfrit, float* f1, float* fspread, short id2[], int* idir);
@@ -171,16 +167,12 @@ extern "C" {
 
   void wav12_(short d2[], short d1[], int* nbytes, short* nbitsam2);
 
-  void refspectrum_(short int d2[], bool* bclearrefspec,
-                    bool* brefspec, bool* buseref, const char* c_fname, fortran_charlen_t);
-
   void freqcal_(short d2[], int* k, int* nkhz,int* noffset, int* ntol,
                 char line[], fortran_charlen_t);
 
   void calibrate_(char const * data_dir, int* iz, double* a, double* b, double* rms,
                   double* sigmaa, double* sigmab, int* irc, fortran_charlen_t);
 
-  void foxgen_();
 
   void plotsave_(float swide[], int* m_w , int* m_h1, int* irow);
 
@@ -260,6 +252,17 @@ namespace
     auto second = time.second ();
     return now.msecsTo (now.addSecs (second > 30 ? 60 - second : -second)) - time.msec ();
   }
+
+  // a decode's text with the time, SNR, DT and audio frequency taken
+  // from jt9's record rather than the text, if the record has them
+  DecodedText decoded_text (QString const& text, decode_record_t const * record)
+  {
+    if (record && record->nutc >= 0)
+      {
+        return DecodedText {text, record->nutc, record->snr, record->dt, qRound (record->freq)};
+      }
+    return DecodedText {text};
+  }
 }
 
 //--------------------------------------------------- MainWindow constructor
@@ -434,6 +437,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
       },
   m_sfx {"P",  "0",  "1",  "2",  "3",  "4",  "5",  "6",  "7",  "8",  "9",  "A"},
   mem_jt9 {shdmem},
+  m_jt9Records {nullptr},
+  m_jt9RecordsRead {0},
   m_downSampleFactor (downSampleFactor),
   m_audioThreadPriority (QThread::HighPriority),
   m_bandEdited {false},
@@ -519,6 +524,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   connect (this, &MainWindow::endTransmitMessage, m_modulator, &Modulator::stop);
   connect (this, &MainWindow::tune, m_modulator, &Modulator::tune);
   connect (this, &MainWindow::sendMessage, m_modulator, &Modulator::start);
+  connect (this, &MainWindow::foxWaveform, m_modulator, &Modulator::setFoxWaveform);
+  connect (this, &MainWindow::chatWaveform, m_modulator, &Modulator::setChatWaveform);
   connect (&m_audioThread, &QThread::finished, m_modulator, &QObject::deleteLater);
 
   // hook up the audio input stream signals, slots and disposal
@@ -536,7 +543,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
 
   // hook up the detector signals, slots and disposal
   connect (this, &MainWindow::FFTSize, m_detector, &Detector::setBlockSize);
-  connect(m_detector, &Detector::framesWritten, this, &MainWindow::dataSink);
+  connect (m_detector, &Detector::framesWritten, &m_spectrumStage, &SpectrumStage::framesWritten, Qt::DirectConnection);
+  connect (&m_spectrumStage, &SpectrumStage::blockReady, this, &MainWindow::spectrumSink);
   connect (&m_audioThread, &QThread::finished, m_detector, &QObject::deleteLater);
 
   // setup the waterfall
@@ -567,6 +575,11 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
         }
     });
 
+  // ALL.TXT is written on its own thread, it reports failures here
+  connect (&m_allTxt, &AllTxtWriter::error, this, [this] (QString const& message) {
+      MessageBox::warning_message (this, tr ("Log File Error"), message);
+    });
+
   // Network message handlers
   m_messageClient->enable (m_config.accept_udp_requests ());
   connect (m_messageClient, &MessageClient::clear_decodes, [this] (quint8 window) {
@@ -1021,6 +1034,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   }
   // ── End HF Chat mode ────────────────────────────────────────────
 
+  m_spectrumStage.setParameters (spectrumParameters ());
+  m_spectrumStage.start (QThread::HighPriority);
   m_audioThread.start (m_audioThreadPriority);
 
 #ifdef WIN32
@@ -1053,8 +1068,29 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
       }
   }
 
+  // create (and reset) the events that wake jt9 instead of it
+  // polling the shared memory segment
+  m_jt9StartEvent.reset (new QSystemSemaphore {decode_start_event_key (mem_jt9->key ()), 0, QSystemSemaphore::Create});
+  m_jt9AckEvent.reset (new QSystemSemaphore {decode_ack_event_key (mem_jt9->key ()), 0, QSystemSemaphore::Create});
+  bool jt9_events {QSystemSemaphore::NoError == m_jt9StartEvent->error ()
+      && QSystemSemaphore::NoError == m_jt9AckEvent->error ()};
+  if (!jt9_events)
+    {
+      LOG_WARN ("jt9 wakeup events unavailable, jt9 will poll: " << m_jt9StartEvent->errorString () << " " << m_jt9AckEvent->errorString ());
+      m_jt9StartEvent.reset ();
+      m_jt9AckEvent.reset ();
+    }
+
   to_jt9(0,0,0);     //initialize IPC variables
 
+  // if there is room after the decoder data, jt9 passes its decodes
+  // to us as records rather than text
+  if (mem_jt9->size () >= static_cast<int> (sizeof (dec_data_t) + sizeof (decode_records_t)))
+    {
+      m_jt9Records = reinterpret_cast<decode_records_t const *> (static_cast<char const *> (mem_jt9->constData ()) + sizeof (dec_data_t));
+      m_jt9RecordsRead = m_jt9Records->nwritten;
+    }
+
   QStringList jt9_args {
     "-s", QApplication::applicationName () // shared memory key,
                                            // includes rig
@@ -1071,10 +1107,16 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
       // mode decoder in parallel.
       , "-m", QString::number (qMin (qMax (QThread::idealThreadCount () - 1, 1), 3)) //FFTW threads
 
+      // FT8 candidates are decoded in parallel, nothing else is
+      // decoded while they are so all CPU threads can be used.
+      , "-j", QString::number (qMax (QThread::idealThreadCount (), 1)) //FT8 decoder threads
+
       , "-e", QDir::toNativeSeparators (m_appDir)
       , "-a", QDir::toNativeSeparators (m_config.writeable_data_dir ().absolutePath ())
       , "-t", QDir::toNativeSeparators (m_config.temp_dir ().absolutePath ())
       };
+  if (jt9_events) jt9_args << "-E";
+  if (m_jt9Records) jt9_args << "-R";
   QProcessEnvironment new_env {m_env};
   new_env.insert ("OMP_STACKSIZE", "4M");
   proc_jt9.setProcessEnvironment (new_env);
@@ -1273,6 +1315,8 @@ MainWindow::~MainWindow()
   fftwf_export_wisdom_to_filename (fname.toLocal8Bit ());
   m_audioThread.quit ();
   m_audioThread.wait ();
+  m_spectrumStage.stop ();
+  m_spectrumStage.wait ();
   remove_child_from_event_filter (this);
   memset(ipc_qmap,0,4096);         //Zero all of QMAP shared memory
 }
@@ -1551,6 +1595,7 @@ void MainWindow::readSettings()
   ui->decodes_splitter->restoreState(m_settings->value("SplitterState").toByteArray());
   ui->sbNB->setValue(m_settings->value("Blanker",0).toInt());
   ui->sbEchoAvg->setValue(m_settings->value("EchoAvg",10).toInt());
+  m_psk_Reporter.setSpotCacheTimeout (m_settings->value ("PSKReporterSpotTimeout", 300).toInt ());
   {
     auto const& coeffs = m_settings->value ("PhaseEqualizationCoefficients"
                                             , QList<QVariant> {0., 0., 0., 0., 0.}).toList ();
@@ -1718,13 +1763,51 @@ void MainWindow::fixStop()
   }
 }
 
+//------------------------------------------------------ spectrumParameters()
+SpectrumStage::Parameters MainWindow::spectrumParameters ()
+{
+  SpectrumStage::Parameters p;
+  p.TRperiod=m_TRperiod;
+  p.nsps=m_nsps;
+  if(m_bFastMode) p.nsps=6912;
+  p.in_gain=m_inGain;
+  p.low_sidelobes=m_config.lowSidelobes();
+  p.nsmo=m_wideGraph->smoothYellow()-1;
+  if(m_mode.startsWith("FST4")) p.npct=ui->sbNB->value();
+  p.nfa=m_wideGraph->nStartFreq();
+  p.nfb=m_wideGraph->Fmax();
+  if(m_mode=="FST4") {
+    p.nfa=ui->sbF_Low->value();
+    p.nfb=ui->sbF_High->value();
+  }
+  p.disk_data=m_diskData;
+  m_bUseRef=m_wideGraph->useRef();
+  p.use_ref=m_bUseRef;
+  p.ref_spec=m_bRefSpec;
+  p.clear_ref_spec=m_bClearRefSpec;
+  m_bClearRefSpec=false;
+  p.symspec=!((m_mode=="MSK144" or m_bFast9) and m_bFastMode);
+  p.wspr_downsample=(m_mode=="WSPR" or m_mode=="FST4W");
+  p.ref_spec_path=QDir::toNativeSeparators(m_config.writeable_data_dir ().absoluteFilePath ("refspec.dat")).toLocal8Bit ();
+  return p;
+}
+
 //-------------------------------------------------------------- dataSink()
 void MainWindow::dataSink(qint64 frames)
 {
-  static float s[NSMAX];
+  // synchronous path for data read from disk, see diskDat()
+  m_spectrumStage.setParameters (spectrumParameters ());
+  spectrumSink (m_spectrumStage.process (frames));
+}
+
+//---------------------------------------------------------- spectrumSink()
+void MainWindow::spectrumSink(SpectrumStage::Block const& block)
+{
   char line[80];
-  int k(frames);
-  auto fname {QDir::toNativeSeparators(m_config.writeable_data_dir ().absoluteFilePath ("refspec.dat")).toLocal8Bit ()};
+  int k(block.k);
+
+  m_spectrumStage.delivered (block);
+  m_spectrumStage.setParameters (spectrumParameters ());  // for the next block
 
   if(m_diskData) {
     dec_data.params.ndiskdat=1;
@@ -1733,38 +1816,21 @@ void MainWindow::dataSink(qint64 frames)
     m_wideGraph->setDiskUTC(-1);
   }
 
-  m_bUseRef=m_wideGraph->useRef();
-  if(!m_diskData) {
-    refspectrum_(&dec_data.d2[k-m_nsps/2],&m_bClearRefSpec,&m_bRefSpec,
-                 &m_bUseRef, fname.constData (), (FCL)fname.size ());
-  }
-  m_bClearRefSpec=false;
-
   if(m_mode=="MSK144" or m_bFast9) {
-    fastSink(frames);
+    fastSink(block.k);
     if(m_bFastMode) return;
   }
 
-// Get power, spectrum, and ihsym
-  dec_data.params.nfa=m_wideGraph->nStartFreq();
-  dec_data.params.nfb=m_wideGraph->Fmax();
-  if(m_mode=="FST4") {
-    dec_data.params.nfa=ui->sbF_Low->value();
-    dec_data.params.nfb=ui->sbF_High->value();
-  }
-  int nsps=m_nsps;
-  if(m_bFastMode) nsps=6912;
-  int nsmo=m_wideGraph->smoothYellow()-1;
-  bool bLowSidelobes=m_config.lowSidelobes();
-  int npct=0;
-  if(m_mode.startsWith("FST4")) npct=ui->sbNB->value();
-  symspec_(&dec_data,&k,&m_TRperiod,&nsps,&m_inGain,&bLowSidelobes,&nsmo,&m_px,s,
-           &m_df3,&m_ihsym,&m_npts8,&m_pxmax,&npct);
-  if(m_mode=="WSPR" or m_mode=="FST4W") wspr_downsample_(dec_data.d2,&k);
+  if(!block.have_spectrum) return; // mode changed since the block was processed
+  m_px=block.px;
+  m_pxmax=block.pxmax;
+  m_df3=block.df3;
+  m_ihsym=block.ihsym;
+  m_npts8=block.npts8;
   if(m_ihsym <=0) return;
   if(ui) ui->signal_meter_widget->setValue(m_px,m_pxmax); // Update thermometer
   if(m_monitoring || m_diskData) {
-    m_wideGraph->dataSink2(s,m_df3,m_ihsym,m_diskData,m_px);
+    m_wideGraph->dataSink2(const_cast<float *> (block.s.constData ()),m_df3,m_ihsym,m_diskData,m_px);
   }
   if(m_mode=="MSK144") return;
 
@@ -1776,7 +1842,10 @@ void MainWindow::dataSink(qint64 frames)
     int RxFreq=ui->RxFreqSpinBox->value ();
     int nkhz=(m_freqNominal+RxFreq)/1000;
     int ftol = ui->sbFtol->value ();
-    freqcal_(&dec_data.d2[0], &k, &nkhz, &RxFreq, &ftol, &line[0], (FCL)80);
+    {
+      QMutexLocker lock {SpectrumStage::fortran_mutex ()};
+      freqcal_(&dec_data.d2[0], &k, &nkhz, &RxFreq, &ftol, &line[0], (FCL)80);
+    }
     QString t=QString::fromLatin1(line);
     DecodedText decodedtext {t};
     ui->decodedTextBrowser->displayDecodedText (decodedtext, m_config.my_callsign(),
@@ -1845,8 +1914,11 @@ void MainWindow::dataSink(qint64 frames)
         int idir=-1;
         save_echo_params_(&nDopTotal,&nDop,&nfrit,&f1,&width,dec_data.d2,&idir);
       }
-      avecho_(dec_data.d2,&nDop,&nfrit,&nauto,&navg,&nqual,&f1,&xlevel,&sigdb,
-          &dBerr,&dfreq,&width,&m_diskData);
+      {
+        QMutexLocker lock {SpectrumStage::fortran_mutex ()};
+        avecho_(dec_data.d2,&nDop,&nfrit,&nauto,&navg,&nqual,&f1,&xlevel,&sigdb,
+                &dBerr,&dfreq,&width,&m_diskData);
+      }
       //Don't restart Monitor after an Echo transmission
       if(m_bEchoTxed and !m_auto) {
         monitor(false);
@@ -1932,7 +2004,11 @@ void MainWindow::dataSink(qint64 frames)
         int nsec=120;
         int nbfo=1500;
         double f0m1500=m_freqNominal/1000000.0 + nbfo - 1500;
-        int err = savec2_(c2name.constData (),&nsec,&f0m1500, (FCL)c2name.size());
+        int err;
+        {
+          QMutexLocker lock {SpectrumStage::fortran_mutex ()};
+          err = savec2_(c2name.constData (),&nsec,&f0m1500, (FCL)c2name.size());
+        }
         if (err!=0) MessageBox::warning_message (this, tr ("Error saving c2 file"), c2name);
       }
     }
@@ -1967,7 +2043,14 @@ void MainWindow::dataSink(qint64 frames)
 
 void MainWindow::startP1()
 {
-  p1.start (QDir::toNativeSeparators (QDir {QApplication::applicationDirPath ()}.absoluteFilePath ("wsprd")), m_cmndP1);
+  // wsprd stays running between periods, keeping its FFT plans and
+  // hash table, and takes each decode as a job on its standard input
+  if (QProcess::NotRunning == p1.state ())
+    {
+      p1.start (QDir::toNativeSeparators (QDir {QApplication::applicationDirPath ()}.absoluteFilePath ("wsprd")), {"--serve"});
+    }
+  showStatusMessage (QString {"Decoding: \"%1\""}.arg (m_cmndP1.join ("\" \"")));
+  p1.write ((m_cmndP1.join ('\n') + "\n\n").toLocal8Bit ());
 }
 
 QString MainWindow::save_wave_file (QString const& name, short const * data, int samples,
@@ -2054,11 +2137,14 @@ void MainWindow::fastSink(qint64 frames)
   float pxmax = 0;
   float rmsNoGain = 0;
   int ftol = ui->sbFtol->value ();
-  hspec_(dec_data.d2,&k,&nutc0,&nTRpDepth,&RxFreq,&ftol,&bmsk144,
-      &m_bTrain,m_phaseEqCoefficients.constData(),&m_inGain,&dec_data.params.mycall[0],
-      &dec_data.params.hiscall[0],&bshmsg,&bswl,
-      data_dir.constData (),fast_green,fast_s,&fast_jh,&pxmax,&rmsNoGain,&line[0],(FCL)12,
-      (FCL)12,(FCL)data_dir.size (),(FCL)80);
+  {
+    QMutexLocker lock {SpectrumStage::fortran_mutex ()};
+    hspec_(dec_data.d2,&k,&nutc0,&nTRpDepth,&RxFreq,&ftol,&bmsk144,
+        &m_bTrain,m_phaseEqCoefficients.constData(),&m_inGain,&dec_data.params.mycall[0],
+        &dec_data.params.hiscall[0],&bshmsg,&bswl,
+        data_dir.constData (),fast_green,fast_s,&fast_jh,&pxmax,&rmsNoGain,&line[0],(FCL)12,
+        (FCL)12,(FCL)data_dir.size (),(FCL)80);
+  }
   float px = fast_green[fast_jh];
   QString t;
   t = t.asprintf(" Rx noise: %5.1f ",px);
@@ -2271,6 +2357,7 @@ void MainWindow::monitor (bool state)
   ui->monitorButton->setChecked (state);
   if (state) {
     m_diskData = false; // no longer reading WAV files
+    m_spectrumStage.setParameters (spectrumParameters ());
     if (!m_monitoring) Q_EMIT resumeAudioInputStream ();
   } else {
     Q_EMIT suspendAudioInputStream ();
@@ -2868,6 +2955,8 @@ void MainWindow::closeEvent(QCloseEvent * e)
   plotsave_(&sw,&nw,&nh,&irow);
   to_jt9(m_ihsym,999,-1);          //Tell jt9 to terminate
   if (!proc_jt9.waitForFinished(1000)) proc_jt9.close();
+  p1.closeWriteChannel ();          // wsprd exits at the end of its jobs
+  if (!p1.waitForFinished(1000)) p1.close();
   mem_jt9->detach();
   Q_EMIT finished ();
   QMainWindow::closeEvent (e);
@@ -3675,7 +3764,11 @@ void MainWindow::decode()                                       //decode()
             dec_data.params.hiscall, (FCL)8000, (FCL)12, (FCL)12)));
       } else {
         mem_jt9->lock ();
-        memcpy(to, from, qMin(mem_jt9->size(), size));
+        {
+          // symspec may be updating the spectra on the spectrum stage
+          QMutexLocker lock {SpectrumStage::fortran_mutex ()};
+          memcpy(to, from, qMin(mem_jt9->size(), size));
+        }
         mem_jt9->unlock ();
         to_jt9(m_ihsym,1,-1);                //Send m_ihsym to jt9[.exe] and start decoding
         decodeBusy(true);
@@ -3739,11 +3832,21 @@ void MainWindow::to_jt9(qint32 n, qint32 istart, qint32 idone)
       if(istart>=0) dd->ipc[1]=istart;
       if(idone>=0)  dd->ipc[2]=idone;
       mem_jt9->unlock ();
+      // wake jt9 if it is blocked waiting for either of these
+      if (m_jt9StartEvent && istart > 0) m_jt9StartEvent->release ();
+      if (m_jt9AckEvent && (idone > 0 || 999 == istart)) m_jt9AckEvent->release ();
     }
 }
 
 void MainWindow::decodeDone ()
 {
+  m_allTxt.sync ();             // commit this period's lines to disk
+  auto spectrum_stats = m_spectrumStage.take_statistics ();
+  LOG_DEBUG ("spectrum stage: " << spectrum_stats.blocks << " blocks, "
+             << spectrum_stats.dropped << " dropped, latency mean/max "
+             << spectrum_stats.mean_stage_us << "/" << spectrum_stats.max_stage_us
+             << " us, to GUI " << spectrum_stats.mean_delivery_us << "/"
+             << spectrum_stats.max_delivery_us << " us");
   if(m_mode=="Q65") m_wideGraph->drawRed(0,0);
   if ("FST4W" == m_mode)
     {
@@ -4098,22 +4201,49 @@ void MainWindow::readFromStdout()                             //readFromStdout
     bDisplayPoints=(m_mode=="FT4" or m_mode=="FT8") and
       (m_specOp==SpecOp::ARRL_DIGI or m_ActiveStationsWidget->isVisible());
   }
+  DisplayText::Batch batch {ui->decodedTextBrowser};
+  if (m_jt9Records) {
+    prefetchWorkedB4 (unreadDecodeRecords ());
+  } else {
+    prefetchWorkedB4 (proc_jt9.peek (proc_jt9.bytesAvailable ()).split ('\n'));
+  }
   while(proc_jt9.canReadLine()) {
     auto line_read = proc_jt9.readLine ();
     if (auto p = std::strpbrk (line_read.constData (), "\n\r")) {
       // truncate before line ending chars
       line_read = line_read.left (p - line_read.constData ());
     }
+    decode_record_t const * record {nullptr};
+    if (m_jt9Records && !line_read.size ()) {
+      // an empty line says jt9 has added a record to the ring
+      record = nextDecodeRecord ();
+      if (!record) continue;
+      line_read = QByteArray {record->line, sizeof record->line};
+      while (line_read.endsWith (' ')) line_read.chop (1);
+    }
     if(bDisplayPoints) line_read=line_read.replace("a7","  ");
+    bool is_a7 = record ? 7 == record->nap && !bDisplayPoints : line_read.contains ("a7");
     bool haveFSpread {false};
     float fSpread {0.};
     if (m_mode.startsWith ("FST4"))
       {
-        auto text = line_read.mid (64, 6).trimmed ();
-        if (text.size ())
+        if (record)
+          {
+            haveFSpread = record->w50 >= 0.f;
+            if (haveFSpread)
+              {
+                fSpread = record->w50;
+                line_read = line_read.left (64);
+              }
+          }
+        else
           {
-            fSpread = text.toFloat (&haveFSpread);
-            line_read = line_read.left (64);
+            auto text = line_read.mid (64, 6).trimmed ();
+            if (text.size ())
+              {
+                fSpread = text.toFloat (&haveFSpread);
+                line_read = line_read.left (64);
+              }
           }
         auto const& cs = m_config.my_callsign ().toLocal8Bit ();
         if ("FST4W" == m_mode && ui->cbNoOwnCall->isChecked ()
@@ -4124,7 +4254,7 @@ void MainWindow::readFromStdout()                             //readFromStdout
       }
 
     // Don't allow a7 decodes during the first period because they can be leftovers from the previous band
-    if (!(no_a7_decodes && line_read.contains("a7"))) {
+    if (!(no_a7_decodes && is_a7)) {
 
     if (m_mode!="FT8" and m_mode!="FT4" and !m_mode.startsWith ("FST4") and m_mode!="Q65") {
       //Pad 22-char msg to at least 37 chars
@@ -4135,10 +4265,16 @@ void MainWindow::readFromStdout()                             //readFromStdout
 
 //    qint64 ms = QDateTime::currentMSecsSinceEpoch() % 86400000;
 //    double fTR=float((ms%int(1000.0*m_TRperiod)))/int(1000.0*m_TRperiod);
-    if(line_read.indexOf("<DecodeFinished>") >= 0) {
-      m_bDecoded =  line_read.mid(20).trimmed().toInt() > 0;
-      int n=line_read.trimmed().size();
-      int n2=line_read.trimmed().mid(n-7).toInt();
+    if(record ? DECODE_RECORD_FINISHED == record->kind : line_read.indexOf("<DecodeFinished>") >= 0) {
+      int n2;
+      if(record) {
+        m_bDecoded = record->ndecoded > 0;
+        n2=record->navg0;
+      } else {
+        m_bDecoded =  line_read.mid(20).trimmed().toInt() > 0;
+        int n=line_read.trimmed().size();
+        n2=line_read.trimmed().mid(n-7).toInt();
+      }
       int n0=n2/1000;
       int n1=n2%1000;
       if(m_mode=="Q65") {
@@ -4151,7 +4287,10 @@ void MainWindow::readFromStdout()                             //readFromStdout
     } else {
       m_nDecodes+=1;
       if(m_mode!="Q65") ndecodes_label.setText(QString::number(m_nDecodes));
-      if(m_mode=="JT4" or m_mode=="JT65" or m_mode=="Q65") {
+      if(record) {
+        navg=record->navg;
+        if(navg>=2) bAvgMsg=true;
+      } else if(m_mode=="JT4" or m_mode=="JT65" or m_mode=="Q65") {
         //### Do something about Q65 here ?  ###
         int nf=line_read.indexOf("f");
         if(nf>0) {
@@ -4200,8 +4339,8 @@ void MainWindow::readFromStdout()                             //readFromStdout
         {
           uploadWSPRSpots (true, line_read);
         }
-      DecodedText decodedtext0 {QString::fromUtf8(line_read.constData())};
-      DecodedText decodedtext {QString::fromUtf8(line_read.constData()).remove("TU; ")};
+      DecodedText decodedtext0 {decoded_text (QString::fromUtf8(line_read.constData()), record)};
+      DecodedText decodedtext {decoded_text (QString::fromUtf8(line_read.constData()).remove("TU; "), record)};
 
       // HF Chat: feed all decoded messages to ChatProtocol
       // (processIncoming filters by header format and target ID)
@@ -4504,6 +4643,67 @@ void MainWindow::readFromStdout()                             //readFromStdout
   }
 }
 
+//
+// The next of jt9's decode records in shared memory, null if there is
+// none because records were overwritten before we read them
+//
+decode_record_t const * MainWindow::nextDecodeRecord ()
+{
+  auto nwritten = m_jt9Records->nwritten;
+  if (nwritten - m_jt9RecordsRead > NDECREC)
+    {
+      LOG_WARN ("jt9 decode records overrun, " << nwritten - m_jt9RecordsRead - NDECREC << " lost");
+      m_jt9RecordsRead = nwritten - NDECREC;
+    }
+  if (m_jt9RecordsRead == nwritten) return nullptr;
+  return &m_jt9Records->rec[m_jt9RecordsRead++ % NDECREC];
+}
+
+//
+// The text of the decode records jt9 has written that we have not yet
+// read
+//
+QList<QByteArray> MainWindow::unreadDecodeRecords () const
+{
+  auto nwritten = m_jt9Records->nwritten;
+  QList<QByteArray> lines;
+  for (auto n = std::max (m_jt9RecordsRead, nwritten - NDECREC); n < nwritten; ++n)
+    {
+      auto const& record = m_jt9Records->rec[n % NDECREC];
+      if (DECODE_RECORD_FINISHED != record.kind)
+        {
+          lines << QByteArray {record.line, sizeof record.line};
+        }
+    }
+  return lines;
+}
+
+//
+// Work out the worked before status of a burst of decodes across
+// threads before they are displayed one by one
+//
+void MainWindow::prefetchWorkedB4 (QList<QByteArray> const& lines)
+{
+  if (!m_config.DXCC () || (m_mode=="FT8" and SpecOp::FOX == m_specOp)) return;
+  QList<DecodedText> decodes;
+  for (auto line : lines)
+    {
+      if (auto p = std::strpbrk (line.constData (), "\n\r")) {
+        line = line.left (p - line.constData ());
+      }
+      while (line.endsWith (' ')) line.chop (1);
+      if (!line.size () || line.contains ("<DecodeFinished>")) continue;
+      if (m_mode!="FT8" and m_mode!="FT4" and !m_mode.startsWith ("FST4") and m_mode!="Q65") {
+        line = line.left(44) + "              " + line.mid(44);
+      }
+      decodes << DecodedText {QString::fromUtf8 (line.constData ())};
+    }
+  if (decodes.size () > 1)      // not worth it for one
+    {
+      ui->decodedTextBrowser->prefetchWorkedB4 (decodes, m_mode, m_logBook, m_currentBandPeriod);
+    }
+}
+
 //
 // start_tolerance - only respond to "DE ..." and free text 73
 //                   messages within +/- this value
@@ -4958,7 +5158,7 @@ void MainWindow::guiUpdate()
               if(m_config.split_mode()) foxcom_.nfreq = foxcom_.nfreq - m_XIT;  //Fox Tx freq
               QString foxCall=m_config.my_callsign() + "         ";
               ::memcpy(foxcom_.mycall, foxCall.toLatin1(), sizeof foxcom_.mycall); //Copy Fox callsign into foxcom_
-              foxgen_();
+              foxSynthesize();
             }
           }
         }
@@ -8031,8 +8231,7 @@ void MainWindow::on_actionErase_ALL_TXT_triggered()          //Erase ALL.TXT
   int ret = MessageBox::query_message (this, tr ("Confirm Erase"),
                                          tr ("Are you sure you want to erase file ALL.TXT?"));
   if(ret==MessageBox::Yes) {
-    QFile f {m_config.writeable_data_dir ().absoluteFilePath ("ALL.TXT")};
-    f.remove();
+    m_allTxt.remove (m_config.writeable_data_dir ().absoluteFilePath ("ALL.TXT"));
     m_RxLog=1;
   }
 }
@@ -10269,7 +10468,7 @@ void MainWindow::foxTxSequencer()
  * is to be started.
  *
  * Determine what the Tx message(s) will be for each active slot, call
- * foxgen() to generate and accumulate the corresponding waveform.
+ * foxSynthesize() to have the Modulator generate the corresponding waveform.
 */
 
   qint64 now=QDateTime::currentMSecsSinceEpoch()/1000;
@@ -10447,7 +10646,7 @@ Transmit:
   if(m_config.split_mode()) foxcom_.nfreq = foxcom_.nfreq - m_XIT;  //Fox Tx freq
   QString foxCall=m_config.my_callsign() + "         ";
   ::memcpy(foxcom_.mycall, foxCall.toLatin1(),sizeof foxcom_.mycall);   //Copy Fox callsign into foxcom_
-  foxgen_();
+  foxSynthesize();
   m_tFoxTxSinceCQ++;
 
   for(QString hc: m_foxQSO.keys()) {               //Check for strikeout or timeout
@@ -10590,6 +10789,17 @@ void MainWindow::foxGenWaveform(int i,QString fm)
   writeFoxQSO(t + fm.trimmed());
 }
 
+void MainWindow::foxSynthesize()
+{
+//Hand the slots in foxcom_ to the Modulator, which generates the waveform as it goes
+  auto waveform = QSharedPointer<FoxWaveform>::create (foxcom_.nfreq);
+  for(int i=0; i<foxcom_.nslots; i++) {
+    waveform->add_slot(QString::fromLatin1(&foxcom_.cmsg[i][0],40).trimmed());
+  }
+  waveform->normalise();                  //Peak to full scale, as foxgen did
+  Q_EMIT foxWaveform (waveform);
+}
+
 void MainWindow::writeFoxQSO(QString const& msg)
 {
   QString t;
@@ -10777,23 +10987,8 @@ void MainWindow::write_all(QString txRx, QString message)
     line=message;
   }
 
-  QFile f{m_config.writeable_data_dir().absoluteFilePath(file_name)};
-  if (f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append)) {
-    QTextStream out(&f);
-    out << line.trimmed()
-#if QT_VERSION >= QT_VERSION_CHECK (5, 15, 0)
-        << Qt::endl
-#else
-        << endl
-#endif
-      ;
-    f.close();
-  } else {
-    auto const& message2 = tr ("Cannot open \"%1\" for append: %2")
-        .arg (f.fileName ()).arg (f.errorString ());
-    QTimer::singleShot (0, [=] {                   // don't block guiUpdate
-      MessageBox::warning_message(this, tr ("Log File Error"), message2); });
-  }
+  // queued, errors come back through AllTxtWriter::error
+  m_allTxt.append (m_config.writeable_data_dir().absoluteFilePath(file_name), line.trimmed());
  }
 }
 
@@ -11037,7 +11232,7 @@ void MainWindow::onChatBroadcastRequested(const QString &targetId, const QString
 
 void MainWindow::onChatDirectSendRequested(const QString &targetId, const QString &text)
 {
-  // Lancer l'encodage FT8 direct et remplir foxcom_.wave[]
+  // Lancer l'encodage FT8 direct, la synthèse suit pendant l'émission
   double txFreq = ui->TxFreqSpinBox->value() - m_XIT;
   m_chatProtocol->sendDirect(targetId, text, txFreq);
   // Le signal directTxReady sera émis par ChatProtocol → onChatDirectTx
@@ -11069,10 +11264,11 @@ void MainWindow::onChatDirectTx(int totalSymbols, int numFragments)
     m_transmitting = true;
     transmitDisplay(true);
 
-    // Launch Modulator with precomputed wave[] (toneSpacing = -3)
+    // Launch Modulator with the streamed chat waveform (toneSpacing = -3)
+    Q_EMIT chatWaveform(m_chatProtocol->directTxWaveform());
     Q_EMIT sendMessage("FT8", totalSymbols, 1920.0,
                        ui->TxFreqSpinBox->value() - m_XIT,
-                       -3.0,  // toneSpacing < 0 → read from foxcom_.wave[]
+                       -3.0,  // toneSpacing -3 → read from the chat waveform
                        m_soundOutput, m_config.audio_output_channel(),
                        true,   // synchronize
                        false,  // fastMode
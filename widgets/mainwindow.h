@@ -38,6 +38,11 @@
 #include "Transceiver/Transceiver.hpp"
 #include "DisplayManual.hpp"
 #include "Network/PSKReporter.hpp"
+#include "AllTxtWriter.hpp"
+#include "Detector/SpectrumStage.hpp"
+#include "Modulator/FoxWaveform.hpp"
+#include "Modulator/ChatWaveform.hpp"
+#include "Modulator/TxSymbols.hpp"
 #include "logbook/logbook.h"
 #include "astro.h"
 #include "MessageBox.hpp"
@@ -53,14 +58,9 @@
 #define NUM_FT8_SYMBOLS 79
 #define NUM_FT4_SYMBOLS 105
 #define NUM_FST4_SYMBOLS 160             //240/2 data + 5*8 sync
-#define NUM_CW_SYMBOLS 250
-#define MAX_NUM_SYMBOLS 250
 #define TX_SAMPLE_RATE 48000
 #define NRING 3456000
 
-extern int volatile itone[MAX_NUM_SYMBOLS];   //Audio tones for all Tx symbols
-extern int volatile icw[NUM_CW_SYMBOLS];	    //Dits for CW ID
-
 //--------------------------------------------------------------- MainWindow
 namespace Ui {
   class MainWindow;
@@ -68,6 +68,7 @@ namespace Ui {
 
 class QProcessEnvironment;
 class QSharedMemory;
+class QSystemSemaphore;
 class QSplashScreen;
 class QSettings;
 class QLineEdit;
@@ -123,6 +124,7 @@ public slots:
   void showSoundOutError(const QString& errorMsg);
   void showStatusMessage(const QString& statusMsg);
   void dataSink(qint64 frames);
+  void spectrumSink(SpectrumStage::Block const&);
   void fastSink(qint64 frames);
   void diskDat();
   void freezeDecode(int n);
@@ -373,6 +375,8 @@ private:
       SoundOutput *, AudioDevice::Channel = AudioDevice::Mono,
       bool synchronize = true, bool fastMode = false, double dBSNR = 99.,
                              int TRperiod=60) const;
+  Q_SIGNAL void foxWaveform (QSharedPointer<FoxWaveform>) const;
+  Q_SIGNAL void chatWaveform (QSharedPointer<ChatWaveform>) const;
   Q_SIGNAL void outAttenuationChanged (qreal) const;
   Q_SIGNAL void toggleShorthand () const;
   Q_SIGNAL void reset_audio_input_stream (bool report_dropped_frames) const;
@@ -381,6 +385,7 @@ private:
   void set_mode (QString const& mode);
   void astroUpdate ();
   void writeAllTxt(QString message);
+  SpectrumStage::Parameters spectrumParameters ();
   void auto_sequence (DecodedText const& message, unsigned start_tolerance, unsigned stop_tolerance);
   void trim_view (bool b);
   void foxTest();
@@ -765,6 +770,10 @@ private:
   QDateTime m_dateTimeSeqStart;        //Nominal start time of Rx sequence about to be decoded
 
   QSharedMemory *mem_jt9;
+  QScopedPointer<QSystemSemaphore> m_jt9StartEvent; // wakes jt9, see lib/shmem_events.h
+  QScopedPointer<QSystemSemaphore> m_jt9AckEvent;
+  decode_records_t const * m_jt9Records; // jt9 decodes, see commons.h, null if jt9 writes text
+  int m_jt9RecordsRead;
   QString m_QSOText;
   unsigned m_downSampleFactor;
   QThread::Priority m_audioThreadPriority;
@@ -786,6 +795,8 @@ private:
   QTimer m_heartbeat;
   MessageClient * m_messageClient;
   PSKReporter m_psk_Reporter;
+  AllTxtWriter m_allTxt;
+  SpectrumStage m_spectrumStage;
   DisplayManual m_manual;
   QHash<QString, QVariant> m_pwrBandTxMemory; // Remembers power level by band
   QHash<QString, QVariant> m_pwrBandTuneMemory; // Remembers power level by band for tuning
@@ -859,6 +870,9 @@ private:
   QString sortHoundCalls(QString t, int isort, int max_dB);
   void rm_tb4(QString houndCall);
   void read_wav_file (QString const& fname);
+  decode_record_t const * nextDecodeRecord ();
+  QList<QByteArray> unreadDecodeRecords () const;
+  void prefetchWorkedB4 (QList<QByteArray> const& lines);
   void decodeDone ();
   bool subProcessFailed (QProcess *, int exit_code, QProcess::ExitStatus);
   void subProcessError (QProcess *, QProcess::ProcessError);
@@ -881,6 +895,7 @@ private:
   void foxRxSequencer(QString msg, QString houndCall, QString rptRcvd);
   void foxTxSequencer();
   void foxGenWaveform(int i,QString fm);
+  void foxSynthesize();
   void writeFoxQSO (QString const& msg);
   void update_foxLogWindow_rate();
   void to_jt9(qint32 n, qint32 istart, qint32 idone);
@@ -9,9 +9,11 @@
 #include <QDebug>
 #include "qt_helpers.hpp"
 #include "commons.h"
+#include "Detector/SpectrumStage.hpp"
 #include "moc_plotter.cpp"
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 
 #define MAX_SCREENSIZE 8192
 
@@ -102,10 +104,11 @@ void CPlotter::resizeEvent(QResizeEvent* )                    //resizeEvent()
     m_h1=m_h-m_h2;
     m_2DPixmap = QPixmap(m_Size.width(), m_h2);
     m_2DPixmap.fill(Qt::black);
-    m_WaterfallPixmap = QPixmap(m_Size.width(), m_h1);
+    m_WaterfallImage = QImage(m_Size.width(), m_h1, QImage::Format_RGB32);
+    m_wfTop = 0;
     m_OverlayPixmap = QPixmap(m_Size.width(), m_h2);
     m_OverlayPixmap.fill(Qt::black);
-    m_WaterfallPixmap.fill(Qt::black);
+    m_WaterfallImage.fill(Qt::black);
     m_2DPixmap.fill(Qt::black);
     m_ScalePixmap = QPixmap(m_w,30);
     m_ScalePixmap.fill(Qt::white);
@@ -123,7 +126,13 @@ void CPlotter::paintEvent(QPaintEvent *)                                // paint
   m_paintEventBusy=true;
   QPainter painter(this);
   painter.drawPixmap(0,0,m_ScalePixmap);
-  painter.drawPixmap(0,30,m_WaterfallPixmap);
+  // unroll the waterfall ring, newest row at the top
+  int wfw=m_WaterfallImage.width();
+  int wfh=m_WaterfallImage.height();
+  painter.drawImage(QPoint(0,30),m_WaterfallImage,QRect(0,m_wfTop,wfw,wfh-m_wfTop));
+  if(m_wfTop>0) {
+    painter.drawImage(QPoint(0,30+wfh-m_wfTop),m_WaterfallImage,QRect(0,0,wfw,m_wfTop));
+  }
   painter.drawPixmap(0,m_h1,m_2DPixmap);
   m_paintEventBusy=false;
 }
@@ -140,9 +149,8 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
   if(m_bReference != m_bReference0) resizeEvent(NULL);
   m_bReference0=m_bReference;
 
-//move current data down one line (must do this before attaching a QPainter object)
-  if(bScroll and !m_bReplot) m_WaterfallPixmap.scroll(0,1,0,0,m_w,m_h1);
-  QPainter painter1(&m_WaterfallPixmap);
+//move current data down one line: the new top row is the oldest in the ring
+  if(bScroll and !m_bReplot and m_h1>0) m_wfTop=(m_wfTop+m_h1-1)%m_h1;
   if(m_bFirst or bRed or !m_bQ65_Sync or m_mode!=m_mode0
      or m_bResized or m_rxFreq!=m_rxFreq0) {
     m_2DPixmap = m_OverlayPixmap.copy(0,0,m_w,m_h2);
@@ -175,28 +183,27 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
   int iz=XfromFreq(5000.0);
   int jz=iz*m_binsPerPixel;
   m_fMax=FreqfromX(iz);
+  // savg and spectra_ are written by symspec and refspectrum on the
+  // spectrum stage's thread
+  QMutexLocker fortran_lock {SpectrumStage::fortran_mutex ()};
   if(bScroll and swide[0]<1.e29) {
     flat4_(swide,&iz,&m_Flatten);
     if(!m_bReplot) flat4_(&dec_data.savg[j0],&jz,&m_Flatten);
   }
 
   ymin=1.e30;
-  if(swide[0]>1.e29 and swide[0]< 1.5e30) painter1.setPen(Qt::green);
-  if(swide[0]>1.4e30) painter1.setPen(Qt::red);
+  QRgb colour=qRgb(0,0,0);
+  if(swide[0]>1.e29 and swide[0]< 1.5e30) colour=qRgb(0,255,0);
+  if(swide[0]>1.4e30) colour=qRgb(255,0,0);
   if(!m_bReplot) {
-    m_j=0;
+    m_j=m_wfTop;
     int irow=-1;
     plotsave_(swide,&m_w,&m_h1,&irow);
   }
   for(int i=0; i<iz; i++) {
-    y=swide[i];
-    if(y<ymin) ymin=y;
-    int y1 = 10.0*gain*y + m_plotZero;
-    if (y1<0) y1=0;
-    if (y1>254) y1=254;
-    if (swide[i]<1.e29) painter1.setPen(g_ColorTbl[y1]);
-    painter1.drawPoint(i,m_j);
+    if(swide[i]<ymin) ymin=swide[i];
   }
+  drawWaterfallRow(swide,iz,m_j,gain,colour);
   m_line++;
 
   float y2min=1.e30;
@@ -243,12 +250,12 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
     if(y2>y2max) y2max=y2;
     j++;
   }
+  fortran_lock.unlock ();
   if(m_bReplot and m_mode!="Q65") return;
 
   if(swide[0]>1.0e29) m_line=0;
   if(m_mode=="FT4" and m_line==34) m_line=0;
-  if(m_line == painter1.fontMetrics ().height ()) {
-    painter1.setPen(Qt::white);
+  if(m_line == fontMetrics ().height ()) {
     QString t;
     if(m_nUTC<0) {
       auto start = qt_truncate_date_time_to (QDateTime::currentDateTimeUtc(), m_TRperiod * 1e3)
@@ -260,7 +267,7 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
          .toString (m_TRperiod < 60. ? "hh:mm:ss" : "hh:mm");
       t = QString {"%1    %2"}.arg (start).arg (m_rxBand);
     }
-    painter1.drawText (5, painter1.fontMetrics ().ascent (), t);
+    drawWaterfallText (5, t);
   }
 
   if(m_mode=="JT4" or (m_mode=="Q65" and m_nSubMode>=3)) {
@@ -354,25 +361,68 @@ void CPlotter::drawRed(int ia, int ib, float swide[])
 void CPlotter::replot()
 {
   resizeEvent(NULL);
+  if (!m_TRperiod) return;      // not ready to plot yet
   float swide[m_w];
+  double fac = sqrt(m_binsPerPixel*m_waterfallAvg/15.0);
+  double gain = fac*pow(10.0,0.015*m_plotGain);
+  int iz=XfromFreq(5000.0);
   m_bReplot=true;
-  for(int irow=0; irow<m_h1; irow++) {
-    m_j=irow;
+// Rewrite the saved rows straight into the waterfall image, oldest
+// first so that row 0 is left in swide for the 2D spectrum
+  for(int irow=m_h1-1; irow>=0; irow--) {
     plotsave_(swide,&m_w,&m_h1,&irow);
-    draw(swide,false,false);
-  }
-  if(m_mode=="Q65" and m_bQ65_Sync) {
-    draw(swide,false,true);
+    QRgb colour=qRgb(0,0,0);
+    if(swide[0]>1.e29 and swide[0]< 1.5e30) colour=qRgb(0,255,0);
+    if(swide[0]>1.4e30) colour=qRgb(255,0,0);
+    drawWaterfallRow(swide,iz,(m_wfTop+irow)%m_h1,gain,colour);
   }
+  m_j=m_wfTop;
+  draw(swide,false,m_mode=="Q65" and m_bQ65_Sync);
   update();                                    //trigger a new paintEvent
   m_bReplot=false;
 }
 
+void CPlotter::drawWaterfallRow(float const swide[], int iz, int row, double gain, QRgb colour)
+{
+  if(row<0 or row>=m_WaterfallImage.height()) return;
+  if(m_ColorLut.isEmpty()) setColours(g_ColorTbl);
+  auto * line = reinterpret_cast<QRgb *> (m_WaterfallImage.scanLine(row));
+  int n=qMin(iz,m_WaterfallImage.width());
+  for(int i=0; i<n; i++) {
+    if(swide[i]<1.e29) {                       //values >= 1e29 repeat the previous colour
+      int y1 = 10.0*gain*swide[i] + m_plotZero;
+      if (y1<0) y1=0;
+      if (y1>254) y1=254;
+      colour=m_ColorLut[y1];
+    }
+    line[i]=colour;
+  }
+  std::fill(line+qMax(n,0),line+m_WaterfallImage.width(),qRgb(0,0,0));
+}
+
+void CPlotter::drawWaterfallText(int x, QString const& text)
+{
+// The text covers the newest rows, which may wrap around the end of the ring
+  QPainter painter(&m_WaterfallImage);
+  if(!painter.isActive()) return;
+  painter.setPen(Qt::white);
+  int wfw=m_WaterfallImage.width();
+  int wfh=m_WaterfallImage.height();
+  int ascent=painter.fontMetrics().ascent();
+  int height=painter.fontMetrics().height();
+  painter.setClipRect(0,m_wfTop,wfw,wfh-m_wfTop);
+  painter.drawText(x,m_wfTop+ascent,text);
+  if(m_wfTop+height>wfh) {
+    painter.setClipRect(0,0,wfw,m_wfTop);
+    painter.drawText(x,m_wfTop-wfh+ascent,text);
+  }
+}
+
 void CPlotter::DrawOverlay()                   //DrawOverlay()
 {
   if(m_OverlayPixmap.isNull()) return;
-  if(m_WaterfallPixmap.isNull()) return;
-  int w = m_WaterfallPixmap.width();
+  if(m_WaterfallImage.isNull()) return;
+  int w = m_WaterfallImage.width();
   int x,y,x1,x2,x3,x4,x5,x6;
   float pixperdiv;
 
@@ -734,7 +784,7 @@ int CPlotter::startFreq()                              //startFreq()
   return m_startFreq;
 }
 
-int CPlotter::plotWidth(){return m_WaterfallPixmap.width();}     //plotWidth
+int CPlotter::plotWidth(){return m_WaterfallImage.width();}      //plotWidth
 void CPlotter::UpdateOverlay() {DrawOverlay();}                  //UpdateOverlay
 void CPlotter::setDataFromDisk(bool b) {m_dataFromDisk=b;}       //setDataFromDisk
 
@@ -907,6 +957,10 @@ void CPlotter::setSingleDecode(bool b)
 void CPlotter::setColours(QVector<QColor> const& cl)
 {
   g_ColorTbl = cl;
+  m_ColorLut.resize(256);
+  for(int i=0; i<256; i++) {
+    m_ColorLut[i] = cl.isEmpty () ? qRgb(0,0,0) : cl[qMin(i,cl.size()-1)].rgb();
+  }
 }
 
 void CPlotter::SetPercent2DScreen(int percent)
@@ -110,6 +110,8 @@ private:
   void MakeFrequencyStrs();
   int XfromFreq(float f);
   float FreqfromX(int x);
+  void drawWaterfallRow(float const swide[], int iz, int row, double gain, QRgb colour);
+  void drawWaterfallText(int x, QString const& text);
 
   QAction * m_set_freq_action;
 
@@ -146,7 +148,12 @@ private:
   qint32  m_nUTC;
   qint32  m_x=0;
 
-  QPixmap m_WaterfallPixmap;
+  // The waterfall is a ring of rows, m_wfTop is the physical row
+  // holding the newest line; rows are written directly with scanLine()
+  QImage  m_WaterfallImage;
+  qint32  m_wfTop=0;
+  QVector<QRgb> m_ColorLut;      // g_ColorTbl as ARGB32 values
+
   QPixmap m_2DPixmap;
   QPixmap m_ScalePixmap;
   QPixmap m_OverlayPixmap;
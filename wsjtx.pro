@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += network multimedia
+QT       += network multimedia concurrent
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets sql
 CONFIG   += thread
 #CONFIG   += console